@@ -26,6 +26,9 @@
 #include "safety.h"
 #include "loop_impd.h"
 #include "attach_impd.h"
+#include "impd_adc.h"
+#include "impd_cal.h"
+#include "iap.h"
 
 #define  LOG_TAG             "app"
 #define  LOG_LVL             4
@@ -42,6 +45,7 @@
 /*------------------------------ variables prototypes -------------------------*/
 static uint8_t mode = 0;
 static uint8_t sub_mode = 0;
+static uint8_t last_sub_mode = LOOP_MODE;
 
 /*------------------------------ function prototypes --------------------------*/
 
@@ -49,21 +53,59 @@ static uint8_t sub_mode = 0;
 /*------------------------------ application ----------------------------------*/
 int app_init(void)
 {
+    int ret;
+    
+    safety_init();
     data_mgmt_init();
+    
+    /* 回路与贴附两个通道共用一路 ADC 扫描采集，模式切换时不重建采集 */
+    ret = impd_adc_init(IMPD_ADC_SAMPLE_RATE_DEFAULT);
+    if (ret != 0) {
+        LOG_E("Failed to initialize impedance adc: %d\r\n", ret);
+        return -1;
+    }
+    
     loop_impd_init();
+    attach_impd_init();
+    impd_adc_start();
     
     return 0;
 }
 
-void app_task(void)
+/**
+  * @brief : 周期工作：看门狗检查、参数延迟写回、升级擦写，由 SCHED_EVT_KICK 驱动
+  */
+void app_periodic(void)
 {
     safety_task();
+    data_mgmt_task();
+    iap_task();
+}
+
+/**
+  * @brief : ADC 数据块和模式切换，每次 ADC 事件或 SCHED_EVT_KICK 时运行
+  */
+void app_task(void)
+{
+    impd_adc_service();
+    
+    if (sub_mode != last_sub_mode) {
+        if (sub_mode == ATTACH_MODE)
+            attach_impd_start();
+        else
+            attach_impd_stop();
+        last_sub_mode = sub_mode;
+    }
     
     switch(mode) {
         case INIT_MODE:
             mode = NOMAL_MODE;
             break;
         case NOMAL_MODE:
+            if (impd_cal_get_state() != IMPD_CAL_IDLE) {
+                mode = CALIBRATION_MODE;
+                break;
+            }
             switch (sub_mode) {
                 case LOOP_MODE:
 //                    if (loop_get_status)
@@ -72,15 +114,39 @@ void app_task(void)
 //                        loop_impd_stop();
                     break;
                 case ATTACH_MODE:
+                    attach_impd_task();
                     break;
                 default:
                     break;
             }
             break;
         case CALIBRATION_MODE:
+            /* 校准由上位机命令驱动，结束或放弃后回到正常模式 */
+            if (impd_cal_get_state() == IMPD_CAL_IDLE)
+                mode = NOMAL_MODE;
             break;
         default:
             break;
     }
 }
+
+/**
+  * @brief : 选择回路或贴附通道，切换在下一次 app_task 中执行
+  * @param : m enum sub_mode
+  * @retval: 0 成功，-EINVAL 模式无效
+  */
+int app_set_sub_mode(uint8_t m)
+{
+    if (m != LOOP_MODE && m != ATTACH_MODE)
+        return -EINVAL;
+    
+    sub_mode = m;
+    
+    return 0;
+}
+
+uint8_t app_get_sub_mode(void)
+{
+    return sub_mode;
+}
 /******************************* End Of File ************************************/
@@ -42,6 +42,9 @@ enum sub_mode {
 /*------------------------------ function declarations -----------------------*/
 int app_init(void);
 void app_task(void);
+void app_periodic(void);
+int app_set_sub_mode(uint8_t m);
+uint8_t app_get_sub_mode(void);
 void app_handshake(const uint8_t *data, uint16_t len);
 void app_get_sw_version(const uint8_t *data, uint16_t len);
 void app_set_hw_version(const uint8_t *data, uint16_t len);
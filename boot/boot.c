@@ -0,0 +1,193 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : boot.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : bootloader：复位后检查下载区，安装已校验的镜像，然后跳转到应用区
+  * @attention   : 位于 flash 起始的 IAP_BOOT_SIZE 字节 (工程 boot.uvprojx)，应用链接在
+  *                IAP_APP_ADDR。只用寄存器操作，运行在复位后的 HSI 8MHz，不使用中断。
+  *                安装顺序：区头为 READY 且下载区镜像 CRC 正确 -> 逐页擦写应用区 ->
+  *                回读 CRC -> 擦除区头。任一步断电，下次复位时区头仍为 READY，重新安装；
+  *                应用区 CRC 已与区头一致时跳过擦写，只擦除区头
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.xxx
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "board.h"
+#include "data_mgmt.h"
+#include "iap.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+#define BOOT_SLOT_ADDR                  (STM32_FLASH_START_ADDR + IAP_SLOT_BASE_ADDR)
+#define BOOT_SLOT_IMAGE                 ((const uint8_t *)(BOOT_SLOT_ADDR + IAP_PAGE_SIZE))
+#define BOOT_APP_IMAGE                  ((const uint8_t *)IAP_APP_ADDR)
+#define BOOT_RETRY                      (3)         /* flash 擦写失败时的安装次数 */
+#define BOOT_IWDG_RELOAD                (0xAAAAU)   /* 看门狗由应用启动，复位后若仍在运行则需喂狗 */
+#define BOOT_RAM_END                    (SRAM_BASE + 0x10000UL)
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static const uint32_t crc32_nibble[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+    0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+    0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+/* Exported variables  -------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t boot_crc32(const uint8_t *data, uint32_t len);
+static int boot_flash_wait(void);
+static int boot_flash_erase(uint32_t addr);
+static int boot_flash_program(uint32_t addr, const uint8_t *data, uint32_t len);
+static int boot_install(const iap_slot_hdr_t *hdr);
+static void boot_jump(uint32_t addr);
+
+/* Exported functions --------------------------------------------------------*/
+int main(void)
+{
+    const iap_slot_hdr_t *hdr = (const iap_slot_hdr_t *)BOOT_SLOT_ADDR;
+    int i;
+
+    if (hdr->magic == IAP_SLOT_MAGIC && hdr->state == IAP_SLOT_READY) {
+        FLASH->KEYR = FLASH_KEY1;
+        FLASH->KEYR = FLASH_KEY2;
+        for (i = 0; i < BOOT_RETRY; i++)
+            if (boot_install(hdr) != -EIO)
+                break;
+        FLASH->CR |= FLASH_CR_LOCK;
+    }
+
+    boot_jump(IAP_APP_ADDR);
+
+    /* 应用区无效：停在这里，由调试器重新下载 */
+    while (1)
+        IWDG->KR = BOOT_IWDG_RELOAD;
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  CRC32 (IEEE 802.3)，与 iap_crc32 相同
+ */
+static uint32_t boot_crc32(const uint8_t *data, uint32_t len)
+{
+    uint32_t crc = 0xFFFFFFFFUL;
+
+    while (len--) {
+        crc ^= *data++;
+        crc = (crc >> 4) ^ crc32_nibble[crc & 0x0F];
+        crc = (crc >> 4) ^ crc32_nibble[crc & 0x0F];
+        if ((len & 0x3FF) == 0)
+            IWDG->KR = BOOT_IWDG_RELOAD;
+    }
+
+    return ~crc;
+}
+
+static int boot_flash_wait(void)
+{
+    uint32_t sr;
+
+    while (FLASH->SR & FLASH_SR_BSY)
+        ;
+    sr = FLASH->SR;
+    FLASH->SR = FLASH_SR_EOP | FLASH_SR_PGERR | FLASH_SR_WRPRTERR;
+
+    return (sr & (FLASH_SR_PGERR | FLASH_SR_WRPRTERR)) ? -EIO : 0;
+}
+
+static int boot_flash_erase(uint32_t addr)
+{
+    int ret;
+
+    IWDG->KR = BOOT_IWDG_RELOAD;
+    FLASH->CR |= FLASH_CR_PER;
+    FLASH->AR = addr;
+    FLASH->CR |= FLASH_CR_STRT;
+    ret = boot_flash_wait();
+    FLASH->CR &= ~FLASH_CR_PER;
+
+    return ret;
+}
+
+/**
+ * @brief  按半字编程并回读，len 为奇数时末字节补 0xFF
+ */
+static int boot_flash_program(uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    volatile uint16_t *dst = (volatile uint16_t *)addr;
+    uint16_t hw;
+    uint32_t i;
+    int ret = 0;
+
+    FLASH->CR |= FLASH_CR_PG;
+    for (i = 0; i < len && ret == 0; i += 2, dst++) {
+        hw = (uint16_t)(data[i] | (((i + 1 < len) ? data[i + 1] : 0xFF) << 8));
+        if (hw == 0xFFFF)
+            continue;
+        *dst = hw;
+        ret = boot_flash_wait();
+        if (ret == 0 && *dst != hw)
+            ret = -EIO;
+    }
+    FLASH->CR &= ~FLASH_CR_PG;
+
+    return ret;
+}
+
+/**
+ * @brief  把下载区镜像安装到应用区
+ * @retval 0 成功或无需安装，-EINVAL 区头无效，-EILSEQ 下载区镜像损坏，-EIO flash 擦写失败
+ * @note   区头无效或镜像损坏时保留区头，由应用重新开始升级 (iap_start 会重写区头)
+ */
+static int boot_install(const iap_slot_hdr_t *hdr)
+{
+    uint32_t size = hdr->size;
+    uint32_t off, n;
+    int ret;
+
+    if (size == 0 || size > IAP_APP_SIZE || size > IAP_IMAGE_MAX)
+        return -EINVAL;
+    if (boot_crc32(BOOT_SLOT_IMAGE, size) != hdr->crc)
+        return -EILSEQ;
+
+    if (boot_crc32(BOOT_APP_IMAGE, size) != hdr->crc) {
+        for (off = 0; off < size; off += IAP_PAGE_SIZE) {
+            n = (size - off < IAP_PAGE_SIZE) ? size - off : IAP_PAGE_SIZE;
+            ret = boot_flash_erase(IAP_APP_ADDR + off);
+            if (ret == 0)
+                ret = boot_flash_program(IAP_APP_ADDR + off, BOOT_SLOT_IMAGE + off, n);
+            if (ret)
+                return ret;
+        }
+        if (boot_crc32(BOOT_APP_IMAGE, size) != hdr->crc)
+            return -EIO;
+    }
+
+    return boot_flash_erase(BOOT_SLOT_ADDR);
+}
+
+/**
+ * @brief  栈顶和复位向量指向 RAM 和应用区时跳转，否则返回
+ */
+static void boot_jump(uint32_t addr)
+{
+    const uint32_t *vec = (const uint32_t *)addr;
+    void (*entry)(void) = (void (*)(void))vec[1];
+
+    if (vec[0] <= SRAM_BASE || vec[0] > BOOT_RAM_END ||
+        vec[1] < addr || vec[1] >= addr + IAP_APP_SIZE)
+        return;
+
+    SCB->VTOR = addr;
+    __set_MSP(vec[0]);
+    entry();
+}
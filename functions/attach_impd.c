@@ -20,8 +20,17 @@
   */
 /*------------------------------ include --------------------------------------*/
 #include "attach_impd.h"
+#include "impd_adc.h"
+#include "impd_exc.h"
+#include "goertzel.h"
+#include "dsp_math.h"
+
+#define  LOG_TAG             "attach_impd"
+#define  LOG_LVL             4
+#include "log.h"
 
 /*------------------------------ Macro definition -----------------------------*/
+#define ATTACH_IMPD_GOERTZEL_WIN    (IMPD_ADC_BLOCK_LEN * 4)
 
 
 /*------------------------------ typedef definition ---------------------------*/
@@ -29,11 +38,122 @@
 
 /*------------------------------ variables prototypes -------------------------*/
 static uint8_t ready_flag;
+static uint8_t running;
+static uint32_t attach_freq;        /* 当前检测频率，跟随激励 */
+static goertzel_result_t attach_result;
+static goertzel_t attach_goertzel;
 
 /*------------------------------ function prototypes --------------------------*/
+static void attach_impd_goertzel_done(const goertzel_result_t *res, uint8_t nbins, void *user_data)
+{
+    if (nbins > 0) {
+        attach_result = res[0];
+        ready_flag = 1;
+    }
+}
 
+static void attach_impd_adc_block(const uint16_t *block, size_t n, void *user_data)
+{
+    const impd_adc_ref_t *ref = impd_adc_get_ref();
+    
+    goertzel_set_ref(&attach_goertzel, ref->exc_phase, ref->exc_inc);
+    goertzel_process(&attach_goertzel, block, n);
+}
+
+/**
+  * @brief : 将检测频点切换到 freq，freq 为 0 时不产生结果
+  */
+static void attach_impd_track(uint32_t freq)
+{
+    uint32_t inc;
+    
+    attach_freq = freq;
+    ready_flag = 0;
+    if (freq == 0 || freq >= impd_adc_get_sample_rate() / 2) {
+        goertzel_config(&attach_goertzel, NULL, 0);
+        return;
+    }
+    inc = DSP_PHASE_INC(freq, impd_adc_get_sample_rate());
+    goertzel_config(&attach_goertzel, &inc, 1);
+}
 
 /*------------------------------ application ----------------------------------*/
+/**
+  * @brief : 初始化贴附阻抗通道，与回路通道共用 ADC 扫描序列，默认不处理数据
+  */
+int attach_impd_init(void)
+{
+    goertzel_init(&attach_goertzel, ATTACH_IMPD_GOERTZEL_WIN);
+    attach_goertzel.on_result = attach_impd_goertzel_done;
+    
+    ready_flag = 0;
+    running = 0;
+    attach_freq = 0;
+    
+    impd_adc_register(IMPD_ADC_CH_ATTACH, attach_impd_adc_block, NULL);
+    impd_adc_enable(IMPD_ADC_CH_ATTACH, 0);
+    
+    return 0;
+}
+
+/**
+  * @brief : 开始处理贴附通道数据，采集本身不启停
+  */
+void attach_impd_start(void)
+{
+    if (running)
+        return;
+    
+    attach_impd_track(impd_exc_get_freq());
+    impd_adc_enable(IMPD_ADC_CH_ATTACH, 1);
+    running = 1;
+    LOG_D("Attach start, freq = %d\r\n", attach_freq);
+}
+
+void attach_impd_stop(void)
+{
+    impd_adc_enable(IMPD_ADC_CH_ATTACH, 0);
+    running = 0;
+    ready_flag = 0;
+}
+
+/**
+  * @brief : 激励频率改变时重新配置检测频点
+  */
+void attach_impd_task(void)
+{
+    uint32_t freq;
+    
+    if (!running)
+        return;
+    
+    freq = impd_exc_get_freq();
+    if (freq != attach_freq)
+        attach_impd_track(freq);
+}
+
+uint8_t attach_impd_is_ready(void)
+{
+    return ready_flag;
+}
+
+/**
+  * @brief : 读取最近一个窗口的结果
+  * @param : mag_q31 幅值 (Q31 满量程)，phase 相对激励的相位 (Q31 π)，均可为 NULL
+  * @retval: 0 成功，-EAGAIN 尚无结果
+  */
+int attach_impd_get_value(uint32_t *mag_q31, int32_t *phase)
+{
+    if (!ready_flag)
+        return -EAGAIN;
+    
+    if (mag_q31)
+        *mag_q31 = attach_result.mag_q31;
+    if (phase)
+        *phase = attach_result.phase;
+    
+    return 0;
+}
 
 
 /******************************* End Of File ************************************/
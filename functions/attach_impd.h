@@ -31,6 +31,12 @@
 
 
 /*------------------------------ function declarations -----------------------*/
+int attach_impd_init(void);
+void attach_impd_start(void);
+void attach_impd_stop(void);
+void attach_impd_task(void);
+uint8_t attach_impd_is_ready(void);
+int attach_impd_get_value(uint32_t *mag_q31, int32_t *phase);
 
 
 /******************************* End Of File **********************************/
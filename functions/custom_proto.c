@@ -20,11 +20,13 @@
 #include "byteorder.h"
 #include "app.h"
 #include "stimer.h"
+#include "prof.h"
 #include <string.h>
 
 #define  LOG_TAG             "custom_proto"
 #define  LOG_LVL             4
 #include "log.h"
+#include "dlog.h"
 
 /* Private typedef -----------------------------------------------------------*/
 
@@ -134,7 +136,9 @@ int custom_proto_init(Protocol_type *type)
 void custom_proto_parser(Protocol_type *type)
 {
     if (type) {
+        PROF_BEGIN(PROF_FRAME_PARSER);
         frame_parser_process(&type->parser);
+        PROF_END(PROF_FRAME_PARSER);
     }
 }
     
@@ -149,14 +153,17 @@ void custom_proto_parser(Protocol_type *type)
  */
 int custom_proto_send_frame(Protocol_type *type, uint8_t id, uint8_t id_Expand, uint16_t SN_Expand, const uint8_t *data, uint16_t len)
 {
+    PROF_BEGIN(PROF_SEND_FRAME);
+    
     if (!type)
         return -EINVAL;
 
     // 计算帧长
     uint16_t frame_len = type->m_LenMin + len;
+    uint16_t len_max = type->m_TxLenMax ? type->m_TxLenMax : type->m_LenMax;
     
-    if (frame_len > type->m_LenMax) {
-        LOG_E("Frame too large (%d > %d)\r\n", frame_len, type->m_LenMax);
+    if (frame_len > len_max) {
+        LOG_E("Frame too large (%d > %d)\r\n", frame_len, len_max);
         return -EINVAL;
     }
     
@@ -209,12 +216,13 @@ int custom_proto_send_frame(Protocol_type *type, uint8_t id, uint8_t id_Expand,
     
     // 发送帧
     int ret = serial_write(type->port, tx_buf, i); // 'i' 现在是总长度
+    PROF_END(PROF_SEND_FRAME);
     if (ret != i) {
         LOG_E("Failed to send frame: expected %d, sent %d\r\n", i, ret);
         return -EIO;
     }
     
-    LOG_D("Sent frame: cmd=0x%02X, len=%d\r\n", id, len);
+    DLOG_D("Sent frame: cmd=0x%02X, len=%d\r\n", id, len);
     return 0;
 }
 /* Private functions ---------------------------------------------------------*/ 
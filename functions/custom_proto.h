@@ -31,6 +31,7 @@
 #include "serial_proto.h"
 #include "serial.h"
 #include "stimer.h"
+#include "twheel.h"
 
 /* Exported define -----------------------------------------------------------*/
 #define CUSTOM_FRAME_MAX_LEN                    256   /**< 最大帧长度 */
@@ -89,13 +90,14 @@ typedef struct
     uint8_t m_SN_Expand;    /**< 扩展序列号 */
     uint16_t m_LenMax;      /**< 实际使用的协议帧最大帧长 */
     uint16_t m_LenMin;      /**< 实际使用的协议帧最小帧长（如有扩展位应包含） */
+    uint16_t m_TxLenMax;    /**< 发送帧最大帧长，0 表示与 m_LenMax 相同 */
     uint8_t *rx_buff;       /**< 指向帧接收缓冲区，用于解析数据 */
     uint16_t rx_buffsz;     /**< 接收缓冲区大小 */
 	uint8_t* m_TxBuffer;    /**< 发送帧缓存区 */
     serial_t *port;         /**< 串口设备指针 */
     uint32_t (*calc_check)(const uint8_t *data, size_t len);    /**< 校验计算函数 */
     uint8_t check_size;     /**< 校验字节数 */
-    stimer_t timer;         /**< 软件定时器 */
+    twheel_timer_t timer;   /**< 软件定时器 */
     proto_parser_t parser;  /**< 协议解析器 */
     frame_cfg_t frame_cfg;  /**< 帧配置 */
     /* 回调函数 */
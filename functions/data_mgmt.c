@@ -17,6 +17,9 @@
 /* Includes ------------------------------------------------------------------*/
 #include "data_mgmt.h"
 #include "mtd_core.h"
+#include "kv_store.h"
+#include "board.h"
+#include "prof.h"
 #include <string.h>
 #include <stdio.h>
 
@@ -25,9 +28,18 @@
 #include "log.h"
 
 /* Private typedef -----------------------------------------------------------*/
+enum data_key
+{
+    DATA_KEY_HW_VERSION = 0,
+    DATA_KEY_SN_NUMBER,
+    DATA_KEY_NUM,
+};
 
 /* Private define ------------------------------------------------------------*/
-static board_info_t g_board_info;
+static board_info_t g_board_info;           /* 键值存储的 RAM 缓存 */
+static kv_store_t data_kv;
+static uint8_t  data_dirty;                 /* 待写入 flash 的键，按位标记 */
+static uint32_t data_dirty_tick;            /* 最后一次修改的时刻 */
 
 /* Private macro -------------------------------------------------------------*/
 
@@ -37,30 +49,36 @@ static board_info_t g_board_info;
 extern struct mtd_info stm32_flash_info;
 
 /* Private function prototypes -----------------------------------------------*/
-static int board_info_flush(void);
+static void data_mark_dirty(uint8_t key);
+static int data_flush_key(uint8_t key);
+static void data_load_string(uint8_t key, char *buf, uint16_t size, const char *legacy, const char *def);
 
 /* Exported functions --------------------------------------------------------*/
 void data_mgmt_init(void)
 {
-    size_t retlen;
-
-    // Read the entire board_info structure from flash in one operation.
-    mtd_read(&stm32_flash_info, BOARD_INFO_BASE_ADDR, sizeof(g_board_info), &retlen, (uint8_t*)&g_board_info);
-
-    // If the magic number is incorrect or read failed, initialize with default values.
-    if ((retlen != sizeof(g_board_info)) || (g_board_info.magic != BOARD_INFO_MAGIC_NUM))
-    {
-        g_board_info.magic = BOARD_INFO_MAGIC_NUM;
-        strncpy(g_board_info.hw_version, HW_VERSION_DEFAULT_STRING, HW_VERSION_BUFSZ - 1);
-        g_board_info.hw_version[HW_VERSION_BUFSZ - 1] = '\0'; // Ensure null termination
+    static board_info_t legacy;
+    size_t retlen = 0;
+    int ret;
 
-        strncpy(g_board_info.sn_number, SN_NUMBER_DEFAULT_STRING, SN_NUMBER_BUFSZ - 1);
-        g_board_info.sn_number[SN_NUMBER_BUFSZ - 1] = '\0'; // Ensure null termination
+    ret = kv_init(&data_kv, &stm32_flash_info, DATA_KV_BASE_ADDR, DATA_KV_PAGE_SIZE, DATA_KV_PAGE_CNT);
+    if (ret != 0) {
+        LOG_E("kv init failed %d!\r\n", ret);
+    }
 
-        // Write the newly initialized default data to flash.
-        board_info_flush();
-        LOG_D("First write board infomation!");
+    // Old firmware kept the whole board_info in one erase block; import it once if present.
+    mtd_read(&stm32_flash_info, BOARD_INFO_BASE_ADDR, sizeof(legacy), &retlen, (uint8_t*)&legacy);
+    if ((retlen != sizeof(legacy)) || (legacy.magic != BOARD_INFO_MAGIC_NUM)) {
+        legacy.hw_version[0] = '\0';
+        legacy.sn_number[0] = '\0';
     }
+    legacy.hw_version[HW_VERSION_BUFSZ - 1] = '\0';
+    legacy.sn_number[SN_NUMBER_BUFSZ - 1] = '\0';
+
+    g_board_info.magic = BOARD_INFO_MAGIC_NUM;
+    data_load_string(DATA_KEY_HW_VERSION, g_board_info.hw_version, HW_VERSION_BUFSZ,
+                     legacy.hw_version, HW_VERSION_DEFAULT_STRING);
+    data_load_string(DATA_KEY_SN_NUMBER, g_board_info.sn_number, SN_NUMBER_BUFSZ,
+                     legacy.sn_number, SN_NUMBER_DEFAULT_STRING);
     
     LOG_D("SW_VERSION = %s!\r\n", data_mgmt_get_sw_version());
     LOG_D("HW_VERSION = %s!\r\n", data_mgmt_get_hw_version());
@@ -84,12 +102,17 @@ int data_mgmt_set_hw_version(const char *string, uint16_t len)
         return -1; // Error: Input string is too long.
     }
 
-    // Copy the new string into the global struct.
+    // Unchanged value: nothing to write back.
+    if (strncmp(g_board_info.hw_version, string, len) == 0 && g_board_info.hw_version[len] == '\0') {
+        return 0;
+    }
+
+    // Update the RAM copy only; data_mgmt_task() writes it back once the host goes quiet.
     strncpy(g_board_info.hw_version, string, len);
     g_board_info.hw_version[len] = '\0'; // Ensure null termination
+    data_mark_dirty(DATA_KEY_HW_VERSION);
 
-    // Write the entire updated struct to flash.
-    return board_info_flush();
+    return 0;
 }
 
 const char* data_mgmt_get_sn_number(void)
@@ -105,43 +128,131 @@ int data_mgmt_set_sn_number(const char *string, uint16_t len)
         return -1; // Error: Input string is too long.
     }
     
-    // Copy the new string into the global struct.
+    // Unchanged value: nothing to write back.
+    if (strncmp(g_board_info.sn_number, string, len) == 0 && g_board_info.sn_number[len] == '\0') {
+        return 0;
+    }
+
+    // Update the RAM copy only; data_mgmt_task() writes it back once the host goes quiet.
     strncpy(g_board_info.sn_number, string, len);
     g_board_info.sn_number[len] = '\0'; // Ensure null termination
+    data_mark_dirty(DATA_KEY_SN_NUMBER);
+
+    return 0;
+}
+
+/**
+ * @brief Writes back modified fields after DATA_FLUSH_QUIET_MS without changes.
+ * @note  Called from the superloop so consecutive setters coalesce into one flush.
+ *        One field is written per call so a page compaction does not add up
+ *        with the other writes in a single pass.
+ */
+void data_mgmt_task(void)
+{
+    if (data_dirty && (HAL_GetTick() - data_dirty_tick >= DATA_FLUSH_QUIET_MS)) {
+        if (data_mgmt_flush_step() < 0) {
+            // Keep the fields dirty and retry after another quiet period.
+            data_dirty_tick = HAL_GetTick();
+        }
+    }
+}
 
-    // Write the entire updated struct to flash.
-    return board_info_flush();
+/**
+ * @brief Writes all modified fields to flash now (before reset, IAP, low power).
+ * @return 0 on success, non-zero on failure; failed fields stay dirty.
+ */
+int data_mgmt_flush(void)
+{
+    int ret = 0;
+    int err;
+    uint8_t key;
+
+    for (key = 0; key < DATA_KEY_NUM; key++) {
+        if (data_dirty & (1U << key)) {
+            err = data_flush_key(key);
+            if (err != 0) {
+                ret = err;
+            }
+        }
+    }
+
+    return ret;
 }
 
 /**
- * @brief Erases and writes the entire g_board_info struct to flash.
- * @return 0 on success, non-zero on failure.
+ * @brief Writes the first modified field only, for callers that yield between fields.
+ * @return 1 if more fields are still dirty, 0 when all are written,
+ *         negative on failure (the failed field stays dirty).
  */
-static int board_info_flush(void)
+int data_mgmt_flush_step(void)
 {
-    struct erase_info info;
-    size_t retlen;
     int ret;
+    uint8_t key;
 
-    // Set up the erase operation for the entire info block.
-    info.addr = BOARD_INFO_BASE_ADDR;
-    info.len = sizeof(g_board_info);
-    
-    // Erase the relevant flash sector(s).
-    ret = mtd_erase(&stm32_flash_info, &info);
+    for (key = 0; key < DATA_KEY_NUM; key++) {
+        if (data_dirty & (1U << key)) {
+            break;
+        }
+    }
+    if (key == DATA_KEY_NUM) {
+        return 0;
+    }
+
+    ret = data_flush_key(key);
     if (ret != 0) {
-        // Handle erase error if necessary
         return ret;
     }
 
-    // Write the entire updated struct back to flash.
-    ret = mtd_write(&stm32_flash_info, BOARD_INFO_BASE_ADDR, sizeof(g_board_info), &retlen, (uint8_t*)&g_board_info);
-    
-    // Check if the write was successful
-    if (ret != 0 || retlen != sizeof(g_board_info)) {
-        // Handle write error if necessary
-        return -1;
+    return data_dirty ? 1 : 0;
+}
+
+static int data_flush_key(uint8_t key)
+{
+    const char *str = (key == DATA_KEY_HW_VERSION) ? g_board_info.hw_version : g_board_info.sn_number;
+    int ret;
+    PROF_BEGIN(PROF_DATA_FLUSH);
+
+    ret = kv_set(&data_kv, key, str, (uint16_t)strlen(str));
+    if (ret == 0) {
+        data_dirty &= ~(1U << key);
+    }
+
+    PROF_END(PROF_DATA_FLUSH);
+    if (ret != 0) {
+        LOG_E("board infomation flush failed %d!\r\n", ret);
+    }
+
+    return ret;
+}
+
+static void data_mark_dirty(uint8_t key)
+{
+    data_dirty |= (uint8_t)(1U << key);
+    data_dirty_tick = HAL_GetTick();
+}
+
+/**
+ * @brief Loads one string field from the key-value store.
+ * @param legacy Value imported from the old board_info block, empty if none.
+ * @param def    Default used when neither the store nor the old block has it.
+ */
+static void data_load_string(uint8_t key, char *buf, uint16_t size, const char *legacy, const char *def)
+{
+    int len;
+
+    len = kv_get(&data_kv, key, buf, size - 1);
+    if (len >= 0 && len < size) {
+        buf[len] = '\0';
+        return;
+    }
+
+    if (legacy[0] != '\0') {
+        strncpy(buf, legacy, size - 1);
+        buf[size - 1] = '\0';
+        kv_set(&data_kv, key, buf, (uint16_t)strlen(buf));
+        LOG_D("Import board infomation key %d!\r\n", key);
+    } else {
+        strncpy(buf, def, size - 1);
+        buf[size - 1] = '\0';
     }
-    
-    return 0;
 }
\ No newline at end of file
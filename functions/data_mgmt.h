@@ -57,7 +57,14 @@
 #define SN_NUMBER_BUFSZ             (64)
 
 #define BOARD_INFO_MAGIC_NUM        (0xFFDDFFDDFFDDFFDDULL)
-#define BOARD_INFO_BASE_ADDR        (0x00000000)
+#define DATA_KV_BASE_ADDR           (0x00000000)    /* 键值存储占 flash 前两页 */
+#define DATA_KV_PAGE_SIZE           (0x00000800)
+#define DATA_KV_PAGE_CNT            (2)
+#define DATA_FLUSH_QUIET_MS         (500)           /* 最后一次修改后静默多久写入 flash */
+#define BOARD_INFO_BASE_ADDR        (0x00001000)    /* 旧版板卡信息，仅上电导入 */
+#define CAL_TABLE_BASE_ADDR         (0x00001800)    /* 校准表独占 flash 第四页 */
+#define IAP_SLOT_BASE_ADDR          (0x00002000)    /* 固件下载区 */
+#define IAP_SLOT_SIZE               (0x00010000)
 /* Exported typedef ----------------------------------------------------------*/
 typedef struct __attribute__((packed))
 {
@@ -79,6 +86,9 @@ const char* data_mgmt_get_hw_version(void);
 const char* data_mgmt_get_sn_number(void);
 int data_mgmt_set_hw_version(const char *string, uint16_t len);
 int data_mgmt_set_sn_number(const char *string, uint16_t len);
+void data_mgmt_task(void);
+int data_mgmt_flush(void);
+int data_mgmt_flush_step(void);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,496 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : iap.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 在线升级：按块接收固件写入下载区，校验后标记待安装
+  * @attention   : 两个页缓冲区轮流使用：一个接收后续块，另一个由 iap_task 写入 flash。
+  *                开始命令只读区头并立即应答，区头和镜像页由 iap_task 每次擦除一页，
+  *                擦除进度领先于接收；块所在页尚未擦除时应答 -EBUSY，主机稍后重发。
+  *                主循环每轮最多阻塞一次页擦除 (F1 最长 40ms)
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.xxx
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "iap.h"
+#include "iap_delta.h"
+#include "board.h"
+#include "mtd_core.h"
+#include "crc.h"
+#include <string.h>
+#include <stddef.h>
+
+#define  LOG_TAG             "iap"
+#define  LOG_LVL             4
+#include "log.h"
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+    uint8_t  state;                         /* enum iap_state */
+    uint32_t size;
+    uint32_t crc;
+    uint16_t blocks;                        /* 镜像总块数 */
+    uint16_t next;                          /* 下一个期望的块号 */
+    uint8_t  fill;                          /* 正在接收的缓冲区 */
+    uint8_t  prog;                          /* 下一个待写入的缓冲区 */
+    uint8_t  pending[2];                    /* 缓冲区已满，等待写入 */
+    uint16_t page[2];                       /* 缓冲区对应的镜像页号 */
+    uint16_t used[2];                       /* 缓冲区有效字节数 */
+    uint16_t pages;                         /* 镜像总页数 */
+    uint16_t erased;                        /* 此前的页已擦除或已写入 */
+    uint8_t  hdr_pending;                   /* 区头尚未擦除重写 */
+    uint8_t  buf[2][IAP_PAGE_SIZE];
+    uint8_t  delta;                         /* 1: 块内容为差分补丁 */
+    uint32_t patch_size;
+    uint32_t out;                           /* 补丁已解码输出的字节数 */
+    uint16_t in_len;                        /* 待解码的补丁块 */
+    uint16_t in_pos;
+    uint8_t  in[IAP_BLOCK_SIZE];
+    iap_delta_t dec;
+} iap_ctx_t;
+
+/* Private define ------------------------------------------------------------*/
+#define IAP_BLOCKS_PER_PAGE             (IAP_PAGE_SIZE / IAP_BLOCK_SIZE)
+#define IAP_IMAGE_ADDR                  (IAP_SLOT_BASE_ADDR + IAP_PAGE_SIZE)
+#define IAP_CHUNK                       (64)    /* 回读校验和 CRC 计算的分段长度 */
+#define IAP_APP_IMAGE                   ((const uint8_t *)IAP_APP_ADDR)
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static iap_ctx_t iap;
+static iap_slot_hdr_t slot_hdr;
+
+static const uint32_t crc32_nibble[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+    0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+    0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+/* Exported variables  -------------------------------------------------------*/
+extern struct mtd_info stm32_flash_info;
+
+/* Private function prototypes -----------------------------------------------*/
+static int iap_flash_write(uint32_t addr, const void *buf, size_t len);
+static int iap_flash_read(uint32_t addr, void *buf, size_t len);
+static int iap_slot_open(uint32_t size, uint32_t crc, uint8_t resume);
+static int iap_erase_step(void);
+static int iap_program_page(uint8_t idx);
+static int iap_delta_pump(void);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+ * @brief  开始或续传一次升级
+ * @param  size 镜像字节数，不超过应用区 IAP_APP_SIZE
+ * @param  crc  镜像 CRC32
+ * @retval 0 成功，从 iap_get_next() 开始发送；负值失败
+ * @note   区头与 size/crc 相同时保留已写入的页，只擦除其余页。擦除由 iap_task 完成
+ */
+int iap_start(uint32_t size, uint32_t crc)
+{
+    if (size == 0 || size > IAP_IMAGE_MAX || size > IAP_APP_SIZE)
+        return -EINVAL;
+
+    memset(&iap, 0, sizeof(iap));
+    iap.blocks = (uint16_t)((size + IAP_BLOCK_SIZE - 1) / IAP_BLOCK_SIZE);
+
+    return iap_slot_open(size, crc, 1);
+}
+
+/**
+ * @brief  开始一次差分升级，块内容为补丁
+ * @param  patch_size 补丁字节数
+ * @param  size       新镜像字节数
+ * @param  crc        新镜像 CRC32
+ * @param  old_size   补丁基于的旧镜像字节数
+ * @param  old_crc    旧镜像 CRC32，与应用区不符时拒绝
+ * @retval 0 成功，-EILSEQ 当前固件不是补丁的基础版本，其他负值失败
+ */
+int iap_start_delta(uint32_t patch_size, uint32_t size, uint32_t crc, uint32_t old_size, uint32_t old_crc)
+{
+    if (size == 0 || size > IAP_IMAGE_MAX || size > IAP_APP_SIZE || patch_size == 0 ||
+        patch_size > (uint32_t)IAP_BLOCK_SIZE * 0xFFFF || old_size > IAP_APP_SIZE)
+        return -EINVAL;
+
+    if (iap_crc32(0, IAP_APP_IMAGE, old_size) != old_crc)
+        return -EILSEQ;
+
+    memset(&iap, 0, sizeof(iap));
+    iap.delta = 1;
+    iap.patch_size = patch_size;
+    iap.blocks = (uint16_t)((patch_size + IAP_BLOCK_SIZE - 1) / IAP_BLOCK_SIZE);
+    iap_delta_init(&iap.dec, IAP_APP_IMAGE, old_size);
+
+    return iap_slot_open(size, crc, 0);
+}
+
+/**
+ * @brief  接收一个块，块必须按序到达
+ * @param  seq  块号
+ * @param  crc  数据的 CRC16 (MODBUS)
+ * @param  len  数据长度，除最后一块外必须为 IAP_BLOCK_SIZE
+ * @retval 0 已接收 (重复的旧块也返回 0)，-EILSEQ 校验错，-EAGAIN 不是期望的块，
+ *         -EBUSY 缓冲区满或所在页尚未擦除，需稍后重发，其他负值失败
+ */
+int iap_write_block(uint16_t seq, uint16_t crc, const uint8_t *data, uint16_t len)
+{
+    uint32_t remain;
+    uint16_t page;
+    uint16_t off;
+    uint8_t *dst;
+
+    if (iap.state != IAP_RECV)
+        return -EPERM;
+    if (seq < iap.next)
+        return 0;
+    if (seq > iap.next)
+        return -EAGAIN;
+
+    remain = (iap.delta ? iap.patch_size : iap.size) - (uint32_t)seq * IAP_BLOCK_SIZE;
+    if (len != ((remain < IAP_BLOCK_SIZE) ? remain : IAP_BLOCK_SIZE))
+        return -EINVAL;
+
+    if (crc16_modbus(data, len) != crc)
+        return -EILSEQ;
+
+    page = iap.delta ? (uint16_t)(iap.out / IAP_PAGE_SIZE) : seq / IAP_BLOCKS_PER_PAGE;
+    if (iap.hdr_pending || (page < iap.pages && page >= iap.erased))
+        return -EBUSY;
+
+    if (iap.delta) {
+        /* 上一块尚未解码完 (输出缓冲区满)，稍后重发 */
+        if (iap.in_pos < iap.in_len)
+            return -EBUSY;
+        memcpy(iap.in, data, len);
+        iap.in_len = len;
+        iap.in_pos = 0;
+        iap.next++;
+        if (iap_delta_pump() != 0) {
+            iap.state = IAP_ERROR;
+            return -EIO;
+        }
+        return 0;
+    }
+
+    dst = iap.buf[iap.fill];
+    off = (seq % IAP_BLOCKS_PER_PAGE) * IAP_BLOCK_SIZE;
+    if (iap.pending[iap.fill])
+        return -EBUSY;
+    memcpy(&dst[off], data, len);
+
+    iap.next++;
+    if (iap.next % IAP_BLOCKS_PER_PAGE == 0 || iap.next == iap.blocks) {
+        iap.page[iap.fill] = seq / IAP_BLOCKS_PER_PAGE;
+        iap.used[iap.fill] = off + len;
+        iap.pending[iap.fill] = 1;
+        iap.fill ^= 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief  写完剩余缓冲区并校验整个镜像，成功后区头置为 IAP_SLOT_READY
+ * @retval 0 成功，-EINVAL 尚有块未收到，-EILSEQ CRC 不符，其他为 flash 错误
+ */
+int iap_finish(void)
+{
+    uint8_t chunk[IAP_CHUNK];
+    uint32_t crc = 0;
+    uint32_t off, n;
+    uint32_t ready = IAP_SLOT_READY;
+    int ret;
+
+    if (iap.state == IAP_READY)
+        return 0;
+    if (iap.state != IAP_RECV)
+        return -EPERM;
+    if (iap.next != iap.blocks)
+        return -EINVAL;
+
+    while (iap.pending[iap.prog]) {
+        iap_task();
+        if (iap.state != IAP_RECV)
+            return -EIO;
+    }
+
+    if (iap.delta && (iap.out != iap.size || !iap_delta_idle(&iap.dec))) {
+        LOG_E("patch output %d bytes, expect %d\r\n", iap.out, iap.size);
+        iap.state = IAP_ERROR;
+        return -EILSEQ;
+    }
+
+    for (off = 0; off < iap.size; off += n) {
+        n = (iap.size - off < IAP_CHUNK) ? (iap.size - off) : IAP_CHUNK;
+        ret = iap_flash_read(IAP_IMAGE_ADDR + off, chunk, n);
+        if (ret != 0)
+            return ret;
+        crc = iap_crc32(crc, chunk, n);
+    }
+
+    if (crc != iap.crc) {
+        LOG_E("image crc 0x%08X, expect 0x%08X\r\n", crc, iap.crc);
+        iap.state = IAP_ERROR;
+        return -EILSEQ;
+    }
+
+    ret = iap_flash_write(IAP_SLOT_BASE_ADDR + offsetof(iap_slot_hdr_t, state), &ready, sizeof(ready));
+    if (ret != 0) {
+        iap.state = IAP_ERROR;
+        return ret;
+    }
+
+    iap.state = IAP_READY;
+    LOG_D("image ready, %d bytes\r\n", iap.size);
+
+    return 0;
+}
+
+/**
+ * @brief  放弃本次升级，已写入的页保留，可用相同 size/crc 续传
+ */
+void iap_abort(void)
+{
+    iap.state = IAP_IDLE;
+    iap.pending[0] = 0;
+    iap.pending[1] = 0;
+}
+
+/**
+ * @brief  擦除一页或把一个已满的缓冲区写入 flash，在主循环中调用
+ */
+void iap_task(void)
+{
+    int ret;
+
+    if (iap.state != IAP_RECV)
+        return;
+
+    ret = iap_erase_step();
+    if (ret < 0) {
+        LOG_E("erase failed %d\r\n", ret);
+        iap.state = IAP_ERROR;
+        return;
+    }
+    if (ret > 0 || !iap.pending[iap.prog] || iap.page[iap.prog] >= iap.erased)
+        return;
+
+    if (iap_program_page(iap.prog) != 0) {
+        LOG_E("program page %d failed\r\n", iap.page[iap.prog]);
+        iap.state = IAP_ERROR;
+        return;
+    }
+
+    iap.pending[iap.prog] = 0;
+    iap.used[iap.prog] = 0;
+    iap.prog ^= 1;
+
+    if (iap.delta && iap_delta_pump() != 0)
+        iap.state = IAP_ERROR;
+}
+
+uint16_t iap_get_next(void)
+{
+    return iap.next;
+}
+
+uint8_t iap_get_state(void)
+{
+    return iap.state;
+}
+
+/**
+ * @brief  CRC32 (IEEE 802.3)，可分段计算，首次传入 crc = 0
+ */
+uint32_t iap_crc32(uint32_t crc, const uint8_t *data, uint32_t len)
+{
+    crc = ~crc;
+    while (len--) {
+        crc ^= *data++;
+        crc = (crc >> 4) ^ crc32_nibble[crc & 0x0F];
+        crc = (crc >> 4) ^ crc32_nibble[crc & 0x0F];
+    }
+
+    return ~crc;
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  读区头，决定续传 (resume = 1)、直接完成或重新开始，擦除留给 iap_erase_step
+ */
+static int iap_slot_open(uint32_t size, uint32_t crc, uint8_t resume)
+{
+    uint16_t done = 0;
+    int ret;
+
+    iap.size = size;
+    iap.crc = crc;
+    iap.pages = (uint16_t)((size + IAP_PAGE_SIZE - 1) / IAP_PAGE_SIZE);
+
+    ret = iap_flash_read(IAP_SLOT_BASE_ADDR, &slot_hdr, sizeof(slot_hdr));
+    if (ret != 0)
+        return ret;
+
+    if (slot_hdr.magic == IAP_SLOT_MAGIC && slot_hdr.size == size && slot_hdr.crc == crc &&
+        (resume || slot_hdr.state == IAP_SLOT_READY)) {
+        if (slot_hdr.state == IAP_SLOT_READY) {
+            iap.next = iap.blocks;
+            iap.state = IAP_READY;
+            return 0;
+        }
+        while (done < iap.pages && slot_hdr.done[done] == 0x0000)
+            done++;
+    } else {
+        iap.hdr_pending = 1;
+    }
+
+    /* 未完成的页可能写了一半，从该页起重新擦除 */
+    iap.erased = done;
+    iap.next = done * IAP_BLOCKS_PER_PAGE;
+    iap.state = IAP_RECV;
+
+    LOG_D("start size %d, resume from block %d\r\n", size, iap.next);
+
+    return 0;
+}
+
+/**
+ * @brief  擦除区头或下一个镜像页，每次调用最多擦除一页
+ * @retval 1 擦除了一页，0 已全部擦除，负值失败
+ * @note   新镜像先擦区头，写好长度和 CRC 后最后写魔术码
+ */
+static int iap_erase_step(void)
+{
+    struct erase_info info;
+    int ret;
+
+    if (iap.hdr_pending) {
+        info.addr = IAP_SLOT_BASE_ADDR;
+        info.len = IAP_PAGE_SIZE;
+        ret = mtd_erase(&stm32_flash_info, &info);
+        if (ret != 0)
+            return ret;
+        memset(&slot_hdr, 0xFF, sizeof(slot_hdr));
+        slot_hdr.size = iap.size;
+        slot_hdr.crc = iap.crc;
+        ret = iap_flash_write(IAP_SLOT_BASE_ADDR + offsetof(iap_slot_hdr_t, size), &slot_hdr.size, 8);
+        if (ret == 0) {
+            slot_hdr.magic = IAP_SLOT_MAGIC;
+            ret = iap_flash_write(IAP_SLOT_BASE_ADDR, &slot_hdr.magic, 4);
+        }
+        if (ret != 0)
+            return ret;
+        iap.hdr_pending = 0;
+        return 1;
+    }
+
+    if (iap.erased >= iap.pages)
+        return 0;
+
+    info.addr = IAP_IMAGE_ADDR + (uint32_t)iap.erased * IAP_PAGE_SIZE;
+    info.len = IAP_PAGE_SIZE;
+    ret = mtd_erase(&stm32_flash_info, &info);
+    if (ret != 0)
+        return ret;
+    iap.erased++;
+
+    return 1;
+}
+
+/**
+ * @brief  把待解码的补丁块解码到页缓冲区，直到输入用完或两个缓冲区都满
+ * @retval 0 成功，负值补丁错误
+ */
+static int iap_delta_pump(void)
+{
+    uint16_t in_used, out_used;
+    uint8_t idx;
+    int ret;
+
+    while (!iap.pending[iap.fill]) {
+        idx = iap.fill;
+        ret = iap_delta_feed(&iap.dec, &iap.in[iap.in_pos], iap.in_len - iap.in_pos, &in_used,
+                             &iap.buf[idx][iap.used[idx]], IAP_PAGE_SIZE - iap.used[idx], &out_used);
+        if (ret != 0 || out_used > iap.size - iap.out)
+            return -EILSEQ;
+
+        iap.in_pos += in_used;
+        iap.used[idx] += out_used;
+        iap.out += out_used;
+
+        if (iap.used[idx] == IAP_PAGE_SIZE || (iap.out == iap.size && iap.used[idx])) {
+            iap.page[idx] = (uint16_t)((iap.out - 1) / IAP_PAGE_SIZE);
+            iap.pending[idx] = 1;
+            iap.fill ^= 1;
+        } else if (out_used == 0) {
+            break;
+        }
+    }
+
+    return 0;
+}
+
+static int iap_flash_write(uint32_t addr, const void *buf, size_t len)
+{
+    size_t retlen = 0;
+    int ret;
+
+    ret = mtd_write(&stm32_flash_info, addr, len, &retlen, (const uint8_t*)buf);
+    if (ret != 0 || retlen != len)
+        return -EIO;
+
+    return 0;
+}
+
+static int iap_flash_read(uint32_t addr, void *buf, size_t len)
+{
+    size_t retlen = 0;
+    int ret;
+
+    ret = mtd_read(&stm32_flash_info, addr, len, &retlen, (uint8_t*)buf);
+    if (ret != 0 || retlen != len)
+        return -EIO;
+
+    return 0;
+}
+
+/**
+ * @brief  写入一页并回读比较，成功后在区头中标记该页
+ */
+static int iap_program_page(uint8_t idx)
+{
+    uint8_t chunk[IAP_CHUNK];
+    uint32_t addr = IAP_IMAGE_ADDR + (uint32_t)iap.page[idx] * IAP_PAGE_SIZE;
+    uint16_t len = iap.used[idx];
+    uint16_t mark = 0x0000;
+    uint16_t off, n;
+    int ret;
+
+    /* 按半字编程，奇数长度补 0xFF */
+    if (len & 1U)
+        iap.buf[idx][len++] = 0xFF;
+
+    ret = iap_flash_write(addr, iap.buf[idx], len);
+    if (ret != 0)
+        return ret;
+
+    for (off = 0; off < len; off += n) {
+        n = (len - off < IAP_CHUNK) ? (len - off) : IAP_CHUNK;
+        ret = iap_flash_read(addr + off, chunk, n);
+        if (ret != 0)
+            return ret;
+        if (memcmp(chunk, &iap.buf[idx][off], n) != 0)
+            return -EIO;
+    }
+
+    return iap_flash_write(IAP_SLOT_BASE_ADDR + offsetof(iap_slot_hdr_t, done) +
+                           iap.page[idx] * sizeof(uint16_t), &mark, sizeof(mark));
+}
+
+/******************************* End Of File ************************************/
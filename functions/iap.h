@@ -0,0 +1,81 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : iap.h
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 在线升级：按块接收固件写入下载区，校验后标记待安装
+  * @attention   : 下载区第一页为区头 (iap_slot_hdr_t)，之后为镜像。
+  *                每写完一页在区头 done[] 中清零一个半字，断电后从最后一个已写页续传；
+  *                全部写完并校验 CRC32 后 state 置为 IAP_SLOT_READY，
+  *                由 bootloader (boot/boot.c) 在复位后把镜像搬到应用区 IAP_APP_ADDR 并擦除区头。
+  *                镜像须按 IAP_APP_ADDR 链接 (工程 test.uvprojx 的 IROM1)，不超过 IAP_APP_SIZE。
+  *                差分升级时块内容为补丁 (见 iap_delta.h)，按当前应用区解码后写入下载区，
+  *                区头格式相同；补丁不支持续传，中断后从头发送
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.xxx
+  ******************************************************************************
+  */
+#ifndef __IAP_H__
+#define __IAP_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sys_def.h"
+#include "data_mgmt.h"
+
+/* Exported define -----------------------------------------------------------*/
+#define IAP_PAGE_SIZE                   (0x800)     /**< 与片上 flash 页大小一致 */
+#define IAP_BLOCK_SIZE                  (128)       /**< 每帧数据长度，页大小的约数 */
+#define IAP_WINDOW                      (4)         /**< 主机可连续发送未应答的块数 */
+#define IAP_IMAGE_MAX                   (IAP_SLOT_SIZE - IAP_PAGE_SIZE)
+#define IAP_PAGE_MAX                    (IAP_IMAGE_MAX / IAP_PAGE_SIZE)
+
+#define IAP_SLOT_MAGIC                  (0x53504149UL)  /**< "IAPS" */
+#define IAP_SLOT_READY                  (0x59444552UL)  /**< "REDY"，由 0xFFFFFFFF 直接编程 */
+
+/* Exported typedef ----------------------------------------------------------*/
+enum iap_state {
+    IAP_IDLE,                       /**< 未开始 */
+    IAP_RECV,                       /**< 接收中 */
+    IAP_READY,                      /**< 镜像已校验，等待复位安装 */
+    IAP_ERROR,                      /**< 写入或校验失败，需重新开始 */
+};
+
+/**
+ * @brief 下载区区头，bootloader 按此格式读取
+ */
+typedef struct
+{
+    uint32_t magic;                             /**< IAP_SLOT_MAGIC，最后写入 */
+    uint32_t size;                              /**< 镜像字节数 */
+    uint32_t crc;                               /**< 镜像 CRC32 (IEEE) */
+    uint32_t state;                             /**< IAP_SLOT_READY 表示可安装 */
+    uint16_t done[IAP_PAGE_MAX];                /**< 0x0000 表示该页已写入并回读校验 */
+} iap_slot_hdr_t;
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported variable prototypes ----------------------------------------------*/
+
+/* Exported function prototypes ----------------------------------------------*/
+int iap_start(uint32_t size, uint32_t crc);
+int iap_start_delta(uint32_t patch_size, uint32_t size, uint32_t crc, uint32_t old_size, uint32_t old_crc);
+int iap_write_block(uint16_t seq, uint16_t crc, const uint8_t *data, uint16_t len);
+int iap_finish(void);
+void iap_abort(void);
+void iap_task(void);
+uint16_t iap_get_next(void);
+uint8_t iap_get_state(void);
+uint32_t iap_crc32(uint32_t crc, const uint8_t *data, uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __IAP_H__ */
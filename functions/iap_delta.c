@@ -0,0 +1,196 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : iap_delta.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 差分升级补丁流式解码
+  * @attention   : 补丁格式见 iap_delta.h，由 tools/iap_delta.py 生成
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.xxx
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "iap_delta.h"
+
+/* Private typedef -----------------------------------------------------------*/
+enum delta_state {
+    DELTA_OP,                       /* 等待操作码 */
+    DELTA_OFF,                      /* DIFF 旧偏移 */
+    DELTA_LEN,                      /* 操作长度 */
+    DELTA_ZRUN,                     /* 零游程长度 */
+    DELTA_COPY,                     /* 复制旧字节，不需要输入 */
+    DELTA_LITLEN,                   /* 字面段长度 */
+    DELTA_LIT,                      /* 旧字节 + 差值 */
+    DELTA_EXTRA,                    /* 新字节 */
+};
+
+/* Private define ------------------------------------------------------------*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Exported variables  -------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+static int delta_varint(iap_delta_t *d, uint8_t b);
+static int delta_var_done(iap_delta_t *d);
+
+/* Exported functions --------------------------------------------------------*/
+void iap_delta_init(iap_delta_t *d, const uint8_t *old, uint32_t old_size)
+{
+    d->old = old;
+    d->old_size = old_size;
+    d->state = DELTA_OP;
+    d->op = 0;
+    d->shift = 0;
+    d->var = 0;
+    d->old_off = 0;
+    d->len = 0;
+    d->run = 0;
+}
+
+/**
+ * @brief  解码，直到输入用完或输出区写满
+ * @param  in_used  返回消耗的输入字节数
+ * @param  out_used 返回产生的输出字节数
+ * @retval 0 成功，-EINVAL 补丁格式错误或越界
+ */
+int iap_delta_feed(iap_delta_t *d, const uint8_t *in, uint16_t in_len, uint16_t *in_used,
+                   uint8_t *out, uint16_t out_len, uint16_t *out_used)
+{
+    uint16_t ip = 0;
+    uint16_t op = 0;
+    uint32_t n;
+    int ret;
+
+    for (;;) {
+        if (d->state == DELTA_COPY) {
+            /* 零游程：直接复制旧字节 */
+            n = d->run;
+            if (n > (uint32_t)(out_len - op))
+                n = out_len - op;
+            for (; n; n--, d->run--, d->len--)
+                out[op++] = d->old[d->old_off++];
+            if (d->run)
+                break;
+            d->state = d->len ? DELTA_LITLEN : DELTA_OP;
+            continue;
+        }
+
+        if (ip >= in_len)
+            break;
+        if ((d->state == DELTA_LIT || d->state == DELTA_EXTRA) && op >= out_len)
+            break;
+
+        switch (d->state) {
+            case DELTA_OP:
+                d->op = in[ip++];
+                if (d->op == IAP_DELTA_OP_DIFF)
+                    d->state = DELTA_OFF;
+                else if (d->op == IAP_DELTA_OP_EXTRA)
+                    d->state = DELTA_LEN;
+                else
+                    return -EINVAL;
+                break;
+            case DELTA_LIT:
+                out[op++] = (uint8_t)(d->old[d->old_off++] + in[ip++]);
+                d->len--;
+                if (--d->run == 0)
+                    d->state = d->len ? DELTA_ZRUN : DELTA_OP;
+                break;
+            case DELTA_EXTRA:
+                out[op++] = in[ip++];
+                if (--d->len == 0)
+                    d->state = DELTA_OP;
+                break;
+            default:
+                ret = delta_varint(d, in[ip++]);
+                if (ret < 0)
+                    return ret;
+                if (ret > 0) {
+                    ret = delta_var_done(d);
+                    if (ret != 0)
+                        return ret;
+                }
+                break;
+        }
+    }
+
+    *in_used = ip;
+    *out_used = op;
+
+    return 0;
+}
+
+/**
+ * @brief  是否处于两个操作之间 (补丁可以在此结束)
+ */
+uint8_t iap_delta_idle(const iap_delta_t *d)
+{
+    return d->state == DELTA_OP;
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @retval 1 变长整数读完，0 需要更多字节，负值格式错误
+ */
+static int delta_varint(iap_delta_t *d, uint8_t b)
+{
+    if (d->shift > 28)
+        return -EINVAL;
+
+    d->var |= (uint32_t)(b & 0x7F) << d->shift;
+    if (b & 0x80) {
+        d->shift += 7;
+        return 0;
+    }
+
+    return 1;
+}
+
+static int delta_var_done(iap_delta_t *d)
+{
+    uint32_t v = d->var;
+
+    d->var = 0;
+    d->shift = 0;
+
+    switch (d->state) {
+        case DELTA_OFF:
+            d->old_off = v;
+            d->state = DELTA_LEN;
+            break;
+        case DELTA_LEN:
+            d->len = v;
+            if (d->op == IAP_DELTA_OP_DIFF) {
+                if (d->old_off > d->old_size || v > d->old_size - d->old_off)
+                    return -EINVAL;
+                d->state = v ? DELTA_ZRUN : DELTA_OP;
+            } else {
+                d->state = v ? DELTA_EXTRA : DELTA_OP;
+            }
+            break;
+        case DELTA_ZRUN:
+            if (v > d->len)
+                return -EINVAL;
+            d->run = v;
+            d->state = DELTA_COPY;
+            break;
+        case DELTA_LITLEN:
+            if (v > d->len || (v == 0 && d->len))
+                return -EINVAL;
+            d->run = v;
+            d->state = v ? DELTA_LIT : DELTA_OP;
+            break;
+        default:
+            return -EINVAL;
+    }
+
+    return 0;
+}
+
+/******************************* End Of File ************************************/
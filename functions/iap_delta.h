@@ -0,0 +1,61 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : iap_delta.h
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 差分升级补丁流式解码
+  * @attention   : 补丁为 bsdiff 式的 diff/extra 操作序列，整数均为 LEB128 变长编码：
+  *                DIFF   0x00 旧偏移 长度 {零游程 字面长度 字面差值...}
+  *                       新字节 = 旧字节 + 差值，零游程内直接复制旧字节
+  *                EXTRA  0x01 长度 新字节...
+  *                解码器状态只有几个字，输入和输出都可以在任意字节处中断
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.xxx
+  ******************************************************************************
+  */
+#ifndef __IAP_DELTA_H__
+#define __IAP_DELTA_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sys_def.h"
+
+/* Exported define -----------------------------------------------------------*/
+#define IAP_DELTA_OP_DIFF               (0x00)
+#define IAP_DELTA_OP_EXTRA              (0x01)
+
+/* Exported typedef ----------------------------------------------------------*/
+typedef struct
+{
+    const uint8_t *old;                 /**< 旧镜像 (当前运行的固件) */
+    uint32_t old_size;
+    uint8_t  state;
+    uint8_t  op;
+    uint8_t  shift;                     /**< 变长整数已读位数 */
+    uint32_t var;                       /**< 变长整数累加值 */
+    uint32_t old_off;                   /**< DIFF 当前旧偏移 */
+    uint32_t len;                       /**< 当前操作剩余输出字节 */
+    uint32_t run;                       /**< 当前零游程/字面段剩余字节 */
+} iap_delta_t;
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported variable prototypes ----------------------------------------------*/
+
+/* Exported function prototypes ----------------------------------------------*/
+void iap_delta_init(iap_delta_t *d, const uint8_t *old, uint32_t old_size);
+int iap_delta_feed(iap_delta_t *d, const uint8_t *in, uint16_t in_len, uint16_t *in_used,
+                   uint8_t *out, uint16_t out_len, uint16_t *out_used);
+uint8_t iap_delta_idle(const iap_delta_t *d);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __IAP_DELTA_H__ */
@@ -0,0 +1,425 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : impd_adc.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 阻抗 ADC 采集：定时器触发 + DMA 循环双缓冲
+  * @attention   : TIM3 更新事件触发 ADC1 规则组扫描 (回路、贴附两个输入)，
+  *                DMA1 通道1 循环搬运交织的样本。DMA 中断清除半传输/传输完成标志，
+  *                把 {半区, 块序号} 投递到 mpsc 队列并唤醒调度器，任务取出后处理；
+  *                取出时其后又完成了一块 (DMA 已在覆盖该半区) 的块丢弃并计入溢出。
+  *                只为已使能的通道拆分数据，两种测量共用一路采集。
+  *                中断中同时读取 TIM3、DMA 计数和激励的瞬时相位，推算块首样本
+  *                采样时刻的激励相位，检测结果的相位以此为参考；两个定时器计数
+  *                各有 1us 的量化，参考相位的时间误差在 2us 以内
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.xxx
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "impd_adc.h"
+#include "board.h"
+#include "evt_sched.h"
+#include "mpsc_queue.h"
+#include "impd_exc.h"
+
+#define  LOG_TAG             "impd_adc"
+#define  LOG_LVL             4
+#include "log.h"
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+    impd_adc_block_cb_t cb;
+    void *user_data;
+    uint8_t enabled;
+} impd_adc_consumer_t;
+
+/* Private define ------------------------------------------------------------*/
+#define IMPD_ADC_TIM_CLK                (1000000UL) /* 触发定时器计数频率 */
+#define IMPD_ADC_QUEUE_SIZE             (4)
+#define IMPD_ADC_MSG_BLOCK              (1)         /* arg 为半区，data 为块序号 */
+#define IMPD_ADC_HALF_LEN               (IMPD_ADC_BLOCK_LEN * IMPD_ADC_CH_NUM)
+/* ADC 时钟 12MHz，71.5 + 12.5 周期：每个转换 7us，采样保持在转换开始后约 6us */
+#define IMPD_ADC_CONV_US                (7)
+#define IMPD_ADC_HOLD_US                (6)
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static ADC_HandleTypeDef hadc_impd;
+static DMA_HandleTypeDef hdma_impd;
+static TIM_HandleTypeDef htim_impd;
+
+static uint16_t adc_dma_buf[IMPD_ADC_BLOCK_LEN * IMPD_ADC_CH_NUM * 2];
+static uint16_t adc_ch_buf[IMPD_ADC_BLOCK_LEN];     /* 单通道拆分缓冲区，各通道依次复用 */
+static impd_adc_consumer_t adc_consumer[IMPD_ADC_CH_NUM];
+static uint32_t adc_sample_rate;
+static uint32_t adc_overrun;
+static uint8_t  adc_running;
+static mpsc_slot_t adc_slot[IMPD_ADC_QUEUE_SIZE];
+static mpsc_queue_t adc_queue;
+static volatile uint32_t adc_seq;                   /* 已完成的块数，中断中递增 */
+static volatile uint32_t adc_missed;                /* 中断来不及响应而丢失的块数 */
+static impd_adc_ref_t adc_blk_ref[IMPD_ADC_QUEUE_SIZE]; /* 按块序号存放，中断中写入 */
+static impd_adc_ref_t adc_ref;                      /* 正在处理的块和通道 */
+
+/* Exported variables  -------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+static size_t adc_get_block(const uint16_t **block, uint32_t *seq);
+static void adc_flush_queue(void);
+static void adc_capture_ref(impd_adc_ref_t *ref);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+ * @brief  初始化 ADC、DMA 和触发定时器
+ * @param  sample_rate 采样率 (Hz)，须能整除 1MHz 以保证与激励同步
+ * @retval 0 成功，负值失败
+ */
+int impd_adc_init(uint32_t sample_rate)
+{
+    GPIO_InitTypeDef gpio = {0};
+    ADC_ChannelConfTypeDef ch = {0};
+    TIM_MasterConfigTypeDef master = {0};
+    
+    if (sample_rate == 0 || sample_rate > IMPD_ADC_SAMPLE_RATE_MAX ||
+        (IMPD_ADC_TIM_CLK % sample_rate) != 0)
+        return -EINVAL;
+    
+    __HAL_RCC_GPIOA_CLK_ENABLE();
+    __HAL_RCC_ADC1_CLK_ENABLE();
+    __HAL_RCC_DMA1_CLK_ENABLE();
+    __HAL_RCC_TIM3_CLK_ENABLE();
+    
+    gpio.Pin = LOOP_IMPD_ADC_Pin;
+    gpio.Mode = GPIO_MODE_ANALOG;
+    HAL_GPIO_Init(LOOP_IMPD_ADC_GPIO_Port, &gpio);
+    gpio.Pin = ATTACH_IMPD_ADC_Pin;
+    HAL_GPIO_Init(ATTACH_IMPD_ADC_GPIO_Port, &gpio);
+    
+    hdma_impd.Instance = DMA1_Channel1;
+    hdma_impd.Init.Direction = DMA_PERIPH_TO_MEMORY;
+    hdma_impd.Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma_impd.Init.MemInc = DMA_MINC_ENABLE;
+    hdma_impd.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+    hdma_impd.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+    hdma_impd.Init.Mode = DMA_CIRCULAR;
+    hdma_impd.Init.Priority = DMA_PRIORITY_HIGH;
+    if (HAL_DMA_Init(&hdma_impd) != HAL_OK)
+        return -EIO;
+    __HAL_LINKDMA(&hadc_impd, DMA_Handle, hdma_impd);
+    HAL_NVIC_SetPriority(DMA1_Channel1_IRQn, 2, 0);
+    HAL_NVIC_EnableIRQ(DMA1_Channel1_IRQn);
+    
+    hadc_impd.Instance = ADC1;
+    hadc_impd.Init.ScanConvMode = ADC_SCAN_ENABLE;
+    hadc_impd.Init.ContinuousConvMode = DISABLE;
+    hadc_impd.Init.DiscontinuousConvMode = DISABLE;
+    hadc_impd.Init.ExternalTrigConv = ADC_EXTERNALTRIGCONV_T3_TRGO;
+    hadc_impd.Init.DataAlign = ADC_DATAALIGN_RIGHT;
+    hadc_impd.Init.NbrOfConversion = IMPD_ADC_CH_NUM;
+    if (HAL_ADC_Init(&hadc_impd) != HAL_OK)
+        return -EIO;
+    
+    ch.Channel = LOOP_IMPD_ADC_CHANNEL;
+    ch.Rank = ADC_REGULAR_RANK_1;
+    ch.SamplingTime = ADC_SAMPLETIME_71CYCLES_5;
+    if (HAL_ADC_ConfigChannel(&hadc_impd, &ch) != HAL_OK)
+        return -EIO;
+    
+    ch.Channel = ATTACH_IMPD_ADC_CHANNEL;
+    ch.Rank = ADC_REGULAR_RANK_2;
+    if (HAL_ADC_ConfigChannel(&hadc_impd, &ch) != HAL_OK)
+        return -EIO;
+    
+    if (HAL_ADCEx_Calibration_Start(&hadc_impd) != HAL_OK)
+        return -EIO;
+    
+    /* APB1 分频后定时器时钟为 SystemCoreClock */
+    htim_impd.Instance = TIM3;
+    htim_impd.Init.Prescaler = SystemCoreClock / IMPD_ADC_TIM_CLK - 1;
+    htim_impd.Init.CounterMode = TIM_COUNTERMODE_UP;
+    htim_impd.Init.Period = IMPD_ADC_TIM_CLK / sample_rate - 1;
+    htim_impd.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+    htim_impd.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_ENABLE;
+    if (HAL_TIM_Base_Init(&htim_impd) != HAL_OK)
+        return -EIO;
+    
+    master.MasterOutputTrigger = TIM_TRGO_UPDATE;
+    master.MasterSlaveMode = TIM_MASTERSLAVEMODE_DISABLE;
+    if (HAL_TIMEx_MasterConfigSynchronization(&htim_impd, &master) != HAL_OK)
+        return -EIO;
+    
+    adc_sample_rate = sample_rate;
+    adc_overrun = 0;
+    adc_missed = 0;
+    adc_running = 0;
+    mpsc_init(&adc_queue, adc_slot, IMPD_ADC_QUEUE_SIZE);
+    
+    return 0;
+}
+
+/**
+ * @brief  启动采集
+ * @retval 0 成功，负值失败
+ */
+int impd_adc_start(void)
+{
+    if (adc_running)
+        return 0;
+    
+    if (HAL_ADC_Start_DMA(&hadc_impd, (uint32_t*)adc_dma_buf, IMPD_ADC_BLOCK_LEN * IMPD_ADC_CH_NUM * 2) != HAL_OK) {
+        LOG_E("Failed to start ADC DMA\r\n");
+        return -EIO;
+    }
+    /* 只用半传输/传输完成中断，传输错误中断不使用 */
+    __HAL_DMA_DISABLE_IT(&hdma_impd, DMA_IT_TE);
+    __HAL_DMA_CLEAR_FLAG(&hdma_impd, __HAL_DMA_GET_HT_FLAG_INDEX(&hdma_impd) |
+                                     __HAL_DMA_GET_TC_FLAG_INDEX(&hdma_impd));
+    adc_flush_queue();
+    
+    __HAL_TIM_SET_COUNTER(&htim_impd, 0);
+    HAL_TIM_Base_Start(&htim_impd);
+    adc_running = 1;
+    
+    return 0;
+}
+
+/**
+ * @brief  停止采集
+ */
+void impd_adc_stop(void)
+{
+    if (!adc_running)
+        return;
+    
+    HAL_TIM_Base_Stop(&htim_impd);
+    HAL_ADC_Stop_DMA(&hadc_impd);
+    adc_running = 0;
+    adc_flush_queue();
+}
+
+uint32_t impd_adc_get_sample_rate(void)
+{
+    return adc_sample_rate;
+}
+
+/**
+ * @brief  注册通道数据块处理函数，注册后默认使能
+ * @retval 0 成功，-EINVAL 参数错误
+ */
+int impd_adc_register(uint8_t ch, impd_adc_block_cb_t cb, void *user_data)
+{
+    if (ch >= IMPD_ADC_CH_NUM)
+        return -EINVAL;
+    
+    adc_consumer[ch].cb = cb;
+    adc_consumer[ch].user_data = user_data;
+    adc_consumer[ch].enabled = (cb != NULL);
+    
+    return 0;
+}
+
+/**
+ * @brief  使能/禁止通道数据处理，不影响采集，禁止的通道不做拆分
+ * @retval 0 成功，-EINVAL 参数错误
+ */
+int impd_adc_enable(uint8_t ch, uint8_t en)
+{
+    if (ch >= IMPD_ADC_CH_NUM)
+        return -EINVAL;
+    
+    adc_consumer[ch].enabled = (en != 0);
+    
+    return 0;
+}
+
+/**
+ * @brief  处理所有已完成的数据块：按通道拆分后交给处理函数
+ */
+void impd_adc_service(void)
+{
+    const impd_adc_ref_t *blk;
+    const uint16_t *raw;
+    uint32_t seq, period = IMPD_ADC_TIM_CLK / adc_sample_rate;
+    size_t n, i;
+    uint8_t ch;
+    
+    while ((n = adc_get_block(&raw, &seq)) != 0) {
+        blk = &adc_blk_ref[seq & (IMPD_ADC_QUEUE_SIZE - 1)];
+        for (ch = 0; ch < IMPD_ADC_CH_NUM; ch++) {
+            if (!adc_consumer[ch].enabled || !adc_consumer[ch].cb)
+                continue;
+            for (i = 0; i < n; i++)
+                adc_ch_buf[i] = raw[i * IMPD_ADC_CH_NUM + ch];
+            /* 各通道的采样时刻相对触发依次推迟一个转换时间 */
+            adc_ref = *blk;
+            adc_ref.exc_phase += (uint32_t)(((uint64_t)blk->exc_inc *
+                                 (ch * IMPD_ADC_CONV_US + IMPD_ADC_HOLD_US)) / period);
+            adc_consumer[ch].cb(adc_ch_buf, n, adc_consumer[ch].user_data);
+        }
+    }
+}
+
+/**
+ * @brief  读取当前数据块的激励参考，只在数据块处理函数中有效
+ */
+const impd_adc_ref_t *impd_adc_get_ref(void)
+{
+    return &adc_ref;
+}
+
+/**
+ * @brief  读取丢弃的块数：主循环来不及处理、队列满或中断来不及响应
+ */
+uint32_t impd_adc_get_overrun(void)
+{
+    return adc_overrun + adc_missed + mpsc_get_dropped(&adc_queue);
+}
+
+/**
+ * @brief  DMA1 通道1 中断：清除标志，投递完成的半区并通知调度器
+ * @note   两个标志同时置位说明中断被屏蔽超过一个块的时间，无法判断哪个半区较新，
+ *         两块都丢弃
+ */
+void DMA1_Channel1_IRQHandler(void)
+{
+    uint32_t ht = __HAL_DMA_GET_HT_FLAG_INDEX(&hdma_impd);
+    uint32_t tc = __HAL_DMA_GET_TC_FLAG_INDEX(&hdma_impd);
+    uint32_t ht_set = __HAL_DMA_GET_FLAG(&hdma_impd, ht);
+    uint32_t tc_set = __HAL_DMA_GET_FLAG(&hdma_impd, tc);
+    mpsc_msg_t msg;
+    
+    __HAL_DMA_CLEAR_FLAG(&hdma_impd, ht | tc | __HAL_DMA_GET_TE_FLAG_INDEX(&hdma_impd));
+    if (ht_set && tc_set) {
+        adc_seq += 2;
+        adc_missed += 2;
+        return;
+    }
+    if (!ht_set && !tc_set)
+        return;
+    
+    adc_blk_ref[adc_seq & (IMPD_ADC_QUEUE_SIZE - 1)].seq = adc_seq;
+    adc_capture_ref(&adc_blk_ref[adc_seq & (IMPD_ADC_QUEUE_SIZE - 1)]);
+    msg.id = IMPD_ADC_MSG_BLOCK;
+    msg.arg = tc_set ? 1 : 0;
+    msg.data = adc_seq++;
+    mpsc_post(&adc_queue, &msg);
+    sched_post(SCHED_EVT_ADC);
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  取出一个已完成的数据块
+ * @param  block 输出交织数据块指针，在下一次 DMA 覆盖该半区之前有效
+ * @param  seq   输出块序号
+ * @retval 块内每通道样本数，无新数据时返回 0
+ * @note   取出时之后又完成了一块，说明 DMA 已在覆盖该半区，丢弃并计入溢出
+ */
+static size_t adc_get_block(const uint16_t **block, uint32_t *seq)
+{
+    mpsc_msg_t msg;
+    
+    while (mpsc_take(&adc_queue, &msg)) {
+        if (!adc_running || msg.id != IMPD_ADC_MSG_BLOCK)
+            continue;
+        if (adc_seq - msg.data > 1) {
+            adc_overrun++;
+            continue;
+        }
+        *block = &adc_dma_buf[msg.arg * IMPD_ADC_BLOCK_LEN * IMPD_ADC_CH_NUM];
+        *seq = msg.data;
+        return IMPD_ADC_BLOCK_LEN;
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief  丢弃队列中的块，在采集停止或 DMA 重新开始时调用
+ */
+static void adc_flush_queue(void)
+{
+    mpsc_msg_t msg;
+    
+    while (mpsc_take(&adc_queue, &msg))
+        ;
+}
+
+/**
+ * @brief  最近一次触发后已完成的转换数
+ * @param  cnt 触发后经过的微秒数 (TIM3 计数)
+ * @param  x   新半区中已搬运的样本数，与完成的转换数对通道数同余
+ * @retval 完成的转换数，与 x 矛盾时返回 -1
+ * @note   第 k 个转换在触发后约 k * IMPD_ADC_CONV_US 结束，cnt 恰好落在该值时由 x 判断
+ */
+static int32_t adc_conv_done(uint32_t cnt, uint32_t x)
+{
+    int32_t r = 0;
+    uint8_t k;
+    
+    for (k = 1; k <= IMPD_ADC_CH_NUM; k++) {
+        if (cnt > k * IMPD_ADC_CONV_US) {
+            r = k;
+        } else {
+            if (cnt == k * IMPD_ADC_CONV_US && ((int32_t)x - k) % IMPD_ADC_CH_NUM == 0)
+                r = k;
+            break;
+        }
+    }
+    
+    return (((int32_t)x - r) % IMPD_ADC_CH_NUM == 0) ? r : -1;
+}
+
+/**
+ * @brief  推算刚完成的块的首样本触发时刻的激励相位，在 DMA 中断中调用
+ * @note   最后一个样本的触发距今 age = m·T + cnt，m 为其后已发生的触发数，
+ *         由新半区已搬运的样本数和本次触发已完成的转换数得出
+ */
+static void adc_capture_ref(impd_adc_ref_t *ref)
+{
+    impd_exc_snap_t snap;
+    uint32_t primask, cnt, left, x, age, inc;
+    uint32_t period = IMPD_ADC_TIM_CLK / adc_sample_rate;
+    int32_t r;
+    int ret;
+    
+    ref->exc_from = IMPD_ADC_BLOCK_LEN;
+    ref->exc_phase = 0;
+    ref->exc_inc = 0;
+    ref->exc_gen = 0;
+    
+    primask = __get_PRIMASK();
+    __disable_irq();
+    do {
+        cnt = __HAL_TIM_GET_COUNTER(&htim_impd);
+        left = __HAL_DMA_GET_COUNTER(&hdma_impd);
+    } while (cnt != __HAL_TIM_GET_COUNTER(&htim_impd));
+    ret = impd_exc_snapshot(&snap);
+    __set_PRIMASK(primask);
+    if (ret != 0)
+        return;
+    
+    x = (IMPD_ADC_HALF_LEN * 2 - left) % IMPD_ADC_HALF_LEN;
+    r = adc_conv_done(cnt, x);
+    if (r < 0)
+        return;
+    age = (uint32_t)(1 + ((int32_t)x - r) / IMPD_ADC_CH_NUM) * period + cnt;
+    
+    inc = IMPD_EXC_US_PHASE(snap.inc, period);
+    ref->exc_inc = inc;
+    ref->exc_phase = snap.phase - IMPD_EXC_US_PHASE(snap.inc, age) - inc * (IMPD_ADC_BLOCK_LEN - 1);
+    ref->exc_gen = snap.gen;
+    
+    /* 第 i 个样本的触发距今 age + (块长 - 1 - i)·T，不早于参数生效时刻的样本才属于当前参数 */
+    if (snap.gen_us < age)
+        return;
+    age = (snap.gen_us - age) / period;
+    ref->exc_from = (age >= IMPD_ADC_BLOCK_LEN - 1) ? 0 : (uint16_t)(IMPD_ADC_BLOCK_LEN - 1 - age);
+}
+
+/******************************* End Of File ************************************/
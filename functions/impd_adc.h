@@ -0,0 +1,83 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : impd_adc.h
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 阻抗 ADC 采集：定时器触发 + DMA 循环双缓冲
+  * @attention   : 回路阻抗和贴附阻抗两个输入在同一个规则组扫描序列中交替转换，
+  *                完成的半缓冲区由 impd_adc_service 轮询取出，按块拆分到各通道
+  *                后交给已注册的处理函数；主循环周期须小于一个数据块的时长
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.xxx
+  ******************************************************************************
+  */
+#ifndef __IMPD_ADC_H__
+#define __IMPD_ADC_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sys_def.h"
+
+/* Exported define -----------------------------------------------------------*/
+#define IMPD_ADC_SAMPLE_RATE_DEFAULT    (10000)     /**< 默认采样率 (Hz) */
+#define IMPD_ADC_SAMPLE_RATE_MAX        (40000)     /**< 最大采样率 (Hz) */
+#define IMPD_ADC_BLOCK_LEN              (250)       /**< 每块每通道样本数 (半个 DMA 缓冲区) */
+
+/* Exported typedef ----------------------------------------------------------*/
+/**
+ * @brief 扫描序列中的通道，枚举值即规则组中的转换顺序
+ */
+enum impd_adc_ch {
+    IMPD_ADC_CH_LOOP,
+    IMPD_ADC_CH_ATTACH,
+    IMPD_ADC_CH_NUM
+};
+
+/**
+ * @brief 通道数据块处理函数，block 在下一次调用 impd_adc_service 之前有效
+ */
+typedef void (*impd_adc_block_cb_t)(const uint16_t *block, size_t n, void *user_data);
+
+/**
+ * @brief 当前数据块的激励参考，在数据块处理函数中由 impd_adc_get_ref 取得
+ * @note  exc_phase 为块首样本采样时刻的激励相位，每样本增加 exc_inc，
+ *        可直接交给 goertzel_set_ref。块末样本处激励参数的代号为 exc_gen，
+ *        该参数从第 exc_from 个样本起生效，此前的样本属于旧参数，相位参考只对
+ *        exc_from 之后的样本成立；激励未运行或无法确定时 exc_from 为块长
+ */
+typedef struct
+{
+    uint32_t seq;           /**< 块序号 */
+    uint32_t exc_phase;     /**< 块首样本处的激励相位 */
+    uint32_t exc_inc;       /**< 激励相位的每样本增量 */
+    uint32_t exc_gen;       /**< 激励参数代号，见 impd_exc_get_gen() */
+    uint16_t exc_from;      /**< 当前激励参数下的首个样本，块长表示整块无效 */
+} impd_adc_ref_t;
+
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported variable prototypes ----------------------------------------------*/
+
+/* Exported function prototypes ----------------------------------------------*/
+int impd_adc_init(uint32_t sample_rate);
+int impd_adc_start(void);
+void impd_adc_stop(void);
+uint32_t impd_adc_get_sample_rate(void);
+int impd_adc_register(uint8_t ch, impd_adc_block_cb_t cb, void *user_data);
+int impd_adc_enable(uint8_t ch, uint8_t en);
+void impd_adc_service(void);
+const impd_adc_ref_t *impd_adc_get_ref(void);
+uint32_t impd_adc_get_overrun(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __IMPD_ADC_H__ */
@@ -0,0 +1,501 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : impd_cal.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 阻抗多点自动校准：逐点平均、分段线性/多项式拟合、保存到 flash
+  * @attention   : 流程：impd_cal_start -> (impd_cal_add_point -> 平均 N 块) x 点数
+  *                -> impd_cal_finish。分段斜率为 Q16 定点；多项式法方程由 Q12
+  *                自变量累加，4x4 以内的方程组用双精度消元求解后取整为定点系数，
+  *                运行时换算全部为整数运算
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.xxx
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "impd_cal.h"
+#include "data_mgmt.h"
+#include "mtd_core.h"
+#include "crc.h"
+#include "board.h"
+#include <string.h>
+#include <stddef.h>
+
+#define  LOG_TAG             "impd_cal"
+#define  LOG_LVL             4
+#include "log.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/**
+ * @brief 校准过程中的 RAM 覆盖层：只保存本次采集的点和拟合结果，
+ *        拟合后未保存时替代 flash 中的表生效，分段斜率在换算时现算
+ */
+typedef struct
+{
+    uint8_t  active;                            /* 覆盖层已生效 */
+    uint8_t  fit;
+    uint8_t  n;                                 /* 已采集点数 */
+    uint8_t  m;                                 /* 多项式系数个数 */
+    int32_t  x[IMPD_CAL_POINT_MAX];
+    int32_t  y[IMPD_CAL_POINT_MAX];
+    int32_t  coef[IMPD_CAL_POLY_DEGREE_MAX + 1];
+} cal_overlay_t;
+
+/* Private define ------------------------------------------------------------*/
+#define CAL_POLY_T_SHIFT                (15 - IMPD_CAL_POLY_SHIFT)
+#define CAL_TABLE_FLASH                 ((const impd_cal_table_t *)(STM32_FLASH_START_ADDR + CAL_TABLE_BASE_ADDR))
+#define CAL_SLOPE_CHUNK                 (8)         /* 写 flash 时每次计算的斜率个数 */
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static const impd_cal_table_t *cal_table;       /* 指向 flash 中的有效表，无效时为 NULL */
+static cal_overlay_t cal_ovl;
+
+static uint8_t  cal_state = IMPD_CAL_IDLE;
+static uint16_t cal_blocks;                     /* 每点平均块数 */
+static uint8_t  cal_degree;
+static int64_t  cal_acc;
+static uint16_t cal_acc_cnt;
+static uint32_t cal_ref;                        /* 当前点参考电阻 */
+static impd_cal_point_cb_t cal_on_point;
+static void *cal_user_data;
+
+/* Exported variables  -------------------------------------------------------*/
+extern struct mtd_info stm32_flash_info;
+
+/* Private function prototypes -----------------------------------------------*/
+static int cal_table_valid(const impd_cal_table_t *t);
+static int cal_table_flush(const cal_overlay_t *o);
+static int cal_slope(const int32_t *x, const int32_t *y, uint8_t i, int32_t *slope);
+static int cal_fit_piecewise(cal_overlay_t *o);
+static int cal_fit_poly(cal_overlay_t *o, uint8_t degree);
+static int64_t cal_eval_piecewise(const int32_t *x, const int32_t *y, const int32_t *slope,
+                                  uint8_t n, int32_t reading);
+static int64_t cal_eval_poly(const int32_t *coef, uint8_t m, int32_t reading);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+ * @brief  校验 flash 中的校准表，直接在 flash 中读取，不复制到 RAM
+ */
+void impd_cal_init(impd_cal_point_cb_t on_point, void *user_data)
+{
+    cal_on_point = on_point;
+    cal_user_data = user_data;
+    cal_state = IMPD_CAL_IDLE;
+    cal_ovl.active = 0;
+    
+    cal_table = CAL_TABLE_FLASH;
+    if (!cal_table_valid(cal_table)) {
+        cal_table = NULL;
+        LOG_D("No valid calibration table!\r\n");
+    }
+}
+
+/**
+ * @brief  开始一次校准，丢弃之前未完成的校准
+ * @param  blocks 每点平均的块数
+ * @param  fit    enum impd_cal_fit
+ * @param  degree 多项式阶数 (分段拟合时忽略)
+ * @retval 0 成功，-EINVAL 参数错误
+ * @note   已生效但未保存的拟合结果被丢弃，恢复使用 flash 中的表
+ */
+int impd_cal_start(uint16_t blocks, uint8_t fit, uint8_t degree)
+{
+    if (blocks == 0 || blocks > IMPD_CAL_BLOCKS_MAX)
+        return -EINVAL;
+    if (fit != IMPD_CAL_FIT_PIECEWISE && fit != IMPD_CAL_FIT_POLY)
+        return -EINVAL;
+    if (fit == IMPD_CAL_FIT_POLY && (degree == 0 || degree > IMPD_CAL_POLY_DEGREE_MAX))
+        return -EINVAL;
+    
+    cal_ovl.active = 0;
+    cal_ovl.fit = fit;
+    cal_ovl.n = 0;
+    cal_ovl.m = 0;
+    cal_blocks = blocks;
+    cal_degree = degree;
+    cal_state = IMPD_CAL_RUNNING;
+    
+    return 0;
+}
+
+/**
+ * @brief  主机已接入参考电阻，开始平均当前点
+ * @retval 0 成功，-EINVAL 未开始校准，-EBUSY 上一点未完成，-ENOSPC 点数已满
+ */
+int impd_cal_add_point(uint32_t ref_mohm)
+{
+    if (cal_state == IMPD_CAL_SAMPLING)
+        return -EBUSY;
+    if (cal_state != IMPD_CAL_RUNNING || ref_mohm > INT32_MAX)
+        return -EINVAL;
+    if (cal_ovl.n >= IMPD_CAL_POINT_MAX)
+        return -ENOSPC;
+    
+    cal_ref = ref_mohm;
+    cal_acc = 0;
+    cal_acc_cnt = 0;
+    cal_state = IMPD_CAL_SAMPLING;
+    
+    return 0;
+}
+
+/**
+ * @brief  输入一个块的读数，平均满 N 块后记录该点
+ */
+void impd_cal_feed(int32_t reading)
+{
+    uint8_t idx;
+    int32_t avg;
+    
+    if (cal_state != IMPD_CAL_SAMPLING)
+        return;
+    
+    cal_acc += reading;
+    if (++cal_acc_cnt < cal_blocks)
+        return;
+    
+    avg = (int32_t)((cal_acc + cal_acc_cnt / 2) / cal_acc_cnt);
+    idx = cal_ovl.n++;
+    cal_ovl.x[idx] = avg;
+    cal_ovl.y[idx] = (int32_t)cal_ref;
+    cal_state = IMPD_CAL_RUNNING;
+    
+    LOG_D("cal point %d: %d mohm -> %d\r\n", idx, cal_ref, avg);
+    
+    if (cal_on_point)
+        cal_on_point(idx, cal_ref, avg, cal_user_data);
+}
+
+/**
+ * @brief  结束校准：拟合并立即生效，可选保存到 flash
+ * @param  save 非零时写入 flash，否则只在 RAM 覆盖层中生效到下次上电
+ * @retval 0 成功，-EBUSY 当前点未完成，-EINVAL 未开始或点数不足/读数重复，
+ *         -ERANGE 拟合结果超出定点范围，其他为 flash 错误 (拟合结果仍在 RAM 中生效)
+ */
+int impd_cal_finish(uint8_t save)
+{
+    int ret;
+    
+    if (cal_state == IMPD_CAL_SAMPLING)
+        return -EBUSY;
+    if (cal_state != IMPD_CAL_RUNNING)
+        return -EINVAL;
+    
+    if (cal_ovl.fit == IMPD_CAL_FIT_POLY)
+        ret = cal_fit_poly(&cal_ovl, cal_degree);
+    else
+        ret = cal_fit_piecewise(&cal_ovl);
+    if (ret != 0)
+        return ret;
+    
+    cal_state = IMPD_CAL_IDLE;
+    if (save) {
+        ret = cal_table_flush(&cal_ovl);
+        if (ret != 0) {
+            /* 擦除后写入失败时 flash 中的旧表可能已不存在，拟合结果留在覆盖层中继续使用 */
+            LOG_E("Failed to save calibration table: %d\r\n", ret);
+            cal_table = cal_table_valid(CAL_TABLE_FLASH) ? CAL_TABLE_FLASH : NULL;
+            cal_ovl.active = 1;
+            return ret;
+        }
+        cal_table = CAL_TABLE_FLASH;
+        cal_ovl.active = 0;
+    } else {
+        cal_ovl.active = 1;
+    }
+    
+    return 0;
+}
+
+void impd_cal_abort(void)
+{
+    cal_state = IMPD_CAL_IDLE;
+}
+
+uint8_t impd_cal_get_state(void)
+{
+    return cal_state;
+}
+
+/**
+ * @brief  flash 中的校准表 (只读，直接映射)，无效时返回 NULL
+ */
+const impd_cal_table_t *impd_cal_get_table(void)
+{
+    return cal_table;
+}
+
+/**
+ * @brief  读数换算为电阻，优先使用未保存的拟合结果
+ * @param  reading 读数 (Q15 满量程)
+ * @param  mohm    输出电阻 (mΩ)
+ * @retval 0 成功，-ENODEV 未校准，-ERANGE 结果溢出
+ * @note   分段拟合在两端按首末段外推
+ */
+int impd_cal_convert(int32_t reading, int32_t *mohm)
+{
+    const impd_cal_table_t *t = cal_table;
+    int64_t y;
+    
+    if (cal_ovl.active) {
+        if (cal_ovl.fit == IMPD_CAL_FIT_POLY)
+            y = cal_eval_poly(cal_ovl.coef, cal_ovl.m, reading);
+        else
+            y = cal_eval_piecewise(cal_ovl.x, cal_ovl.y, NULL, cal_ovl.n, reading);
+    } else if (t) {
+        if (t->fit == IMPD_CAL_FIT_POLY)
+            y = cal_eval_poly(t->coef, t->n, reading);
+        else
+            y = cal_eval_piecewise(t->x, t->y, t->slope_q16, t->n, reading);
+    } else {
+        return -ENODEV;
+    }
+    
+    if (y > INT32_MAX || y < INT32_MIN)
+        return -ERANGE;
+    *mohm = (int32_t)y;
+    
+    return 0;
+}
+
+/* Private functions ---------------------------------------------------------*/
+static int cal_table_valid(const impd_cal_table_t *t)
+{
+    if (t->magic != IMPD_CAL_TABLE_MAGIC || t->version != IMPD_CAL_TABLE_VERSION)
+        return 0;
+    if (t->fit == IMPD_CAL_FIT_PIECEWISE && (t->n < 2 || t->n > IMPD_CAL_POINT_MAX))
+        return 0;
+    if (t->fit == IMPD_CAL_FIT_POLY && (t->n < 2 || t->n > IMPD_CAL_POLY_DEGREE_MAX + 1))
+        return 0;
+    if (t->fit != IMPD_CAL_FIT_PIECEWISE && t->fit != IMPD_CAL_FIT_POLY)
+        return 0;
+    
+    return t->crc == crc16_modbus((const uint8_t*)t, offsetof(impd_cal_table_t, crc));
+}
+
+/**
+ * @brief  将拟合结果写入 flash 校准页
+ * @note   先写数据，再写表头，最后按 flash 中的实际内容计算并写入 CRC，
+ *         中途掉电时魔术码或 CRC 不完整，上电校验失败。斜率分块现算后写入，
+ *         不需要在 RAM 中组装整张表
+ */
+static int cal_table_flush(const cal_overlay_t *o)
+{
+    const impd_cal_table_t *t = CAL_TABLE_FLASH;
+    struct erase_info info;
+    int32_t slope[CAL_SLOPE_CHUNK];
+    uint8_t hdr[8];
+    uint16_t crc;
+    size_t retlen;
+    uint8_t i, k;
+    int ret;
+    
+    info.addr = CAL_TABLE_BASE_ADDR;
+    info.len = sizeof(impd_cal_table_t);
+    ret = mtd_erase(&stm32_flash_info, &info);
+    if (ret != 0)
+        return ret;
+    
+    ret = mtd_write(&stm32_flash_info, CAL_TABLE_BASE_ADDR + offsetof(impd_cal_table_t, x),
+                    o->n * sizeof(int32_t), &retlen, (const uint8_t*)o->x);
+    if (ret == 0)
+        ret = mtd_write(&stm32_flash_info, CAL_TABLE_BASE_ADDR + offsetof(impd_cal_table_t, y),
+                        o->n * sizeof(int32_t), &retlen, (const uint8_t*)o->y);
+    
+    if (o->fit == IMPD_CAL_FIT_POLY) {
+        if (ret == 0)
+            ret = mtd_write(&stm32_flash_info, CAL_TABLE_BASE_ADDR + offsetof(impd_cal_table_t, coef),
+                            o->m * sizeof(int32_t), &retlen, (const uint8_t*)o->coef);
+    } else {
+        for (i = 0; ret == 0 && i + 1 < o->n; i += k) {
+            for (k = 0; k < CAL_SLOPE_CHUNK && i + k + 1 < o->n; k++)
+                cal_slope(o->x, o->y, i + k, &slope[k]);
+            ret = mtd_write(&stm32_flash_info,
+                            CAL_TABLE_BASE_ADDR + offsetof(impd_cal_table_t, slope_q16) + i * sizeof(int32_t),
+                            k * sizeof(int32_t), &retlen, (const uint8_t*)slope);
+        }
+    }
+    if (ret != 0)
+        return -EIO;
+    
+    hdr[0] = IMPD_CAL_TABLE_MAGIC & 0xFF;
+    hdr[1] = (IMPD_CAL_TABLE_MAGIC >> 8) & 0xFF;
+    hdr[2] = (IMPD_CAL_TABLE_MAGIC >> 16) & 0xFF;
+    hdr[3] = (IMPD_CAL_TABLE_MAGIC >> 24) & 0xFF;
+    hdr[4] = IMPD_CAL_TABLE_VERSION & 0xFF;
+    hdr[5] = (IMPD_CAL_TABLE_VERSION >> 8) & 0xFF;
+    hdr[6] = o->fit;
+    hdr[7] = (o->fit == IMPD_CAL_FIT_POLY) ? o->m : o->n;
+    ret = mtd_write(&stm32_flash_info, CAL_TABLE_BASE_ADDR, sizeof(hdr), &retlen, hdr);
+    if (ret != 0)
+        return -EIO;
+    
+    crc = crc16_modbus((const uint8_t*)t, offsetof(impd_cal_table_t, crc));
+    ret = mtd_write(&stm32_flash_info, CAL_TABLE_BASE_ADDR + offsetof(impd_cal_table_t, crc),
+                    sizeof(crc), &retlen, (const uint8_t*)&crc);
+    if (ret != 0 || !cal_table_valid(t))
+        return -EIO;
+    
+    return 0;
+}
+
+/**
+ * @brief  第 i 段 (x[i], x[i+1]) 的斜率，mΩ/读数，Q16
+ * @retval 0 成功，-ERANGE 超出 int32
+ */
+static int cal_slope(const int32_t *x, const int32_t *y, uint8_t i, int32_t *slope)
+{
+    int64_t s = (((int64_t)y[i + 1] - y[i]) * 65536) / ((int64_t)x[i + 1] - x[i]);
+    
+    if (s > INT32_MAX || s < INT32_MIN)
+        return -ERANGE;
+    *slope = (int32_t)s;
+    
+    return 0;
+}
+
+/**
+ * @brief  按读数升序排列校准点并检查各段斜率
+ */
+static int cal_fit_piecewise(cal_overlay_t *o)
+{
+    int32_t x, y, slope;
+    uint8_t i, j;
+    
+    if (o->n < 2)
+        return -EINVAL;
+    
+    for (i = 1; i < o->n; i++) {
+        x = o->x[i];
+        y = o->y[i];
+        for (j = i; j > 0 && o->x[j - 1] > x; j--) {
+            o->x[j] = o->x[j - 1];
+            o->y[j] = o->y[j - 1];
+        }
+        o->x[j] = x;
+        o->y[j] = y;
+    }
+    
+    for (i = 0; i + 1 < o->n; i++) {
+        if (o->x[i + 1] == o->x[i])
+            return -EINVAL;
+        if (cal_slope(o->x, o->y, i, &slope) != 0)
+            return -ERANGE;
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief  最小二乘多项式拟合，系数取整为 mΩ
+ * @note   自变量与运行时一致取 Q12 截断值，避免拟合与换算之间的量化偏差
+ */
+static int cal_fit_poly(cal_overlay_t *o, uint8_t degree)
+{
+    double a[IMPD_CAL_POLY_DEGREE_MAX + 1][IMPD_CAL_POLY_DEGREE_MAX + 2];
+    double tp[2 * IMPD_CAL_POLY_DEGREE_MAX + 1];
+    double f, c;
+    uint8_t m = degree + 1;
+    uint8_t i, j, k, p;
+    
+    if (o->n < m)
+        return -EINVAL;
+    
+    memset(a, 0, sizeof(a));
+    for (i = 0; i < o->n; i++) {
+        tp[0] = 1.0;
+        f = (double)(o->x[i] >> CAL_POLY_T_SHIFT) / (double)(1 << IMPD_CAL_POLY_SHIFT);
+        for (k = 1; k < 2 * m - 1; k++)
+            tp[k] = tp[k - 1] * f;
+        for (j = 0; j < m; j++) {
+            for (k = 0; k < m; k++)
+                a[j][k] += tp[j + k];
+            a[j][m] += (double)o->y[i] * tp[j];
+        }
+    }
+    
+    /* 列主元高斯消元 */
+    for (k = 0; k < m; k++) {
+        p = k;
+        for (i = k + 1; i < m; i++)
+            if ((a[i][k] < 0 ? -a[i][k] : a[i][k]) > (a[p][k] < 0 ? -a[p][k] : a[p][k]))
+                p = i;
+        if (a[p][k] == 0.0)
+            return -EINVAL;
+        if (p != k) {
+            for (j = 0; j <= m; j++) {
+                c = a[k][j];
+                a[k][j] = a[p][j];
+                a[p][j] = c;
+            }
+        }
+        for (i = k + 1; i < m; i++) {
+            f = a[i][k] / a[k][k];
+            for (j = k; j <= m; j++)
+                a[i][j] -= f * a[k][j];
+        }
+    }
+    for (k = m; k-- > 0; ) {
+        c = a[k][m];
+        for (j = k + 1; j < m; j++)
+            c -= a[k][j] * a[j][m];
+        a[k][m] = c / a[k][k];
+    }
+    
+    for (k = 0; k < m; k++) {
+        c = a[k][m];
+        if (c > (double)INT32_MAX || c < (double)INT32_MIN)
+            return -ERANGE;
+        o->coef[k] = (int32_t)(c < 0 ? c - 0.5 : c + 0.5);
+    }
+    o->m = m;
+    
+    return 0;
+}
+
+/**
+ * @brief  分段线性换算，slope 为 NULL 时现算斜率
+ */
+static int64_t cal_eval_piecewise(const int32_t *x, const int32_t *y, const int32_t *slope,
+                                  uint8_t n, int32_t reading)
+{
+    uint8_t lo = 0, hi = n - 2, mid;
+    int32_t s;
+    
+    while (lo < hi) {
+        mid = (lo + hi + 1) / 2;
+        if (reading >= x[mid])
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+    
+    if (slope)
+        s = slope[lo];
+    else
+        cal_slope(x, y, lo, &s);
+    
+    return y[lo] + (((int64_t)s * (reading - x[lo]) + 0x8000) >> 16);
+}
+
+/**
+ * @brief  多项式换算，Horner 法，自变量 Q12
+ */
+static int64_t cal_eval_poly(const int32_t *coef, uint8_t m, int32_t reading)
+{
+    int32_t tq = reading >> CAL_POLY_T_SHIFT;
+    int64_t y = coef[m - 1];
+    int8_t k;
+    
+    for (k = m - 2; k >= 0; k--)
+        y = ((y * tq) >> IMPD_CAL_POLY_SHIFT) + coef[k];
+    
+    return y;
+}
+
+/******************************* End Of File ************************************/
@@ -0,0 +1,91 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : impd_cal.h
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 阻抗多点自动校准：逐点平均、分段线性/多项式拟合、保存到 flash
+  * @attention   : 读数为第一个频点每个 ADC 块的幅值 (Q15 满量程)，
+  *                校准结果为 读数 -> 电阻 (mΩ) 的映射
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.xxx
+  ******************************************************************************
+  */
+#ifndef __IMPD_CAL_H__
+#define __IMPD_CAL_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sys_def.h"
+
+/* Exported define -----------------------------------------------------------*/
+#define IMPD_CAL_POINT_MAX              (32)        /**< 最大校准点数 */
+#define IMPD_CAL_BLOCKS_MAX             (400)       /**< 每点最多平均的块数 */
+#define IMPD_CAL_POLY_DEGREE_MAX        (3)         /**< 多项式最高阶数 */
+#define IMPD_CAL_POLY_SHIFT             (12)        /**< 多项式自变量 t = 读数 >> 3，[0, 1) 的 Q12 */
+
+#define IMPD_CAL_TABLE_MAGIC            (0x4C414349UL)  /**< "ICAL" */
+#define IMPD_CAL_TABLE_VERSION          (1)
+
+/* Exported typedef ----------------------------------------------------------*/
+enum impd_cal_fit {
+    IMPD_CAL_FIT_PIECEWISE,         /**< 分段线性 */
+    IMPD_CAL_FIT_POLY,              /**< 最小二乘多项式 */
+};
+
+enum impd_cal_state {
+    IMPD_CAL_IDLE,                  /**< 未校准 */
+    IMPD_CAL_RUNNING,               /**< 等待主机给出参考电阻 */
+    IMPD_CAL_SAMPLING,              /**< 正在平均当前点 */
+};
+
+/**
+ * @brief 校准表，按此格式保存在 flash 中，运行时通过 const 指针直接读取
+ * @note  各字段均按自然边界对齐，不使用 packed，保证在 flash 中原地访问时对齐
+ *        分段线性：x[] 升序，slope_q16[i] 为第 i 段 (x[i], x[i+1]) 的斜率 (mΩ/读数，Q16)；
+ *        多项式：y = coef[0] + coef[1]*t + coef[2]*t^2 + coef[3]*t^3 (mΩ)，
+ *        t = 读数 / 32768，定点计算时取 Q12
+ */
+typedef struct
+{
+    uint32_t magic;                             /**< IMPD_CAL_TABLE_MAGIC */
+    uint16_t version;                           /**< IMPD_CAL_TABLE_VERSION */
+    uint8_t  fit;                               /**< enum impd_cal_fit */
+    uint8_t  n;                                 /**< 分段：点数；多项式：阶数 + 1 */
+    int32_t  x[IMPD_CAL_POINT_MAX];             /**< 读数 */
+    int32_t  y[IMPD_CAL_POINT_MAX];             /**< 参考电阻 (mΩ) */
+    int32_t  slope_q16[IMPD_CAL_POINT_MAX];     /**< 分段斜率 */
+    int32_t  coef[IMPD_CAL_POLY_DEGREE_MAX + 1];/**< 多项式系数 */
+    uint16_t crc;                               /**< 以上所有字段的 CRC16 */
+} impd_cal_table_t;
+
+/**
+ * @brief 单点平均完成回调
+ */
+typedef void (*impd_cal_point_cb_t)(uint8_t idx, uint32_t ref_mohm, int32_t reading, void *user_data);
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported variable prototypes ----------------------------------------------*/
+
+/* Exported function prototypes ----------------------------------------------*/
+void impd_cal_init(impd_cal_point_cb_t on_point, void *user_data);
+int impd_cal_start(uint16_t blocks, uint8_t fit, uint8_t degree);
+int impd_cal_add_point(uint32_t ref_mohm);
+void impd_cal_feed(int32_t reading);
+int impd_cal_finish(uint8_t save);
+void impd_cal_abort(void);
+uint8_t impd_cal_get_state(void);
+const impd_cal_table_t *impd_cal_get_table(void);
+int impd_cal_convert(int32_t reading, int32_t *mohm);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __IMPD_CAL_H__ */
@@ -0,0 +1,191 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : impd_event.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 阻抗事件检测：上下限、回差、最短驻留时间、变化率
+  * @attention   : 越限须连续保持 dwell_ms 才进入越限状态，回到 限值 ± 回差 以内
+  *                立即退出；变化率按相邻两个读数计算，同一方向持续超限时
+  *                每 dwell_ms 最多上报一次。
+  *                可选的读数中值滤波能滤掉单个读数的脉冲干扰，但阶跃要晚 median/2 个读数
+  *                才被看到，短于 median/2 + 1 个读数的偏离不会触发，变化率也被削平，默认关闭
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.xxx
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "impd_event.h"
+#include <string.h>
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+#define STATE_NORMAL                    (0)
+#define STATE_HIGH                      (1)
+#define STATE_LOW                       (2)
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Exported variables  -------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+static void event_fire(impd_event_det_t *det, uint8_t type, int32_t value, int32_t rate, uint32_t tick);
+static void event_level(impd_event_det_t *det, uint32_t tick, int32_t value, int32_t rate);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+ * @brief  初始化检测器，默认不使能任何检测
+ */
+void impd_event_init(impd_event_det_t *det, impd_event_cb_t on_event, void *user_data)
+{
+    memset(det, 0, sizeof(*det));
+    det->on_event = on_event;
+    det->user_data = user_data;
+}
+
+/**
+ * @brief  设置检测参数，同时复位检测状态
+ * @retval 0 成功，-EINVAL 参数错误
+ */
+int impd_event_config(impd_event_det_t *det, const impd_event_cfg_t *cfg)
+{
+    if (cfg->hyst < 0)
+        return -EINVAL;
+    if ((cfg->enable & IMPD_EVENT_EN_RATE) && cfg->rate_max <= 0)
+        return -EINVAL;
+    if ((cfg->enable & IMPD_EVENT_EN_HIGH) && (cfg->enable & IMPD_EVENT_EN_LOW) &&
+        cfg->high <= cfg->low)
+        return -EINVAL;
+    if (cfg->median > IMPD_EVENT_MEDIAN_MAX)
+        return -EINVAL;
+    
+    det->cfg = *cfg;
+    if (cfg->median > 1)
+        median_filter_init(&det->med, det->med_data, det->med_pos, det->med_heap, cfg->median);
+    impd_event_reset(det);
+    
+    return 0;
+}
+
+/**
+ * @brief  复位检测状态 (如测量通路或激励改变后)，保留参数
+ */
+void impd_event_reset(impd_event_det_t *det)
+{
+    det->state = STATE_NORMAL;
+    det->armed = STATE_NORMAL;
+    det->has_last = 0;
+    det->rate_fired = 0;
+    if (det->cfg.median > 1)
+        median_filter_reset(&det->med);
+}
+
+/**
+ * @brief  输入一个读数
+ * @param  tick  读数时刻 (ms)
+ * @param  value 读数，开启中值滤波时限幅到 0~65535 (幅值读数)
+ */
+void impd_event_update(impd_event_det_t *det, uint32_t tick, int32_t value)
+{
+    int32_t rate = 0;
+    uint32_t dt;
+    
+    if (det->cfg.median > 1) {
+        if (value < 0)
+            value = 0;
+        else if (value > 0xFFFF)
+            value = 0xFFFF;
+        value = median_filter_insert(&det->med, (uint16_t)value);
+    }
+    
+    if (det->has_last) {
+        dt = tick - det->last_tick;
+        if (dt > 0)
+            rate = (int32_t)(((int64_t)value - det->last_value) * 1000 / (int64_t)dt);
+    }
+    
+    if ((det->cfg.enable & IMPD_EVENT_EN_RATE) && det->has_last &&
+        (rate > det->cfg.rate_max || rate < -det->cfg.rate_max) &&
+        (!det->rate_fired || tick - det->rate_tick >= det->cfg.dwell_ms)) {
+        det->rate_fired = 1;
+        det->rate_tick = tick;
+        event_fire(det, IMPD_EVENT_RATE, value, rate, tick);
+    }
+    
+    event_level(det, tick, value, rate);
+    
+    det->has_last = 1;
+    det->last_value = value;
+    det->last_tick = tick;
+}
+
+/* Private functions ---------------------------------------------------------*/
+static void event_fire(impd_event_det_t *det, uint8_t type, int32_t value, int32_t rate, uint32_t tick)
+{
+    impd_event_t evt;
+    
+    if (!det->on_event)
+        return;
+    
+    evt.type = type;
+    evt.value = value;
+    evt.rate = rate;
+    evt.tick = tick;
+    det->on_event(&evt, det->user_data);
+}
+
+/**
+ * @brief  上下限状态机
+ */
+static void event_level(impd_event_det_t *det, uint32_t tick, int32_t value, int32_t rate)
+{
+    const impd_event_cfg_t *cfg = &det->cfg;
+    uint8_t over = STATE_NORMAL;
+    
+    switch (det->state) {
+        case STATE_HIGH:
+            if (!(cfg->enable & IMPD_EVENT_EN_HIGH)) {
+                det->state = STATE_NORMAL;
+            } else if ((int64_t)value < (int64_t)cfg->high - cfg->hyst) {
+                det->state = STATE_NORMAL;
+                event_fire(det, IMPD_EVENT_LEAVE_HIGH, value, rate, tick);
+            }
+            break;
+        case STATE_LOW:
+            if (!(cfg->enable & IMPD_EVENT_EN_LOW)) {
+                det->state = STATE_NORMAL;
+            } else if ((int64_t)value > (int64_t)cfg->low + cfg->hyst) {
+                det->state = STATE_NORMAL;
+                event_fire(det, IMPD_EVENT_LEAVE_LOW, value, rate, tick);
+            }
+            break;
+        default:
+            if ((cfg->enable & IMPD_EVENT_EN_HIGH) && value > cfg->high)
+                over = STATE_HIGH;
+            else if ((cfg->enable & IMPD_EVENT_EN_LOW) && value < cfg->low)
+                over = STATE_LOW;
+            
+            if (over == STATE_NORMAL) {
+                det->armed = STATE_NORMAL;
+                break;
+            }
+            if (det->armed != over) {
+                det->armed = over;
+                det->arm_tick = tick;
+            }
+            if (tick - det->arm_tick >= cfg->dwell_ms) {
+                det->state = over;
+                det->armed = STATE_NORMAL;
+                event_fire(det, over == STATE_HIGH ? IMPD_EVENT_ENTER_HIGH : IMPD_EVENT_ENTER_LOW,
+                           value, rate, tick);
+            }
+            break;
+    }
+}
+
+/******************************* End Of File ************************************/
@@ -0,0 +1,96 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : impd_event.h
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 阻抗事件检测：上下限、回差、最短驻留时间、变化率
+  * @attention   : 每个读数调用一次 impd_event_update，事件通过回调立即通知
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.xxx
+  ******************************************************************************
+  */
+#ifndef __IMPD_EVENT_H__
+#define __IMPD_EVENT_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sys_def.h"
+#include "median_filter.h"
+
+/* Exported define -----------------------------------------------------------*/
+#define IMPD_EVENT_EN_HIGH              (1U << 0)   /**< 使能上限检测 */
+#define IMPD_EVENT_EN_LOW               (1U << 1)   /**< 使能下限检测 */
+#define IMPD_EVENT_EN_RATE              (1U << 2)   /**< 使能变化率检测 */
+
+#define IMPD_EVENT_MEDIAN_MAX           (7)         /**< 读数中值窗口上限 */
+
+/* Exported typedef ----------------------------------------------------------*/
+enum impd_event_type {
+    IMPD_EVENT_ENTER_HIGH = 1,      /**< 超过上限并持续驻留时间 */
+    IMPD_EVENT_LEAVE_HIGH,          /**< 回落到 上限 - 回差 以下 */
+    IMPD_EVENT_ENTER_LOW,           /**< 低于下限并持续驻留时间 */
+    IMPD_EVENT_LEAVE_LOW,           /**< 回升到 下限 + 回差 以上 */
+    IMPD_EVENT_RATE,                /**< 变化率超限 */
+};
+
+typedef struct
+{
+    uint8_t  enable;        /**< IMPD_EVENT_EN_xxx 组合 */
+    int32_t  high;          /**< 上限 */
+    int32_t  low;           /**< 下限 */
+    int32_t  hyst;          /**< 回差，>= 0 */
+    uint16_t dwell_ms;      /**< 越限须持续的时间，变化率事件的最小间隔 */
+    int32_t  rate_max;      /**< 变化率上限 (读数单位/秒)，> 0 */
+    uint8_t  median;        /**< 读数中值窗口 (个)，0/1 不滤波 (默认)，不超过 IMPD_EVENT_MEDIAN_MAX */
+} impd_event_cfg_t;
+
+typedef struct
+{
+    uint8_t  type;          /**< enum impd_event_type */
+    int32_t  value;         /**< 触发时的读数 */
+    int32_t  rate;          /**< 触发时的变化率 (读数单位/秒) */
+    uint32_t tick;          /**< 触发时刻 (ms) */
+} impd_event_t;
+
+typedef void (*impd_event_cb_t)(const impd_event_t *evt, void *user_data);
+
+typedef struct
+{
+    impd_event_cfg_t cfg;
+    uint8_t  state;         /**< 0 正常，1 高于上限，2 低于下限 */
+    uint8_t  armed;         /**< 越限计时中 (0 无，1 上限，2 下限) */
+    uint8_t  has_last;      /**< 是否已有上一个读数 */
+    int32_t  last_value;
+    uint32_t last_tick;
+    uint32_t arm_tick;      /**< 开始越限的时刻 */
+    uint32_t rate_tick;     /**< 上一次变化率事件时刻 */
+    uint8_t  rate_fired;    /**< 是否触发过变化率事件 */
+    median_filter_t med;    /**< cfg.median > 1 时使用 */
+    uint16_t med_data[IMPD_EVENT_MEDIAN_MAX];
+    int16_t  med_pos[IMPD_EVENT_MEDIAN_MAX];
+    int16_t  med_heap[IMPD_EVENT_MEDIAN_MAX];
+    impd_event_cb_t on_event;
+    void *user_data;
+} impd_event_det_t;
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported variable prototypes ----------------------------------------------*/
+
+/* Exported function prototypes ----------------------------------------------*/
+void impd_event_init(impd_event_det_t *det, impd_event_cb_t on_event, void *user_data);
+int impd_event_config(impd_event_det_t *det, const impd_event_cfg_t *cfg);
+void impd_event_reset(impd_event_det_t *det);
+void impd_event_update(impd_event_det_t *det, uint32_t tick, int32_t value);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __IMPD_EVENT_H__ */
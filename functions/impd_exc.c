@@ -0,0 +1,398 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : impd_exc.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 阻抗激励源：DAC + 定时器触发循环 DMA 的 DDS 正弦发生器
+  * @attention   : TIM6 更新事件触发 DAC 通道2，DMA2 通道4 循环搬运乒乓缓冲区。
+  *                每传输完半个缓冲区，在 DMA 中断中用相位累加器重新生成该半区；
+  *                若一个数据块恰好包含整数个周期 (频率为 采样率/块长 的整数倍)，
+  *                两个半区内容固定，稳态下不再占用 CPU。
+  *                每个生成的块按块号记录起始相位和增量 (最近 IMPD_EXC_REC_NUM 块)，
+  *                结合 DMA 计数和 TIM6 计数可求出任意时刻正在输出的相位，
+  *                供 ADC 把检测相位换算为相对激励的相位。
+  *                每次设置参数分配一个代号，记录中带有参数生效的块号，
+  *                使用者据此判断新参数从哪个时刻开始输出
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.xxx
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "impd_exc.h"
+#include "board.h"
+#include "dsp_math.h"
+#include "prof.h"
+
+#define  LOG_TAG             "impd_exc"
+#define  LOG_LVL             4
+#include "log.h"
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+    uint32_t phase;                     /* 块首样本相位 */
+    uint32_t inc;
+    uint32_t gen;                       /* 参数代号 */
+    uint32_t start;                     /* 该代号参数的首块块号 */
+} exc_rec_t;
+
+/* Private define ------------------------------------------------------------*/
+#define IMPD_EXC_TIM_CLK                (1000000UL) /* 触发定时器计数频率，与 ADC 触发同源 */
+#define IMPD_EXC_DAC_MID                (2048)
+#define IMPD_EXC_REC_NUM                (4)         /* 块记录数，2 的幂，覆盖正在输出和已生成的块 */
+#define IMPD_EXC_DAC_LAG                (2)         /* 第 q 次触发后 DAC 输出第 q - 2 个样本 */
+#define IMPD_EXC_AGE_BLK_MAX            (0xFFFF)    /* 代号时长的计数上限 (块) */
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static DAC_HandleTypeDef hdac_exc;
+static DMA_HandleTypeDef hdma_exc;
+static TIM_HandleTypeDef htim_exc;
+
+static uint16_t exc_dma_buf[IMPD_EXC_BLOCK_LEN * 2];
+
+static uint32_t exc_phase;              /* 相位累加器 */
+static uint32_t exc_inc;                /* 当前相位增量 */
+static uint16_t exc_amp;                /* 当前幅值 */
+static uint8_t  exc_periodic;           /* 一个块恰好包含整数个周期 */
+static uint8_t  exc_static;             /* 两个半区均已是稳态内容 */
+static volatile uint32_t exc_freq;
+static volatile uint32_t exc_pending_inc;
+static volatile uint16_t exc_pending_amp;
+static volatile uint8_t  exc_pending_periodic;
+static volatile uint8_t  exc_pending;   /* 有待生效的参数 */
+static volatile uint32_t exc_gen_req;   /* 最近一次设置的参数代号 */
+static uint32_t exc_gen;                /* 当前生成的参数代号 */
+static uint32_t exc_gen_start;          /* 当前代号的首块块号 */
+static uint8_t  exc_fill_count;         /* 参数生效后已重新生成的半区数 */
+static uint8_t  exc_running;
+static exc_rec_t exc_rec[IMPD_EXC_REC_NUM];
+static volatile uint32_t exc_blk;       /* 已传输完的块数，DMA 中断中递增 */
+
+/* Exported variables  -------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+static void exc_fill_block(uint16_t *block);
+static void exc_record(uint32_t blk);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+ * @brief  初始化 DAC、DMA 和触发定时器
+ * @retval 0 成功，负值失败
+ */
+int impd_exc_init(void)
+{
+    GPIO_InitTypeDef gpio = {0};
+    DAC_ChannelConfTypeDef ch = {0};
+    TIM_MasterConfigTypeDef master = {0};
+    
+    __HAL_RCC_GPIOA_CLK_ENABLE();
+    __HAL_RCC_DAC_CLK_ENABLE();
+    __HAL_RCC_DMA2_CLK_ENABLE();
+    __HAL_RCC_TIM6_CLK_ENABLE();
+    
+    gpio.Pin = IMPD_EXC_DAC_Pin;
+    gpio.Mode = GPIO_MODE_ANALOG;
+    HAL_GPIO_Init(IMPD_EXC_DAC_GPIO_Port, &gpio);
+    
+    hdma_exc.Instance = DMA2_Channel4;
+    hdma_exc.Init.Direction = DMA_MEMORY_TO_PERIPH;
+    hdma_exc.Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma_exc.Init.MemInc = DMA_MINC_ENABLE;
+    hdma_exc.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+    hdma_exc.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+    hdma_exc.Init.Mode = DMA_CIRCULAR;
+    hdma_exc.Init.Priority = DMA_PRIORITY_HIGH;
+    if (HAL_DMA_Init(&hdma_exc) != HAL_OK)
+        return -EIO;
+    __HAL_LINKDMA(&hdac_exc, DMA_Handle2, hdma_exc);
+    
+    hdac_exc.Instance = DAC;
+    if (HAL_DAC_Init(&hdac_exc) != HAL_OK)
+        return -EIO;
+    
+    ch.DAC_Trigger = DAC_TRIGGER_T6_TRGO;
+    ch.DAC_OutputBuffer = DAC_OUTPUTBUFFER_ENABLE;
+    if (HAL_DAC_ConfigChannel(&hdac_exc, &ch, IMPD_EXC_DAC_CHANNEL) != HAL_OK)
+        return -EIO;
+    
+    htim_exc.Instance = TIM6;
+    htim_exc.Init.Prescaler = SystemCoreClock / IMPD_EXC_TIM_CLK - 1;
+    htim_exc.Init.CounterMode = TIM_COUNTERMODE_UP;
+    htim_exc.Init.Period = IMPD_EXC_TIM_CLK / IMPD_EXC_SAMPLE_RATE - 1;
+    htim_exc.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_ENABLE;
+    if (HAL_TIM_Base_Init(&htim_exc) != HAL_OK)
+        return -EIO;
+    
+    master.MasterOutputTrigger = TIM_TRGO_UPDATE;
+    master.MasterSlaveMode = TIM_MASTERSLAVEMODE_DISABLE;
+    if (HAL_TIMEx_MasterConfigSynchronization(&htim_exc, &master) != HAL_OK)
+        return -EIO;
+    
+    HAL_NVIC_SetPriority(DMA2_Channel4_5_IRQn, 1, 0);
+    HAL_NVIC_EnableIRQ(DMA2_Channel4_5_IRQn);
+    
+    exc_phase = 0;
+    exc_inc = 0;
+    exc_periodic = 1;
+    exc_freq = 0;
+    exc_amp = IMPD_EXC_AMP_DEFAULT;
+    exc_pending = 0;
+    exc_running = 0;
+    
+    return 0;
+}
+
+/**
+ * @brief  启动输出，从相位 0 开始
+ * @retval 0 成功，负值失败
+ */
+int impd_exc_start(void)
+{
+    if (exc_running)
+        return 0;
+    
+    /* 启动前直接应用挂起的参数并预填两个半区 */
+    if (exc_pending) {
+        exc_inc = exc_pending_inc;
+        exc_amp = exc_pending_amp;
+        exc_periodic = exc_pending_periodic;
+        exc_pending = 0;
+    }
+    exc_gen = exc_gen_req;
+    exc_gen_start = 0;
+    exc_phase = 0;
+    exc_fill_count = 0;
+    exc_static = 0;
+    exc_blk = 0;
+    exc_record(0);
+    exc_fill_block(&exc_dma_buf[0]);
+    exc_record(1);
+    exc_fill_block(&exc_dma_buf[IMPD_EXC_BLOCK_LEN]);
+    
+    if (HAL_DAC_Start_DMA(&hdac_exc, IMPD_EXC_DAC_CHANNEL, (uint32_t*)exc_dma_buf,
+                          IMPD_EXC_BLOCK_LEN * 2, DAC_ALIGN_12B_R) != HAL_OK) {
+        LOG_E("Failed to start DAC DMA\r\n");
+        return -EIO;
+    }
+    
+    __HAL_TIM_SET_COUNTER(&htim_exc, 0);
+    HAL_TIM_Base_Start(&htim_exc);
+    exc_running = 1;
+    
+    return 0;
+}
+
+/**
+ * @brief  停止输出，DAC 保持在中点
+ */
+void impd_exc_stop(void)
+{
+    if (!exc_running)
+        return;
+    
+    HAL_TIM_Base_Stop(&htim_exc);
+    HAL_DAC_Stop_DMA(&hdac_exc, IMPD_EXC_DAC_CHANNEL);
+    HAL_DAC_SetValue(&hdac_exc, IMPD_EXC_DAC_CHANNEL, DAC_ALIGN_12B_R, IMPD_EXC_DAC_MID);
+    exc_running = 0;
+}
+
+/**
+ * @brief  设置激励频率，在下一个数据块边界生效
+ * @param  freq 频率 (Hz)，0 表示输出直流中点
+ * @retval 0 成功，-EINVAL 超出奈奎斯特频率
+ * @note   freq 不是 IMPD_EXC_STATIC_STEP 的整数倍时，每个块都要在 DMA 中断中重新生成，
+ *         持续占用约 4% CPU；长期输出的激励应尽量选用其整数倍
+ */
+int impd_exc_set_freq(uint32_t freq)
+{
+    if (freq >= IMPD_EXC_SAMPLE_RATE / 2)
+        return -EINVAL;
+    
+    __disable_irq();
+    exc_pending_inc = DSP_PHASE_INC(freq, IMPD_EXC_SAMPLE_RATE);
+    exc_pending_periodic = (freq % IMPD_EXC_STATIC_STEP) == 0;
+    if (!exc_pending)
+        exc_pending_amp = exc_amp;
+    exc_pending = 1;
+    exc_gen_req++;
+    exc_freq = freq;
+    __enable_irq();
+    
+    return 0;
+}
+
+/**
+ * @brief  设置激励幅值，在下一个数据块边界生效
+ * @param  amp 峰值 (DAC 码值)
+ * @retval 0 成功，-EINVAL 超出范围
+ */
+int impd_exc_set_amp(uint16_t amp)
+{
+    if (amp > IMPD_EXC_AMP_MAX)
+        return -EINVAL;
+    
+    __disable_irq();
+    if (!exc_pending) {
+        exc_pending_inc = exc_inc;
+        exc_pending_periodic = exc_periodic;
+    }
+    exc_pending_amp = amp;
+    exc_pending = 1;
+    exc_gen_req++;
+    __enable_irq();
+    
+    return 0;
+}
+
+uint32_t impd_exc_get_freq(void)
+{
+    return exc_freq;
+}
+
+/**
+ * @brief  读取最近一次设置的幅值，尚未生效时返回待生效的值
+ */
+uint16_t impd_exc_get_amp(void)
+{
+    return exc_pending ? exc_pending_amp : exc_amp;
+}
+
+/**
+ * @brief  读取最近一次设置的参数代号，快照中的代号达到该值后新参数开始输出
+ */
+uint32_t impd_exc_get_gen(void)
+{
+    return exc_gen_req;
+}
+
+/**
+ * @brief  读取当前时刻的激励相位
+ * @param  snap 输出
+ * @retval 0 成功，-ENODEV 未启动，-EAGAIN 尚未输出第一个样本
+ * @note   须在关中断时调用，并与调用者读取自己的定时器尽量靠近。
+ *         计数器刚更新时 DMA 可能尚未搬运，等计数离开 0 再读
+ */
+int impd_exc_snapshot(impd_exc_snap_t *snap)
+{
+    const exc_rec_t *r;
+    uint32_t cnt, left, t, blk, idx;
+    
+    if (!exc_running)
+        return -ENODEV;
+    
+    do {
+        while ((cnt = __HAL_TIM_GET_COUNTER(&htim_exc)) == 0)
+            ;
+        left = __HAL_DMA_GET_COUNTER(&hdma_exc);
+    } while (cnt != __HAL_TIM_GET_COUNTER(&htim_exc));
+    
+    /* 当前正在传输的半区与已处理的块数奇偶不符，说明有一个半区完成中断尚未处理 */
+    t = (IMPD_EXC_BLOCK_LEN * 2 - left) % (IMPD_EXC_BLOCK_LEN * 2);
+    blk = exc_blk;
+    if ((t >= IMPD_EXC_BLOCK_LEN) != (blk & 1U))
+        blk++;
+    idx = t % IMPD_EXC_BLOCK_LEN;
+    
+    if (idx < IMPD_EXC_DAC_LAG) {
+        if (blk == 0)
+            return -EAGAIN;
+        blk--;
+        idx += IMPD_EXC_BLOCK_LEN;
+    }
+    idx -= IMPD_EXC_DAC_LAG;
+    
+    r = &exc_rec[blk & (IMPD_EXC_REC_NUM - 1)];
+    snap->inc = r->inc;
+    snap->phase = r->phase + idx * r->inc + IMPD_EXC_US_PHASE(r->inc, cnt);
+    snap->gen = r->gen;
+    blk -= r->start;
+    if (blk > IMPD_EXC_AGE_BLK_MAX)
+        blk = IMPD_EXC_AGE_BLK_MAX;
+    snap->gen_us = (blk * IMPD_EXC_BLOCK_LEN + idx) * IMPD_EXC_SAMPLE_US + cnt;
+    
+    return 0;
+}
+
+/**
+ * @brief  DMA2 通道4/5 中断：重新生成刚播放完的半区
+ */
+void DMA2_Channel4_5_IRQHandler(void)
+{
+    uint32_t ht = __HAL_DMA_GET_HT_FLAG_INDEX(&hdma_exc);
+    uint32_t tc = __HAL_DMA_GET_TC_FLAG_INDEX(&hdma_exc);
+    uint16_t *block = NULL;
+    
+    if (__HAL_DMA_GET_FLAG(&hdma_exc, ht)) {
+        __HAL_DMA_CLEAR_FLAG(&hdma_exc, ht);
+        block = &exc_dma_buf[0];
+    } else if (__HAL_DMA_GET_FLAG(&hdma_exc, tc)) {
+        __HAL_DMA_CLEAR_FLAG(&hdma_exc, tc);
+        block = &exc_dma_buf[IMPD_EXC_BLOCK_LEN];
+    } else {
+        __HAL_DMA_CLEAR_FLAG(&hdma_exc, __HAL_DMA_GET_GI_FLAG_INDEX(&hdma_exc));
+        return;
+    }
+    
+    if (exc_pending) {
+        exc_inc = exc_pending_inc;
+        exc_amp = exc_pending_amp;
+        exc_periodic = exc_pending_periodic;
+        exc_pending = 0;
+        exc_fill_count = 0;
+        exc_static = 0;
+        exc_gen = exc_gen_req;
+        exc_gen_start = exc_blk + 2;
+    }
+    
+    /* 刚传输完的半区重新生成为之后第二个块 */
+    exc_record(exc_blk + 2);
+    if (!exc_static)
+        exc_fill_block(block);
+    exc_blk++;
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  记录块号为 blk 的块的起始相位和增量，在生成该块之前调用
+ */
+static void exc_record(uint32_t blk)
+{
+    exc_rec_t *r = &exc_rec[blk & (IMPD_EXC_REC_NUM - 1)];
+    
+    r->phase = exc_phase;
+    r->inc = exc_inc;
+    r->gen = exc_gen;
+    r->start = exc_gen_start;
+}
+
+/**
+ * @brief  用相位累加器生成一个数据块
+ * @note   块内为整数个周期时，每块都从同一起始相位生成，两个半区内容相同，
+ *         生成两次后即可停止刷新，且不会因相位增量的截断误差而漂移
+ */
+static void exc_fill_block(uint16_t *block)
+{
+    uint32_t phase = exc_phase;
+    uint32_t inc = exc_inc;
+    int32_t  amp = exc_amp;
+    uint16_t i;
+    PROF_BEGIN(PROF_EXC_FILL);
+    
+    for (i = 0; i < IMPD_EXC_BLOCK_LEN; i++) {
+        block[i] = (uint16_t)(IMPD_EXC_DAC_MID + ((dsp_sin_q15(phase) * amp) >> 15));
+        phase += inc;
+    }
+    
+    if (!exc_periodic)
+        exc_phase = phase;
+    else if (++exc_fill_count >= 2)
+        exc_static = 1;
+    PROF_END(PROF_EXC_FILL);
+}
+
+/******************************* End Of File ************************************/
@@ -0,0 +1,71 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : impd_exc.h
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 阻抗激励源：DAC + 定时器触发循环 DMA 的 DDS 正弦发生器
+  * @attention   : 频率和幅值修改在下一个数据块边界生效，相位连续。
+  *                频率为 IMPD_EXC_STATIC_STEP 的整数倍时缓冲区内容固定，稳态不占 CPU；
+  *                其他频率每个块 (2.5ms) 在 DMA 中断中逐样本查表生成一次，
+  *                Cortex-M3 每样本约 30 个周期，72MHz 下约占 4% CPU (见测量点 PROF_EXC_FILL)
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.xxx
+  ******************************************************************************
+  */
+#ifndef __IMPD_EXC_H__
+#define __IMPD_EXC_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sys_def.h"
+
+/* Exported define -----------------------------------------------------------*/
+#define IMPD_EXC_SAMPLE_RATE            (100000)    /**< DAC 更新率 (Hz) */
+#define IMPD_EXC_BLOCK_LEN              (250)       /**< 每块样本数 (半个 DMA 缓冲区) */
+#define IMPD_EXC_AMP_MAX                (2047)      /**< 最大幅值 (DAC 码值) */
+#define IMPD_EXC_AMP_DEFAULT            (1000)
+#define IMPD_EXC_SAMPLE_US              (1000000 / IMPD_EXC_SAMPLE_RATE)
+#define IMPD_EXC_STATIC_STEP            (IMPD_EXC_SAMPLE_RATE / IMPD_EXC_BLOCK_LEN) /**< 400Hz，块内整数个周期 */
+
+/* Exported typedef ----------------------------------------------------------*/
+/**
+ * @brief 激励输出的瞬时状态
+ * @note  相位为 DAC 当前输出样本按时间线性插值到读取时刻的值，以正弦为参考；
+ *        DAC 保持、输出缓冲和外部电路的延迟不在其中，表现为固定的相位偏移
+ */
+typedef struct
+{
+    uint32_t phase;         /**< 读取时刻的激励相位 */
+    uint32_t inc;           /**< 每个 DAC 样本的相位增量 */
+    uint32_t gen;           /**< 正在输出的参数代号，见 impd_exc_get_gen() */
+    uint32_t gen_us;        /**< 该代号参数开始输出至今的时间 (us)，上限约 160s */
+} impd_exc_snap_t;
+
+/* Exported macro ------------------------------------------------------------*/
+/** 相位增量为 inc 时 us 微秒内的相位变化 */
+#define IMPD_EXC_US_PHASE(inc, us)      ((uint32_t)(((uint64_t)(inc) * (us)) / IMPD_EXC_SAMPLE_US))
+
+/* Exported variable prototypes ----------------------------------------------*/
+
+/* Exported function prototypes ----------------------------------------------*/
+int impd_exc_init(void);
+int impd_exc_start(void);
+void impd_exc_stop(void);
+int impd_exc_set_freq(uint32_t freq);
+int impd_exc_set_amp(uint16_t amp);
+uint32_t impd_exc_get_freq(void);
+uint16_t impd_exc_get_amp(void);
+uint32_t impd_exc_get_gen(void);
+int impd_exc_snapshot(impd_exc_snap_t *snap);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __IMPD_EXC_H__ */
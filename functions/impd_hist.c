@@ -0,0 +1,224 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : impd_hist.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 阻抗读数历史环形缓冲区及窗口统计
+  * @attention   : 样本按写入序号 seq 编址，seq & (IMPD_HIST_LEN - 1) 为环内下标。
+  *                自复位以来的统计 (Welford/EMA) 由 run_stats 维护，不受环长度限制
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.xxx
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "impd_hist.h"
+
+#define  LOG_TAG             "impd_hist"
+#define  LOG_LVL             4
+#include "log.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+#define HIST_MASK                       (IMPD_HIST_LEN - 1)
+
+#if (IMPD_HIST_LEN & HIST_MASK) != 0
+#error "IMPD_HIST_LEN must be a power of two"
+#endif
+
+/* Private macro -------------------------------------------------------------*/
+#define HIST_VAL(seq)       (hist_buf[(seq) & HIST_MASK].value)
+
+/* Private variables ---------------------------------------------------------*/
+static impd_hist_sample_t hist_buf[IMPD_HIST_LEN];
+static int64_t  hist_s1[IMPD_HIST_LEN];     /* 该样本之前所有样本之和 */
+static uint64_t hist_s2[IMPD_HIST_LEN];     /* 该样本之前所有样本的平方和 (按 2^64 回绕) */
+static int64_t  hist_tot_s1;
+static uint64_t hist_tot_s2;
+static uint32_t hist_seq;                   /* 复位以来写入的样本数 */
+
+/* 单调队列，保存窗口内样本的 seq：min 队列值递增，max 队列值递减 */
+static uint32_t hist_min_q[IMPD_HIST_LEN];
+static uint32_t hist_max_q[IMPD_HIST_LEN];
+static uint32_t hist_min_head, hist_min_tail;
+static uint32_t hist_max_head, hist_max_tail;
+
+static run_stats_t hist_stats;
+
+/* Exported variables  -------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t queue_find(const uint32_t *q, uint32_t head, uint32_t tail, uint32_t first);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+ * @brief  初始化历史缓冲区
+ * @param  ema_alpha EMA 系数，非法时使用 IMPD_HIST_EMA_ALPHA_DEFAULT
+ */
+void impd_hist_init(float ema_alpha)
+{
+    if (run_stats_init(&hist_stats, ema_alpha) != 0)
+        run_stats_init(&hist_stats, IMPD_HIST_EMA_ALPHA_DEFAULT);
+    
+    impd_hist_reset();
+}
+
+/**
+ * @brief  清空历史和统计
+ */
+void impd_hist_reset(void)
+{
+    hist_seq = 0;
+    hist_tot_s1 = 0;
+    hist_tot_s2 = 0;
+    hist_min_head = hist_min_tail = 0;
+    hist_max_head = hist_max_tail = 0;
+    run_stats_reset(&hist_stats);
+}
+
+/**
+ * @brief  写入一个读数，环满时覆盖最旧样本
+ * @param  tick  时间戳 (ms)
+ * @param  value 读数，绝对值小于 IMPD_HIST_VALUE_MAX
+ * @retval 0 成功，-EINVAL 读数越界
+ */
+int impd_hist_push(uint32_t tick, int32_t value)
+{
+    uint32_t idx = hist_seq & HIST_MASK;
+    
+    if (value >= IMPD_HIST_VALUE_MAX || value <= -IMPD_HIST_VALUE_MAX)
+        return -EINVAL;
+    
+    /* 淘汰即将被覆盖的样本 */
+    if (hist_min_head != hist_min_tail && hist_seq - hist_min_q[hist_min_head & HIST_MASK] >= IMPD_HIST_LEN)
+        hist_min_head++;
+    if (hist_max_head != hist_max_tail && hist_seq - hist_max_q[hist_max_head & HIST_MASK] >= IMPD_HIST_LEN)
+        hist_max_head++;
+    
+    while (hist_min_tail != hist_min_head && HIST_VAL(hist_min_q[(hist_min_tail - 1) & HIST_MASK]) >= value)
+        hist_min_tail--;
+    while (hist_max_tail != hist_max_head && HIST_VAL(hist_max_q[(hist_max_tail - 1) & HIST_MASK]) <= value)
+        hist_max_tail--;
+    
+    hist_buf[idx].tick = tick;
+    hist_buf[idx].value = value;
+    hist_s1[idx] = hist_tot_s1;
+    hist_s2[idx] = hist_tot_s2;
+    hist_tot_s1 += value;
+    hist_tot_s2 += (uint64_t)((int64_t)value * value);
+    
+    hist_min_q[hist_min_tail++ & HIST_MASK] = hist_seq;
+    hist_max_q[hist_max_tail++ & HIST_MASK] = hist_seq;
+    hist_seq++;
+    
+    run_stats_update(&hist_stats, value);
+    
+    return 0;
+}
+
+/**
+ * @brief  环内样本数
+ */
+uint16_t impd_hist_count(void)
+{
+    return (hist_seq < IMPD_HIST_LEN) ? (uint16_t)hist_seq : IMPD_HIST_LEN;
+}
+
+/**
+ * @brief  自复位以来的统计 (不受环长度限制)
+ */
+const run_stats_t *impd_hist_get_stats(void)
+{
+    return &hist_stats;
+}
+
+/**
+ * @brief  最近 k 个样本的统计
+ * @param  k   窗口长度，0 或超过环内样本数时取全部样本
+ * @param  sum 输出
+ * @note   S1 = q*k + r (0 <= r < k)，则 S2 - S1^2/k = S2 - q*(S1 + r) - r^2/k，
+ *         整数部分精确计算，避免 S1^2 溢出
+ */
+void impd_hist_window(uint16_t k, impd_hist_summary_t *sum)
+{
+    uint16_t n = impd_hist_count();
+    uint32_t first;
+    int64_t s1, q, r;
+    int64_t m2;
+    
+    if (k == 0 || k > n)
+        k = n;
+    
+    sum->count = k;
+    if (k == 0) {
+        sum->min = 0;
+        sum->max = 0;
+        sum->mean = 0.0f;
+        sum->var = 0.0f;
+        return;
+    }
+    
+    first = hist_seq - k;
+    s1 = hist_tot_s1 - hist_s1[first & HIST_MASK];
+    
+    q = s1 / k;
+    r = s1 % k;
+    if (r < 0) {
+        q -= 1;
+        r += k;
+    }
+    m2 = (int64_t)(hist_tot_s2 - hist_s2[first & HIST_MASK]) - q * (s1 + r);
+    
+    sum->mean = (float)s1 / (float)k;
+    sum->var = (k > 1) ? ((float)m2 - (float)(r * r) / (float)k) / (float)(k - 1) : 0.0f;
+    if (sum->var < 0.0f)
+        sum->var = 0.0f;
+    
+    sum->min = HIST_VAL(hist_min_q[queue_find(hist_min_q, hist_min_head, hist_min_tail, first) & HIST_MASK]);
+    sum->max = HIST_VAL(hist_max_q[queue_find(hist_max_q, hist_max_head, hist_max_tail, first) & HIST_MASK]);
+}
+
+/**
+ * @brief  读取最近 n 个原始样本，按时间由旧到新排列
+ * @retval 实际读取的样本数
+ */
+uint16_t impd_hist_tail(impd_hist_sample_t *out, uint16_t n)
+{
+    uint16_t count = impd_hist_count();
+    uint32_t seq;
+    uint16_t i;
+    
+    if (n > count)
+        n = count;
+    
+    seq = hist_seq - n;
+    for (i = 0; i < n; i++, seq++)
+        out[i] = hist_buf[seq & HIST_MASK];
+    
+    return n;
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  在单调队列中二分查找第一个 seq >= first 的位置
+ * @note   队列中 seq 严格递增，且最后一个元素为最新样本，查找必然成功
+ */
+static uint32_t queue_find(const uint32_t *q, uint32_t head, uint32_t tail, uint32_t first)
+{
+    uint32_t lo = 0, hi = tail - head - 1, mid;
+    
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if ((int32_t)(q[(head + mid) & HIST_MASK] - first) >= 0)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    
+    return head + lo;
+}
+
+/******************************* End Of File ************************************/
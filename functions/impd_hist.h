@@ -0,0 +1,65 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : impd_hist.h
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 阻抗读数历史环形缓冲区及窗口统计
+  * @attention   : 每个样本记录入环前的累加和，任意最近 k 个样本的均值/方差
+  *                O(1) 求得；最小/最大值由单调队列维护，查询 O(log n)
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.xxx
+  ******************************************************************************
+  */
+#ifndef __IMPD_HIST_H__
+#define __IMPD_HIST_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sys_def.h"
+#include "run_stats.h"
+
+/* Exported define -----------------------------------------------------------*/
+#define IMPD_HIST_LEN                   (128)           /**< 历史长度，必须为 2 的幂，每个样本占 32 字节 RAM */
+#define IMPD_HIST_VALUE_MAX             (1L << 24)      /**< 读数绝对值上限，保证平方和不溢出 */
+#define IMPD_HIST_EMA_ALPHA_DEFAULT     (0.125f)
+
+/* Exported typedef ----------------------------------------------------------*/
+typedef struct
+{
+    uint32_t tick;          /**< 时间戳 (ms) */
+    int32_t  value;         /**< 读数 */
+} impd_hist_sample_t;
+
+typedef struct
+{
+    uint16_t count;         /**< 窗口样本数，0 表示无数据 */
+    int32_t  min;           /**< 最小值 */
+    int32_t  max;           /**< 最大值 */
+    float    mean;          /**< 均值 */
+    float    var;           /**< 样本方差 */
+} impd_hist_summary_t;
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported variable prototypes ----------------------------------------------*/
+
+/* Exported function prototypes ----------------------------------------------*/
+void impd_hist_init(float ema_alpha);
+void impd_hist_reset(void);
+int impd_hist_push(uint32_t tick, int32_t value);
+uint16_t impd_hist_count(void);
+const run_stats_t *impd_hist_get_stats(void);
+void impd_hist_window(uint16_t k, impd_hist_summary_t *sum);
+uint16_t impd_hist_tail(impd_hist_sample_t *out, uint16_t n);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __IMPD_HIST_H__ */
@@ -0,0 +1,157 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : impd_relay.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 测量通路继电器调度
+  * @attention   : 切换只在刚取走一个 ADC 块之后执行，此时 DMA 正在填充另一半缓冲区，
+  *                该块必然混有切换前后的样本，连同建立时间内的块一起丢弃。
+  *                执行切换的这一块虽然完整，但切换回调已清空测量窗口，也不再使用，
+  *                切换后的第一个窗口只含建立时间之后的样本。主机无需在继电器命令后再额外等待
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.xxx
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "impd_relay.h"
+#include "impd_adc.h"
+#include "board.h"
+
+#define  LOG_TAG             "impd_relay"
+#define  LOG_LVL             4
+#include "log.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static impd_relay_status_t relay;
+static uint16_t relay_settle_ms = IMPD_RELAY_SETTLE_MS_DEFAULT;
+static uint16_t relay_blank;            /* 剩余需丢弃的块数 */
+static impd_relay_switch_cb_t relay_on_switch;
+static void *relay_user_data;
+
+/* Exported variables  -------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+static void relay_apply(void);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+ * @brief  初始化继电器 GPIO，上电为断开状态
+ * @param  on_switch 继电器实际动作后的回调，可为 NULL
+ */
+void impd_relay_init(impd_relay_switch_cb_t on_switch, void *user_data)
+{
+    GPIO_InitTypeDef gpio = {0};
+    
+    __HAL_RCC_GPIOA_CLK_ENABLE();
+    
+    HAL_GPIO_WritePin(IMPD_RELAY_GPIO_Port, IMPD_RELAY_Pin, GPIO_PIN_RESET);
+    gpio.Pin = IMPD_RELAY_Pin;
+    gpio.Mode = GPIO_MODE_OUTPUT_PP;
+    gpio.Pull = GPIO_NOPULL;
+    gpio.Speed = GPIO_SPEED_FREQ_LOW;
+    HAL_GPIO_Init(IMPD_RELAY_GPIO_Port, &gpio);
+    
+    relay.state = IMPD_RELAY_OFF;
+    relay.pending = 0;
+    relay.target = IMPD_RELAY_OFF;
+    relay.blanking = 0;
+    relay.switch_tick = HAL_GetTick();
+    relay.switch_count = 0;
+    relay_blank = 0;
+    relay_on_switch = on_switch;
+    relay_user_data = user_data;
+}
+
+/**
+ * @brief  请求切换继电器，在下一个 ADC 块边界执行
+ * @note   连续请求以最后一次为准；目标与当前状态相同时取消排队的切换
+ * @retval 0 成功，-EINVAL 状态非法
+ */
+int impd_relay_request(uint8_t state)
+{
+    if (state != IMPD_RELAY_OFF && state != IMPD_RELAY_ON)
+        return -EINVAL;
+    
+    relay.target = state;
+    relay.pending = (state != relay.state);
+    
+    return 0;
+}
+
+/**
+ * @brief  设置建立及抖动时间，对之后的切换生效
+ */
+int impd_relay_set_settle(uint16_t settle_ms)
+{
+    if (settle_ms > IMPD_RELAY_SETTLE_MS_MAX)
+        return -EINVAL;
+    
+    relay_settle_ms = settle_ms;
+    
+    return 0;
+}
+
+void impd_relay_get_status(impd_relay_status_t *st)
+{
+    *st = relay;
+}
+
+/**
+ * @brief  每取到一个 ADC 块调用一次，判断该块是否可用于测量
+ * @param  hold 非零时暂缓执行排队的切换 (如扫频进行中)
+ * @retval 1 块有效，0 块处于丢弃期或本次执行了切换
+ * @note   当前块在切换前已采集完成，但属于切换前的通路，而回调刚清空了测量窗口，
+ *         若仍返回 1 会成为新窗口的第一段，因此同样丢弃
+ */
+uint8_t impd_relay_block_ready(uint8_t hold)
+{
+    uint8_t ready = 1;
+    
+    if (relay_blank > 0) {
+        relay_blank--;
+        ready = 0;
+    }
+    
+    if (relay.pending && !hold) {
+        relay_apply();
+        ready = 0;
+    }
+    
+    relay.blanking = (relay_blank > 0);
+    
+    return ready;
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  执行切换并计算丢弃块数：正在采集的块 + 覆盖建立时间所需的块
+ */
+static void relay_apply(void)
+{
+    uint32_t settle = (uint32_t)relay_settle_ms * impd_adc_get_sample_rate() / 1000;
+    
+    HAL_GPIO_WritePin(IMPD_RELAY_GPIO_Port, IMPD_RELAY_Pin,
+                      relay.target ? GPIO_PIN_SET : GPIO_PIN_RESET);
+    
+    relay.state = relay.target;
+    relay.pending = 0;
+    relay.switch_tick = HAL_GetTick();
+    relay.switch_count++;
+    relay_blank = 1 + (settle + IMPD_ADC_BLOCK_LEN - 1) / IMPD_ADC_BLOCK_LEN;
+    
+    LOG_D("relay -> %d, blank %d blocks\r\n", relay.state, relay_blank);
+    
+    if (relay_on_switch)
+        relay_on_switch(relay.state, relay.switch_tick, relay_user_data);
+}
+
+/******************************* End Of File ************************************/
@@ -0,0 +1,64 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : impd_relay.h
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 测量通路继电器调度
+  * @attention   : 切换请求先排队，在 ADC 块边界执行；切换后丢弃正在采集的块
+  *                及建立/抖动时间覆盖的块，从下一个干净块恢复测量
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.xxx
+  ******************************************************************************
+  */
+#ifndef __IMPD_RELAY_H__
+#define __IMPD_RELAY_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sys_def.h"
+
+/* Exported define -----------------------------------------------------------*/
+#define IMPD_RELAY_SETTLE_MS_DEFAULT    (20)        /**< 默认建立及触点抖动时间 */
+#define IMPD_RELAY_SETTLE_MS_MAX        (1000)
+
+#define IMPD_RELAY_OFF                  (0)
+#define IMPD_RELAY_ON                   (1)
+
+/* Exported typedef ----------------------------------------------------------*/
+/**
+ * @brief 继电器已切换回调，tick 为切换时刻 (ms)
+ */
+typedef void (*impd_relay_switch_cb_t)(uint8_t state, uint32_t tick, void *user_data);
+
+typedef struct
+{
+    uint8_t  state;         /**< 当前继电器状态 */
+    uint8_t  pending;       /**< 是否有排队的切换 */
+    uint8_t  target;        /**< 排队切换的目标状态 */
+    uint8_t  blanking;      /**< 是否处于丢弃期 */
+    uint32_t switch_tick;   /**< 最近一次切换时刻 (ms) */
+    uint32_t switch_count;  /**< 切换次数 */
+} impd_relay_status_t;
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported variable prototypes ----------------------------------------------*/
+
+/* Exported function prototypes ----------------------------------------------*/
+void impd_relay_init(impd_relay_switch_cb_t on_switch, void *user_data);
+int impd_relay_request(uint8_t state);
+int impd_relay_set_settle(uint16_t settle_ms);
+void impd_relay_get_status(impd_relay_status_t *st);
+uint8_t impd_relay_block_ready(uint8_t hold);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __IMPD_RELAY_H__ */
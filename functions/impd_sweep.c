@@ -0,0 +1,242 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : impd_sweep.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 多频点阻抗扫频调度
+  * @attention   : 由主循环按 ADC 数据块驱动，所有时间以样本数计，
+  *                与采样时钟严格同步。激励在下一个 DAC 数据块边界才切换频率，
+  *                建立时间从数据块参考指出的新频率首个样本开始计算，
+  *                此前的样本全部丢弃，建立时间为 0 时窗口紧接在切换点之后
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.xxx
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "impd_sweep.h"
+#include "goertzel.h"
+#include "dsp_math.h"
+#include "board.h"
+
+#define  LOG_TAG             "impd_sweep"
+#define  LOG_LVL             4
+#include "log.h"
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+    impd_sweep_set_freq_t set_freq;     /* 激励源 */
+    void *exc_arg;
+    impd_sweep_done_t on_done;          /* 完成回调 */
+    void *user_data;
+    
+    goertzel_t g;                       /* 单频点检测器 */
+    impd_sweep_point_t pts[IMPD_SWEEP_POINT_MAX];
+    uint8_t  count;                     /* 频点数 */
+    uint8_t  step;                      /* 当前频点 */
+    uint8_t  busy;
+    uint32_t sample_rate;
+    uint32_t settle_len;                /* 建立时间 (样本) */
+    uint32_t settle_remain;             /* 当前频点剩余建立样本 */
+    uint32_t gen;                       /* 当前频点的激励参数代号 */
+    uint8_t  wait_gen;                  /* 等待激励切换到当前频点 */
+    uint32_t step_tick;                 /* 当前频点开始时刻 (ms) */
+    uint32_t step_timeout;              /* 每个频点的时限 (ms) */
+} impd_sweep_t;
+
+/* Private define ------------------------------------------------------------*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static impd_sweep_t sweep;
+
+/* Exported variables  -------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+static int  sweep_enter_step(uint8_t step);
+static void sweep_on_window(const goertzel_result_t *res, uint8_t nbins, void *user_data);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+ * @brief  初始化扫频调度
+ * @param  on_done   扫频完成回调
+ * @param  user_data 传递给回调函数的用户数据
+ */
+void impd_sweep_init(impd_sweep_done_t on_done, void *user_data)
+{
+    sweep.on_done = on_done;
+    sweep.user_data = user_data;
+    sweep.busy = 0;
+}
+
+/**
+ * @brief  注册激励源
+ */
+void impd_sweep_set_exciter(impd_sweep_set_freq_t set_freq, void *arg)
+{
+    sweep.set_freq = set_freq;
+    sweep.exc_arg = arg;
+}
+
+/**
+ * @brief  启动扫频
+ * @param  freq        频率列表 (Hz)
+ * @param  n           频点数，不超过 IMPD_SWEEP_POINT_MAX
+ * @param  settle_ms   每次切换频率后的建立时间
+ * @param  win_len     每个频点的采集窗口 (样本)
+ * @param  sample_rate ADC 采样率
+ * @retval 0 成功，-EBUSY 正在扫频，-ENODEV 无激励源，-EINVAL 参数错误
+ */
+int impd_sweep_start(const uint32_t *freq, uint8_t n, uint16_t settle_ms,
+                     uint16_t win_len, uint32_t sample_rate)
+{
+    uint8_t i;
+    
+    if (sweep.busy)
+        return -EBUSY;
+    if (!sweep.set_freq)
+        return -ENODEV;
+    if (!freq || n == 0 || n > IMPD_SWEEP_POINT_MAX || sample_rate == 0)
+        return -EINVAL;
+    
+    for (i = 0; i < n; i++) {
+        if (freq[i] == 0 || freq[i] >= sample_rate / 2)
+            return -EINVAL;
+        sweep.pts[i].freq = freq[i];
+        sweep.pts[i].mag_q31 = 0;
+        sweep.pts[i].phase = 0;
+    }
+    
+    if (goertzel_init(&sweep.g, win_len) != 0)
+        return -EINVAL;
+    sweep.g.on_result = sweep_on_window;
+    sweep.g.user_data = &sweep;
+    
+    sweep.count = n;
+    sweep.sample_rate = sample_rate;
+    sweep.settle_len = (uint32_t)settle_ms * sample_rate / 1000;
+    sweep.step_timeout = settle_ms + (uint32_t)win_len * 1000 / sample_rate + IMPD_SWEEP_STEP_MARGIN_MS;
+    
+    if (sweep_enter_step(0) != 0)
+        return -EIO;
+    
+    sweep.busy = 1;
+    LOG_D("Sweep start: %d points\r\n", n);
+    
+    return 0;
+}
+
+/**
+ * @brief  中止扫频，不上报结果
+ */
+void impd_sweep_abort(void)
+{
+    sweep.busy = 0;
+}
+
+uint8_t impd_sweep_busy(void)
+{
+    return sweep.busy;
+}
+
+/**
+ * @brief  检查当前频点是否超时，超时则结束扫频并上报已完成的频点
+ * @note   由主循环周期调用，与 ADC 数据块无关，采集停止时也能结束
+ */
+void impd_sweep_poll(void)
+{
+    if (!sweep.busy || HAL_GetTick() - sweep.step_tick < sweep.step_timeout)
+        return;
+    
+    LOG_W("Sweep timeout at %u Hz\r\n", sweep.pts[sweep.step].freq);
+    sweep.busy = 0;
+    if (sweep.on_done)
+        sweep.on_done(sweep.pts, sweep.step, sweep.user_data);
+}
+
+/**
+ * @brief  处理一个 ADC 数据块
+ * @param  samples ADC 样本
+ * @param  n       样本数
+ * @param  ref     数据块的激励参考，NULL 表示不等待激励切换，相位不做参考
+ */
+void impd_sweep_process(const uint16_t *samples, size_t n, const impd_adc_ref_t *ref)
+{
+    size_t chunk, pos = 0;
+    
+    if (sweep.busy && sweep.wait_gen && ref) {
+        /* 新频率尚未输出，或在块末才开始输出 */
+        if ((int32_t)(ref->exc_gen - sweep.gen) < 0 || ref->exc_from >= n)
+            return;
+        pos = ref->exc_from;
+    }
+    sweep.wait_gen = 0;
+    
+    while (sweep.busy && pos < n) {
+        if (sweep.settle_remain) {
+            /* 建立时间内的样本直接丢弃 */
+            chunk = (n - pos < sweep.settle_remain) ? n - pos : sweep.settle_remain;
+            sweep.settle_remain -= chunk;
+        } else {
+            /* 只送到窗口结束为止，后续样本属于下一频点 */
+            chunk = (n - pos < sweep.g.remain) ? n - pos : sweep.g.remain;
+            if (ref)
+                goertzel_set_ref(&sweep.g, ref->exc_phase + ref->exc_inc * pos, ref->exc_inc);
+            goertzel_process(&sweep.g, &samples[pos], chunk);
+            /* 窗口结束已进入下一频点，块内剩余样本属于旧频率 */
+            if (sweep.wait_gen)
+                return;
+        }
+        pos += chunk;
+    }
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  切换到指定频点：设置激励、检测频率并开始建立计时
+ */
+static int sweep_enter_step(uint8_t step)
+{
+    uint32_t inc = DSP_PHASE_INC(sweep.pts[step].freq, sweep.sample_rate);
+    int ret;
+    
+    ret = sweep.set_freq(sweep.pts[step].freq, &sweep.gen, sweep.exc_arg);
+    if (ret != 0) {
+        LOG_E("Failed to set excitation %u Hz: %d\r\n", sweep.pts[step].freq, ret);
+        return ret;
+    }
+    
+    goertzel_config(&sweep.g, &inc, 1);
+    sweep.step = step;
+    sweep.settle_remain = sweep.settle_len;
+    sweep.wait_gen = 1;
+    sweep.step_tick = HAL_GetTick();
+    
+    return 0;
+}
+
+/**
+ * @brief  一个频点的窗口结束：记录结果并立即进入下一频点
+ */
+static void sweep_on_window(const goertzel_result_t *res, uint8_t nbins, void *user_data)
+{
+    impd_sweep_t *sw = (impd_sweep_t*)user_data;
+    
+    sw->pts[sw->step].mag_q31 = res[0].mag_q31;
+    sw->pts[sw->step].phase = res[0].phase;
+    
+    if (sw->step + 1 < sw->count) {
+        if (sweep_enter_step(sw->step + 1) == 0)
+            return;
+    }
+    
+    sw->busy = 0;
+    if (sw->on_done)
+        sw->on_done(sw->pts, sw->step + 1, sw->user_data);
+}
+
+/******************************* End Of File ************************************/
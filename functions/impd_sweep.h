@@ -0,0 +1,72 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : impd_sweep.h
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 多频点阻抗扫频调度
+  * @attention   : 每个频点：切换激励 -> 丢弃建立时间内的样本 -> 采集一个窗口；
+  *                窗口结束时立即切换到下一频点，上一频点的收尾计算与
+  *                下一频点的建立时间重叠。
+  *                每个频点限时 (建立时间 + 窗口 + IMPD_SWEEP_STEP_MARGIN_MS)，由 impd_sweep_poll
+  *                检查，激励或采集停止时扫频超时结束，不会一直占用继电器和激励
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.xxx
+  ******************************************************************************
+  */
+#ifndef __IMPD_SWEEP_H__
+#define __IMPD_SWEEP_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sys_def.h"
+#include "impd_adc.h"
+
+/* Exported define -----------------------------------------------------------*/
+#define IMPD_SWEEP_POINT_MAX            (12)        /**< 单次扫频最大频点数 */
+#define IMPD_SWEEP_STEP_MARGIN_MS       (500)       /**< 每个频点在建立时间和窗口之外的余量 */
+
+/* Exported typedef ----------------------------------------------------------*/
+typedef struct
+{
+    uint32_t freq;          /**< 频率 (Hz) */
+    uint32_t mag_q31;       /**< 幅值，Q31 满量程 */
+    int32_t  phase;         /**< 相对激励的相位，Q31 格式的 π 倍数 */
+} impd_sweep_point_t;
+
+/**
+ * @brief 激励源频率设置函数，返回 0 表示成功
+ * @note  gen 输出新频率的参数代号，数据块参考中的 exc_gen 达到该值后新频率开始输出
+ */
+typedef int (*impd_sweep_set_freq_t)(uint32_t freq, uint32_t *gen, void *arg);
+
+/**
+ * @brief 扫频完成回调
+ * @note  n 小于启动时的频点数表示扫频因激励失败或超时提前结束，只有前 n 个频点有效
+ */
+typedef void (*impd_sweep_done_t)(const impd_sweep_point_t *pts, uint8_t n, void *user_data);
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported variable prototypes ----------------------------------------------*/
+
+/* Exported function prototypes ----------------------------------------------*/
+void impd_sweep_init(impd_sweep_done_t on_done, void *user_data);
+void impd_sweep_set_exciter(impd_sweep_set_freq_t set_freq, void *arg);
+int impd_sweep_start(const uint32_t *freq, uint8_t n, uint16_t settle_ms,
+                     uint16_t win_len, uint32_t sample_rate);
+void impd_sweep_abort(void);
+uint8_t impd_sweep_busy(void);
+void impd_sweep_poll(void);
+void impd_sweep_process(const uint16_t *samples, size_t n, const impd_adc_ref_t *ref);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __IMPD_SWEEP_H__ */
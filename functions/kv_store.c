@@ -0,0 +1,374 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : kv_store.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : flash 日志结构键值存储
+  * @attention   : 页格式：[页头 8B：魔术码、序号][记录][记录]...[0xFF...]
+  *                记录格式：[提交标记 2B][CRC 2B][键 1B][标志 1B][长度 2B][数据，4 字节对齐]
+  *                写记录时先写除提交标记外的全部内容，最后写提交标记；
+  *                压缩时先在新页写入全部记录，最后写页头。任何时刻掉电，
+  *                上电扫描时未提交的记录和无页头的页都会被忽略
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.xxx
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "kv_store.h"
+#include "mtd_core.h"
+#include "crc.h"
+#include <string.h>
+
+#define  LOG_TAG             "kv_store"
+#define  LOG_LVL             4
+#include "log.h"
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+    uint16_t commit;
+    uint16_t crc;                       /* 键、标志、长度和数据的 CRC16 */
+    uint8_t  key;
+    uint8_t  flags;
+    uint16_t len;
+} kv_rec_hdr_t;
+
+typedef struct
+{
+    uint32_t magic;
+    uint32_t seq;
+} kv_page_hdr_t;
+
+/* Private define ------------------------------------------------------------*/
+#define KV_PAGE_MAGIC                   (0x5047564BUL)  /* "KVPG" */
+#define KV_COMMIT                       (0xA55A)
+#define KV_FLAG_LIVE                    (0x01)          /* 清 0 表示删除记录，其余位保留为 1 */
+
+/* Private macro -------------------------------------------------------------*/
+#define KV_ALIGN(len)                   (((len) + 3U) & ~3U)
+#define KV_REC_SIZE(len)                (sizeof(kv_rec_hdr_t) + KV_ALIGN(len))
+#define KV_PAGE_ADDR(kv, page)          ((kv)->base + (uint32_t)(page) * (kv)->page_size)
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t kv_buf[sizeof(kv_rec_hdr_t) + KV_VALUE_MAX];    /* 记录组装/校验缓冲区 */
+
+/* Exported variables  -------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+static int kv_read(kv_store_t *kv, uint32_t addr, void *buf, size_t len);
+static int kv_write(kv_store_t *kv, uint32_t addr, const void *buf, size_t len);
+static int kv_erase_page(kv_store_t *kv, uint8_t page);
+static int kv_read_record(kv_store_t *kv, uint8_t page, uint32_t off, kv_rec_hdr_t *hdr);
+static int kv_append(kv_store_t *kv, uint8_t key, uint8_t flags, const void *data, uint16_t len);
+static void kv_scan(kv_store_t *kv);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+ * @brief  挂载存储区：找到序号最大的有效页并建立索引，没有有效页时格式化
+ * @param  mtd       flash 设备
+ * @param  base      起始偏移，页对齐
+ * @param  page_size 页大小
+ * @param  page_cnt  页数，2 ~ KV_PAGE_MAX
+ * @retval 0 成功，负值失败
+ */
+int kv_init(kv_store_t *kv, struct mtd_info *mtd, uint32_t base, uint32_t page_size, uint8_t page_cnt)
+{
+    kv_page_hdr_t ph;
+    uint8_t found = 0;
+    uint8_t i;
+    int ret;
+    
+    if (!kv || !mtd || page_cnt < 2 || page_cnt > KV_PAGE_MAX ||
+        page_size > 0xFFFF || page_size < sizeof(kv_page_hdr_t) + KV_REC_SIZE(KV_VALUE_MAX))
+        return -EINVAL;
+    
+    memset(kv, 0, sizeof(*kv));
+    kv->mtd = mtd;
+    kv->base = base;
+    kv->page_size = page_size;
+    kv->page_cnt = page_cnt;
+    
+    for (i = 0; i < page_cnt; i++) {
+        if (kv_read(kv, KV_PAGE_ADDR(kv, i), &ph, sizeof(ph)) != 0 || ph.magic != KV_PAGE_MAGIC)
+            continue;
+        if (!found || (int32_t)(ph.seq - kv->seq) > 0) {
+            kv->active = i;
+            kv->seq = ph.seq;
+            found = 1;
+        }
+    }
+    
+    if (!found) {
+        ret = kv_erase_page(kv, 0);
+        if (ret != 0)
+            return ret;
+        ph.magic = KV_PAGE_MAGIC;
+        ph.seq = 1;
+        ret = kv_write(kv, KV_PAGE_ADDR(kv, 0), &ph, sizeof(ph));
+        if (ret != 0)
+            return ret;
+        kv->active = 0;
+        kv->seq = 1;
+        LOG_D("kv formatted\r\n");
+    }
+    
+    kv_scan(kv);
+    
+    return 0;
+}
+
+/**
+ * @brief  读取键值
+ * @param  buf  输出缓冲区
+ * @param  size 缓冲区大小，数据超出部分被截断
+ * @retval 数据长度，-ENOENT 不存在，其他负值为读取错误
+ */
+int kv_get(kv_store_t *kv, uint8_t key, void *buf, uint16_t size)
+{
+    kv_rec_hdr_t hdr;
+    uint32_t off;
+    int ret;
+    
+    if (key >= KV_KEY_MAX)
+        return -EINVAL;
+    
+    off = kv->index[key];
+    if (off == 0)
+        return -ENOENT;
+    
+    ret = kv_read(kv, KV_PAGE_ADDR(kv, kv->active) + off, &hdr, sizeof(hdr));
+    if (ret != 0)
+        return ret;
+    
+    ret = kv_read(kv, KV_PAGE_ADDR(kv, kv->active) + off + sizeof(hdr), buf,
+                  (hdr.len < size) ? hdr.len : size);
+    if (ret != 0)
+        return ret;
+    
+    return hdr.len;
+}
+
+/**
+ * @brief  写入键值，与当前值相同时不写 flash
+ * @retval 0 成功，-ENOSPC 压缩后仍放不下，其他负值为 flash 错误
+ */
+int kv_set(kv_store_t *kv, uint8_t key, const void *data, uint16_t len)
+{
+    kv_rec_hdr_t hdr;
+    uint32_t off;
+    
+    if (key >= KV_KEY_MAX || len > KV_VALUE_MAX || (len && !data))
+        return -EINVAL;
+    
+    off = kv->index[key];
+    if (off != 0 &&
+        kv_read(kv, KV_PAGE_ADDR(kv, kv->active) + off, &hdr, sizeof(hdr)) == 0 && hdr.len == len &&
+        kv_read(kv, KV_PAGE_ADDR(kv, kv->active) + off + sizeof(hdr), kv_buf, len) == 0 &&
+        memcmp(kv_buf, data, len) == 0)
+        return 0;
+    
+    return kv_append(kv, key, 0xFF, data, len);
+}
+
+/**
+ * @brief  删除键，写入一条删除记录
+ */
+int kv_del(kv_store_t *kv, uint8_t key)
+{
+    if (key >= KV_KEY_MAX)
+        return -EINVAL;
+    if (kv->index[key] == 0)
+        return 0;
+    
+    return kv_append(kv, key, (uint8_t)~KV_FLAG_LIVE, NULL, 0);
+}
+
+/**
+ * @brief  把各键的最新记录搬到下一页，新页写完后才写页头使其生效
+ * @retval 0 成功，负值失败 (原页保持有效)
+ */
+int kv_compact(kv_store_t *kv)
+{
+    uint16_t index[KV_KEY_MAX];
+    kv_page_hdr_t ph;
+    kv_rec_hdr_t hdr;
+    uint8_t target = (kv->active + 1) % kv->page_cnt;
+    uint32_t dst = sizeof(kv_page_hdr_t);
+    uint32_t size;
+    uint8_t key;
+    int ret;
+    
+    ret = kv_erase_page(kv, target);
+    if (ret != 0)
+        return ret;
+    
+    memset(index, 0, sizeof(index));
+    for (key = 0; key < KV_KEY_MAX; key++) {
+        if (kv->index[key] == 0)
+            continue;
+        ret = kv_read(kv, KV_PAGE_ADDR(kv, kv->active) + kv->index[key], &hdr, sizeof(hdr));
+        if (ret != 0)
+            return ret;
+        size = KV_REC_SIZE(hdr.len);
+        ret = kv_read(kv, KV_PAGE_ADDR(kv, kv->active) + kv->index[key], kv_buf, size);
+        if (ret == 0)
+            ret = kv_write(kv, KV_PAGE_ADDR(kv, target) + dst, kv_buf, size);
+        if (ret != 0)
+            return ret;
+        index[key] = (uint16_t)dst;
+        dst += size;
+    }
+    
+    ph.magic = KV_PAGE_MAGIC;
+    ph.seq = kv->seq + 1;
+    ret = kv_write(kv, KV_PAGE_ADDR(kv, target), &ph, sizeof(ph));
+    if (ret != 0)
+        return ret;
+    
+    kv->active = target;
+    kv->seq = ph.seq;
+    kv->write_off = dst;
+    memcpy(kv->index, index, sizeof(index));
+    
+    LOG_D("kv compacted to page %d, seq %d\r\n", target, kv->seq);
+    
+    return 0;
+}
+
+/* Private functions ---------------------------------------------------------*/
+static int kv_read(kv_store_t *kv, uint32_t addr, void *buf, size_t len)
+{
+    size_t retlen = 0;
+    int ret;
+    
+    ret = mtd_read(kv->mtd, addr, len, &retlen, (uint8_t*)buf);
+    if (ret != 0 || retlen != len)
+        return -EIO;
+    
+    return 0;
+}
+
+static int kv_write(kv_store_t *kv, uint32_t addr, const void *buf, size_t len)
+{
+    size_t retlen = 0;
+    int ret;
+    
+    ret = mtd_write(kv->mtd, addr, len, &retlen, (const uint8_t*)buf);
+    if (ret != 0 || retlen != len)
+        return -EIO;
+    
+    return 0;
+}
+
+static int kv_erase_page(kv_store_t *kv, uint8_t page)
+{
+    struct erase_info info;
+    
+    info.addr = KV_PAGE_ADDR(kv, page);
+    info.len = kv->page_size;
+    kv->erase_count++;
+    
+    return mtd_erase(kv->mtd, &info);
+}
+
+/**
+ * @brief  读取并校验一条记录，数据留在 kv_buf 中
+ * @retval 0 有效，-EAGAIN 未提交或校验失败，-ENOENT 空白区，其他为读取错误
+ */
+static int kv_read_record(kv_store_t *kv, uint8_t page, uint32_t off, kv_rec_hdr_t *hdr)
+{
+    int ret;
+    
+    ret = kv_read(kv, KV_PAGE_ADDR(kv, page) + off, hdr, sizeof(*hdr));
+    if (ret != 0)
+        return ret;
+    
+    if (hdr->commit == 0xFFFF && hdr->crc == 0xFFFF && hdr->key == 0xFF && hdr->len == 0xFFFF)
+        return -ENOENT;
+    if (hdr->len > KV_VALUE_MAX || off + KV_REC_SIZE(hdr->len) > kv->page_size)
+        return -EINVAL;
+    
+    ret = kv_read(kv, KV_PAGE_ADDR(kv, page) + off, kv_buf, sizeof(*hdr) + hdr->len);
+    if (ret != 0)
+        return ret;
+    
+    if (hdr->commit != KV_COMMIT || hdr->key >= KV_KEY_MAX ||
+        hdr->crc != crc16_modbus(&kv_buf[4], 4 + hdr->len))
+        return -EAGAIN;
+    
+    return 0;
+}
+
+/**
+ * @brief  追加一条记录，空间不足时先压缩
+ */
+static int kv_append(kv_store_t *kv, uint8_t key, uint8_t flags, const void *data, uint16_t len)
+{
+    kv_rec_hdr_t *hdr = (kv_rec_hdr_t*)kv_buf;
+    uint32_t size = KV_REC_SIZE(len);
+    uint32_t addr;
+    uint16_t commit = KV_COMMIT;
+    int ret;
+    
+    if (kv->write_off + size > kv->page_size) {
+        ret = kv_compact(kv);
+        if (ret != 0)
+            return ret;
+        if (kv->write_off + size > kv->page_size)
+            return -ENOSPC;
+    }
+    
+    memset(kv_buf, 0xFF, size);
+    hdr->key = key;
+    hdr->flags = flags;
+    hdr->len = len;
+    if (len)
+        memcpy(&kv_buf[sizeof(*hdr)], data, len);
+    hdr->crc = crc16_modbus(&kv_buf[4], 4 + len);
+    
+    /* 先写提交标记以外的部分，再写提交标记 */
+    addr = KV_PAGE_ADDR(kv, kv->active) + kv->write_off;
+    ret = kv_write(kv, addr + 2, &kv_buf[2], size - 2);
+    if (ret == 0)
+        ret = kv_write(kv, addr, &commit, sizeof(commit));
+    
+    /* 失败时旧记录仍然有效，索引不变；但该区域已被编程，不能再用 */
+    if (ret == 0)
+        kv->index[key] = (flags & KV_FLAG_LIVE) ? (uint16_t)kv->write_off : 0;
+    kv->write_off += size;
+    
+    return ret;
+}
+
+/**
+ * @brief  扫描当前页，建立索引并定位写入位置
+ * @note   长度损坏的记录无法跳过，此后的空间视为已用，下次写入时触发压缩
+ */
+static void kv_scan(kv_store_t *kv)
+{
+    kv_rec_hdr_t hdr;
+    uint32_t off = sizeof(kv_page_hdr_t);
+    int ret;
+    
+    memset(kv->index, 0, sizeof(kv->index));
+    
+    while (off + sizeof(kv_rec_hdr_t) <= kv->page_size) {
+        ret = kv_read_record(kv, kv->active, off, &hdr);
+        if (ret == -ENOENT)
+            break;
+        if (ret == -EINVAL || (ret != 0 && ret != -EAGAIN)) {
+            off = kv->page_size;
+            break;
+        }
+        if (ret == 0)
+            kv->index[hdr.key] = (hdr.flags & KV_FLAG_LIVE) ? (uint16_t)off : 0;
+        off += KV_REC_SIZE(hdr.len);
+    }
+    
+    kv->write_off = off;
+}
+
+/******************************* End Of File ************************************/
@@ -0,0 +1,62 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : kv_store.h
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : flash 日志结构键值存储
+  * @attention   : 两个及以上 flash 页轮流使用，记录只追加不改写；
+  *                当前页写满时把各键的最新记录搬到下一页 (压缩)，才擦除一次
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.xxx
+  ******************************************************************************
+  */
+#ifndef __KV_STORE_H__
+#define __KV_STORE_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sys_def.h"
+
+/* Exported define -----------------------------------------------------------*/
+#define KV_KEY_MAX                      (16)        /**< 键取值 0 ~ KV_KEY_MAX-1 */
+#define KV_VALUE_MAX                    (128)       /**< 单条记录最大数据长度 */
+#define KV_PAGE_MAX                     (8)
+
+/* Exported typedef ----------------------------------------------------------*/
+struct mtd_info;
+
+typedef struct
+{
+    struct mtd_info *mtd;
+    uint32_t base;                      /**< 在 mtd 中的起始偏移，页对齐 */
+    uint32_t page_size;                 /**< 页大小 (擦除单位) */
+    uint8_t  page_cnt;                  /**< 页数，>= 2 */
+    uint8_t  active;                    /**< 当前写入页 */
+    uint32_t seq;                       /**< 当前页序号，每次压缩加 1 */
+    uint32_t write_off;                 /**< 当前页下一条记录的页内偏移 */
+    uint16_t index[KV_KEY_MAX];         /**< 各键最新记录的页内偏移，0 表示不存在 */
+    uint32_t erase_count;               /**< 本次上电以来的擦除次数 */
+} kv_store_t;
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported variable prototypes ----------------------------------------------*/
+
+/* Exported function prototypes ----------------------------------------------*/
+int kv_init(kv_store_t *kv, struct mtd_info *mtd, uint32_t base, uint32_t page_size, uint8_t page_cnt);
+int kv_get(kv_store_t *kv, uint8_t key, void *buf, uint16_t size);
+int kv_set(kv_store_t *kv, uint8_t key, const void *data, uint16_t len);
+int kv_del(kv_store_t *kv, uint8_t key);
+int kv_compact(kv_store_t *kv);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __KV_STORE_H__ */
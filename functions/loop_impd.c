@@ -22,16 +22,50 @@
 #include "loop_impd.h"
 #include "operate_loop.h"
 #include "data_mgmt.h"
+#include "impd_adc.h"
+#include "goertzel.h"
+#include "lockin.h"
+#include "impd_sweep.h"
+#include "impd_exc.h"
+#include "impd_hist.h"
+#include "impd_relay.h"
+#include "impd_event.h"
+#include "impd_cal.h"
+#include "attach_impd.h"
+#include "app.h"
+#include "iap.h"
+#include "board.h"
+#include "dsp_math.h"
+#include "prof.h"
+#include "safety.h"
+#include "pt.h"
 
 #define  LOG_TAG             "loop_impd"
 #define  LOG_LVL             4
 #include "log.h"
+#include "dlog.h"
 
 #include <string.h>
 /*------------------------------ Macro definition -----------------------------*/
+#define LOOP_IMPD_GOERTZEL_WIN      (IMPD_ADC_BLOCK_LEN * 4)  /* 100ms@10kHz，工频整周期 */
+#define LOOP_IMPD_LOCKIN_PERIOD_MAX (200)   /* 锁相解调的最长激励周期 (样本)，50Hz@10kHz */
+#define LOOP_IMPD_HIST_HDR_LEN      (43)
+#define LOOP_IMPD_HIST_TAIL_MAX     ((LOOP_TX_BUF_LEN - LOOP_IMPD_HIST_HDR_LEN) / 8)
+#define LOOP_IMPD_CO_TIMEOUT_MS     (3000)  /* 建立时间最长 1s + 一个测量窗口，留出余量 */
 
 
 /*------------------------------ typedef definition ---------------------------*/
+/* 需要等待的命令处理写成协程，等待期间其余命令和通信照常处理 */
+typedef PT_THREAD((*loop_impd_co_t)(struct pt *pt, const uint8_t *data, uint16_t len));
+
+typedef struct
+{
+    struct pt pt;
+    loop_impd_co_t fn;          /* NULL 表示空闲 */
+    loop_msg_t msg;             /* 命令参数副本，原消息出队后即被覆盖 */
+    uint32_t tick;              /* 开始时刻，用于超时 */
+    uint32_t mark;              /* 跨让出点保存的数据 */
+} loop_impd_co_slot_t;
 
 
 /*------------------------------ variables prototypes -------------------------*/
@@ -39,28 +73,275 @@ float RsOhm[2];
 
 static loop_impd_info_t loop_impd_info;
 
-static uint8_t cal_state = 0;  /* 校准状态 */
+static goertzel_t loop_goertzel;
+static goertzel_t loop_event_goertzel;     /* 单块窗口，供事件检测使用 */
+static lockin_t loop_lockin;                /* 激励可锁相时代替 loop_goertzel 产生历史读数 */
+static int16_t  loop_lockin_ref[LOCKIN_REF_LEN(LOOP_IMPD_LOCKIN_PERIOD_MAX)];
+static uint8_t  loop_lockin_on;
+static uint8_t  loop_lockin_align;          /* 等待按激励相位对齐参考下标 */
+static uint32_t loop_lockin_gen;            /* 锁相所跟随的激励参数代号 */
+static impd_event_det_t loop_event;
+static uint32_t loop_sweep_freq;            /* 扫频前的激励，扫频结束或中止后恢复 */
+static uint16_t loop_sweep_amp;
+static loop_impd_co_slot_t loop_co;    /* 同一时刻只运行一个协程 */
 
-int impd_ad[150] = {
-    138,238,338,436,537,635,733,830,927,1024,1119,1213,1308,1401,1494,
-    1586,1677,1769,1858,1948,2038,2127,2215,2301,2388,2474,2559,2644,
-    2728,2813,2900
-};
+/*------------------------------ function prototypes --------------------------*/
+static uint16_t get_le16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
 
-float impd_slope[150] = {
-    0.003369, 0.002905, 0.002751, 0.002661, 0.002622, 0.002584, 0.002557,
-    0.002533 ,0.002515 ,0.002500 ,0.002484 ,0.002468 ,0.002456 ,0.002443 ,
-    0.002432 ,0.002420 ,0.002408 ,0.002399 ,0.002387 ,0.002378 ,0.002369 ,
-    0.002360 ,0.002351 ,0.002341 ,0.002332 ,0.002323 ,0.002314 ,0.002305 ,
-    0.002297 ,0.002289 ,0.002281 
-};
+static uint32_t get_le32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
 
-/*------------------------------ function prototypes --------------------------*/
-static void stimer_callback(void *arg)
+static void put_le32(uint8_t *p, uint32_t v)
+{
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = (v >> 24) & 0xFF;
+}
+
+static void put_float(uint8_t *p, float f)
+{
+    uint32_t v;
+    
+    memcpy(&v, &f, sizeof(v));
+    put_le32(p, v);
+}
+
+static void handshake_timer_cb(void *arg)
 {
     operate_loop_send_cmd(dowLoopImpd_HandShake);
 }
 
+/**
+  * @brief : 运行一次当前的命令协程，结束后释放
+  */
+static void loop_impd_co_poll(void)
+{
+    if (loop_co.fn && !PT_SCHEDULE(loop_co.fn(&loop_co.pt, loop_co.msg.buf, loop_co.msg.len)))
+        loop_co.fn = NULL;
+}
+
+/**
+  * @brief : 启动命令协程并立即运行到第一个等待点，已有协程运行时应答设备忙
+  */
+static void loop_impd_co_start(loop_impd_co_t fn, const loop_msg_t *msg)
+{
+    if (loop_co.fn) {
+        operate_loop_send_byte(msg->id, ack_Failure_Busy);
+        return;
+    }
+    
+    loop_co.fn = fn;
+    loop_co.msg = *msg;
+    loop_co.tick = HAL_GetTick();
+    PT_INIT(&loop_co.pt);
+    loop_impd_co_poll();
+}
+
+static uint8_t loop_impd_co_expired(void)
+{
+    return HAL_GetTick() - loop_co.tick >= LOOP_IMPD_CO_TIMEOUT_MS;
+}
+
+static uint8_t loop_impd_relay_pending(void)
+{
+    impd_relay_status_t st;
+    
+    impd_relay_get_status(&st);
+    return st.pending;
+}
+
+static int loop_impd_exc_set_freq(uint32_t freq, uint32_t *gen, void *arg)
+{
+    int ret = impd_exc_set_freq(freq);
+    
+    *gen = impd_exc_get_gen();
+    return ret;
+}
+
+/**
+  * @brief : 窗口结束，未锁相时第一个频点的幅值 (Q15 满量程) 作为阻抗读数写入历史
+  */
+static void loop_impd_goertzel_done(const goertzel_result_t *res, uint8_t nbins, void *user_data)
+{
+    if (nbins > 0 && !loop_lockin_on)
+        impd_hist_push(HAL_GetTick(), (int32_t)(res[0].mag_q31 >> 16));
+}
+
+/**
+  * @brief : 锁相窗口结束，激励频率处的幅值 (Q15 满量程) 作为阻抗读数写入历史
+  */
+static void loop_impd_lockin_done(const lockin_result_t *res, void *user_data)
+{
+    impd_hist_push(HAL_GetTick(), (int32_t)(res->mag_q31 >> 16));
+}
+
+/**
+  * @brief : 按当前激励频率选择历史读数的检测器
+  * @note  : 每周期样本数为 4 的整数倍、不超过 LOOP_IMPD_LOCKIN_PERIOD_MAX 且能整除
+  *          LOOP_IMPD_GOERTZEL_WIN 时用锁相解调 (窗口仍为工频整周期)，
+  *          其余频率由 loop_goertzel 的第一个频点产生读数
+  */
+static void loop_impd_lockin_track(void)
+{
+    uint32_t rate = impd_adc_get_sample_rate();
+    uint32_t freq = impd_exc_get_freq();
+    uint32_t period;
+    
+    loop_lockin_on = 0;
+    if (freq == 0 || rate % freq != 0)
+        return;
+    period = rate / freq;
+    if (period > LOOP_IMPD_LOCKIN_PERIOD_MAX || LOOP_IMPD_GOERTZEL_WIN % period != 0)
+        return;
+    if (lockin_build_ref(loop_lockin_ref, (uint16_t)period) != 0 ||
+        lockin_init(&loop_lockin, loop_lockin_ref, (uint16_t)period,
+                    (uint16_t)(LOOP_IMPD_GOERTZEL_WIN / period)) != 0)
+        return;
+    
+    loop_lockin.on_result = loop_impd_lockin_done;
+    loop_lockin_gen = impd_exc_get_gen();
+    loop_lockin_align = 1;
+    loop_lockin_on = 1;
+}
+
+/**
+  * @brief : 锁相解调一个数据块，首次处理新激励的数据时把参考下标对齐到激励相位
+  */
+static void loop_impd_lockin_block(const uint16_t *block, size_t n, const impd_adc_ref_t *ref)
+{
+    uint32_t phase;
+    
+    if (loop_lockin_align) {
+        if ((int32_t)(ref->exc_gen - loop_lockin_gen) < 0 || ref->exc_from >= n)
+            return;
+        phase = ref->exc_phase + ref->exc_inc * ref->exc_from;
+        lockin_reset(&loop_lockin, (uint16_t)((((uint64_t)phase * loop_lockin.period) + 0x80000000ULL) >> 32));
+        block += ref->exc_from;
+        n -= ref->exc_from;
+        loop_lockin_align = 0;
+    }
+    lockin_process(&loop_lockin, block, n);
+}
+
+/**
+  * @brief : 每个 ADC 块的幅值 (Q15 满量程) 送入事件检测
+  */
+static void loop_impd_event_goertzel_done(const goertzel_result_t *res, uint8_t nbins, void *user_data)
+{
+    int32_t reading;
+    
+    if (nbins == 0)
+        return;
+    
+    reading = (int32_t)(res[0].mag_q31 >> 16);
+    impd_event_update(&loop_event, HAL_GetTick(), reading);
+    impd_cal_feed(reading);
+}
+
+/**
+  * @brief : 校准点平均完成上报
+  * @note  : [0] 点序号，[1] 参考电阻 (mΩ)，[5] 平均读数
+  */
+static void loop_impd_cal_point_done(uint8_t idx, uint32_t ref_mohm, int32_t reading, void *user_data)
+{
+    uint8_t buf[9];
+    
+    buf[0] = idx;
+    put_le32(&buf[1], ref_mohm);
+    put_le32(&buf[5], (uint32_t)reading);
+    operate_loop_send_string(upLoopImpd_CalPoint, buf, sizeof(buf));
+}
+
+/**
+  * @brief : 事件主动上报，不等待主机查询
+  * @note  : [0] 事件类型，[1] 读数，[5] 变化率 (/s)，[9] 时刻 (ms)
+  */
+static void loop_impd_event_fire(const impd_event_t *evt, void *user_data)
+{
+    uint8_t buf[13];
+    
+    if (!loop_impd_info.m_Link)
+        return;
+    
+    buf[0] = evt->type;
+    put_le32(&buf[1], (uint32_t)evt->value);
+    put_le32(&buf[5], (uint32_t)evt->rate);
+    put_le32(&buf[9], evt->tick);
+    custom_proto_send_frame(&loop_proto, upLoopImpd_Event, 0, 0, buf, sizeof(buf));
+}
+
+/**
+  * @brief : 继电器已切换，丢弃跨越切换点的未完成窗口
+  */
+static void loop_impd_relay_switched(uint8_t state, uint32_t tick, void *user_data)
+{
+    goertzel_reset(&loop_goertzel);
+    goertzel_reset(&loop_event_goertzel);
+    impd_event_reset(&loop_event);
+    loop_lockin_align = 1;
+}
+
+/**
+  * @brief : 回路通道 ADC 数据块处理
+  */
+static void loop_impd_adc_block(const uint16_t *block, size_t n, void *user_data)
+{
+    const impd_adc_ref_t *ref = impd_adc_get_ref();
+    
+    if (!impd_relay_block_ready(impd_sweep_busy()))
+        return;
+    
+    if (impd_sweep_busy()) {
+        impd_sweep_process(block, n, ref);
+    } else {
+        goertzel_set_ref(&loop_goertzel, ref->exc_phase, ref->exc_inc);
+        goertzel_process(&loop_goertzel, block, n);
+        goertzel_process(&loop_event_goertzel, block, n);
+        if (loop_lockin_on)
+            loop_impd_lockin_block(block, n, ref);
+    }
+}
+
+/**
+  * @brief : 扫频结束或中止：恢复扫频前的激励，测量从恢复后的新读数重新开始
+  */
+static void loop_impd_sweep_end(void)
+{
+    impd_exc_set_freq(loop_sweep_freq);
+    impd_exc_set_amp(loop_sweep_amp);
+    goertzel_reset(&loop_goertzel);
+    goertzel_reset(&loop_event_goertzel);
+    impd_event_reset(&loop_event);
+    loop_impd_lockin_track();
+}
+
+/**
+  * @brief : 扫频完成，一帧上报全部频点
+  * @note  : [0] 频点数 N，[1 + 12i] 频率，[5 + 12i] 幅值，[9 + 12i] 相对激励的相位 (uint32 小端)；
+  *          N 小于请求的频点数表示某个频点超时或激励设置失败
+  */
+static void loop_impd_sweep_done(const impd_sweep_point_t *pts, uint8_t n, void *user_data)
+{
+    static uint8_t buf[1 + IMPD_SWEEP_POINT_MAX * 12];
+    uint8_t i;
+    
+    loop_impd_sweep_end();
+    
+    buf[0] = n;
+    for (i = 0; i < n; i++) {
+        put_le32(&buf[1 + i * 12], pts[i].freq);
+        put_le32(&buf[5 + i * 12], pts[i].mag_q31);
+        put_le32(&buf[9 + i * 12], (uint32_t)pts[i].phase);
+    }
+    operate_loop_send_string(upLoopImpd_SweepResult, buf, 1 + n * 12);
+}
+
 int loop_impd_init(void)
 {
     int ret;
@@ -77,8 +358,27 @@ int loop_impd_init(void)
         return -1;
     }
     
-    stimer_create(&loop_proto.timer, 1000, STIMER_AUTO_RELOAD, stimer_callback, NULL);
-    stimer_start(&loop_proto.timer);
+    ret = impd_exc_init();
+    if (ret != 0) {
+        LOG_E("Failed to initialize excitation: %d\r\n", ret);
+        return -1;
+    }
+    
+    goertzel_init(&loop_goertzel, LOOP_IMPD_GOERTZEL_WIN);
+    loop_goertzel.on_result = loop_impd_goertzel_done;
+    goertzel_init(&loop_event_goertzel, IMPD_ADC_BLOCK_LEN);
+    loop_event_goertzel.on_result = loop_impd_event_goertzel_done;
+    impd_event_init(&loop_event, loop_impd_event_fire, NULL);
+    impd_cal_init(loop_impd_cal_point_done, NULL);
+    impd_hist_init(IMPD_HIST_EMA_ALPHA_DEFAULT);
+    impd_relay_init(loop_impd_relay_switched, NULL);
+    impd_sweep_init(loop_impd_sweep_done, NULL);
+    impd_sweep_set_exciter(loop_impd_exc_set_freq, NULL);
+    impd_adc_register(IMPD_ADC_CH_LOOP, loop_impd_adc_block, NULL);
+    impd_exc_start();
+    
+    twheel_create(&loop_proto.timer, 1000, TWHEEL_AUTO_RELOAD, handshake_timer_cb, NULL);
+    twheel_start(&loop_proto.timer);
     
     loop_impd_info.m_Status = 1;
     
@@ -87,12 +387,13 @@ int loop_impd_init(void)
 
 uint8_t loop_impd_get_cal_state(void)
 {
-    return cal_state;
+    return impd_cal_get_state();
 }
 
 void loop_impd_set_cal_state(uint8_t state)
 {
-    cal_state = state;
+    if (state == IMPD_CAL_IDLE)
+        impd_cal_abort();
 }
 
 void loop_impd_handshake(const uint8_t *data, uint16_t len)
@@ -120,7 +421,7 @@ void loop_impd_set_hw_version(const uint8_t *data, uint16_t len)
     } else {
         ack = ack_Failure_Unknown;
     }
-    LOG_D("ack = %d\r\n", ack);
+    DLOG_D("ack = %d\r\n", ack);
     operate_loop_send_byte(cmd_Set_HardwareVersion, ack);
 }
 
@@ -141,7 +442,7 @@ void loop_impd_set_serial_num(const uint8_t *data, uint16_t len)
     } else {
         ack = ack_Failure_Unknown;
     }
-    LOG_D("ack = %d\r\n", ack);
+    DLOG_D("ack = %d\r\n", ack);
     operate_loop_send_byte(cmd_Set_SerialNumber, ack);
 }
 
@@ -152,100 +453,768 @@ void loop_impd_get_serial_num(const uint8_t *data, uint16_t len)
     LOG_D("SN_NUMBER = %s!\r\n", str);
 }
 
-void loop_impd_ctrl_soft_reset(const uint8_t *data, uint16_t len)
+/**
+  * @brief : 写回修改的参数后应答，每写一个键让出一次
+  */
+PT_THREAD(loop_impd_ctrl_soft_reset(struct pt *pt, const uint8_t *data, uint16_t len))
 {
-    uint8_t ack = 0;
-    LOG_D("Soft reset!\r\n");
-    operate_loop_send_byte(cmd_Ctrl_SoftReset, ack);
+    int ret;
+    
+    PT_BEGIN(pt);
+    DLOG_D("Soft reset!\r\n");
+    while ((ret = data_mgmt_flush_step()) > 0)
+        PT_YIELD(pt);
+    operate_loop_send_byte(cmd_Ctrl_SoftReset, ret == 0 ? ack_Finish : ack_Failure_OperateAbnormal);
+    PT_END(pt);
 }
 
 void loop_impd_self_check(const uint8_t *data, uint16_t len)
 {
     uint8_t ack = 0;
-    LOG_D("Self check!\r\n");
+    DLOG_D("Self check!\r\n");
     operate_loop_send_byte(cmd_Ctrl_SelfCheck, ack);
 }
 
-void loop_impd_ctrl_lowpower(const uint8_t *data, uint16_t len)
+PT_THREAD(loop_impd_ctrl_lowpower(struct pt *pt, const uint8_t *data, uint16_t len))
 {
-    uint8_t ack = 0;
-    LOG_D("Ctrl lowpower!\r\n");
-    operate_loop_send_byte(cmd_Ctrl_LowPowerMode, ack);
+    int ret;
+    
+    PT_BEGIN(pt);
+    DLOG_D("Ctrl lowpower!\r\n");
+    while ((ret = data_mgmt_flush_step()) > 0)
+        PT_YIELD(pt);
+    operate_loop_send_byte(cmd_Ctrl_LowPowerMode, ret == 0 ? ack_Finish : ack_Failure_OperateAbnormal);
+    PT_END(pt);
 }
 
+/**
+  * @brief : 在线升级
+  * @param : data [0] 子命令：
+  *              0 开始/续传 [1..4] 镜像长度，[5..8] 镜像 CRC32
+  *              1 数据块   [1..2] 块号，[3..4] 数据 CRC16，[5..] 数据
+  *              2 结束并校验
+  *              3 放弃
+  *              4 开始差分升级 [1..4] 补丁长度，[5..8] 新镜像长度，[9..12] 新镜像 CRC32，
+  *                [13..16] 旧镜像长度，[17..20] 旧镜像 CRC32，之后的数据块内容为补丁
+  *              无数据时仅应答，兼容旧上位机
+  *          应答 [0] 子命令，[1] ack，[2..3] 下一个期望的块号；
+  *          开始命令另附 [4] 窗口块数，[5..6] 块长度。开始命令立即应答，下载区在后台擦除，
+  *          块所在页尚未擦除时应答忙，主机稍后从期望块号重发
+  * @retval: 
+  */
 void loop_impd_ctrl_iap(const uint8_t *data, uint16_t len)
 {
-    uint8_t ack = 0;
-    LOG_D("Ctrl IAP!\r\n");
-    operate_loop_send_byte(cmd_Ctrl_IAP, ack);
+    uint8_t resp[7];
+    uint8_t n = 4;
+    uint8_t ack = ack_Finish;
+    int ret = 0;
+    
+    if (len == 0) {
+        DLOG_D("Ctrl IAP!\r\n");
+        operate_loop_send_byte(cmd_Ctrl_IAP, ack);
+        return;
+    }
+    
+    switch (data[0]) {
+        case 0:
+            if (len != 9) {
+                ack = ack_Failure_FrameLen;
+                break;
+            }
+            ret = iap_start(get_le32(&data[1]), get_le32(&data[5]));
+            resp[4] = IAP_WINDOW;
+            resp[5] = (uint8_t)IAP_BLOCK_SIZE;
+            resp[6] = (uint8_t)(IAP_BLOCK_SIZE >> 8);
+            n = 7;
+            break;
+        case 1:
+            if (len < 6) {
+                ack = ack_Failure_FrameLen;
+                break;
+            }
+            ret = iap_write_block(get_le16(&data[1]), get_le16(&data[3]), &data[5], len - 5);
+            break;
+        case 2:
+            ret = iap_finish();
+            break;
+        case 3:
+            iap_abort();
+            break;
+        case 4:
+            if (len != 21) {
+                ack = ack_Failure_FrameLen;
+                break;
+            }
+            ret = iap_start_delta(get_le32(&data[1]), get_le32(&data[5]), get_le32(&data[9]),
+                                  get_le32(&data[13]), get_le32(&data[17]));
+            resp[4] = IAP_WINDOW;
+            resp[5] = (uint8_t)IAP_BLOCK_SIZE;
+            resp[6] = (uint8_t)(IAP_BLOCK_SIZE >> 8);
+            n = 7;
+            break;
+        default:
+            ack = ack_Failure_Format;
+            break;
+    }
+    
+    if (ret == -EILSEQ)
+        ack = ack_Failure_Check;
+    else if (ret == -EBUSY)
+        ack = ack_Failure_Busy;
+    else if (ret == -EPERM)
+        ack = ack_Failure_ModeAbnormal;
+    else if (ret == -EINVAL || ret == -EAGAIN)
+        ack = ack_Failure_DataAbnormal;
+    else if (ret != 0)
+        ack = ack_Failure_OperateAbnormal;
+    
+    resp[0] = data[0];
+    resp[1] = ack;
+    resp[2] = (uint8_t)iap_get_next();
+    resp[3] = (uint8_t)(iap_get_next() >> 8);
+    if (ack != ack_Finish)
+        DLOG_D("iap sub %d ack = %d\r\n", data[0], ack);
+    operate_loop_send_string(cmd_Ctrl_IAP, resp, n);
 }
 
 void loop_impd_ctrl_upload(const uint8_t *data, uint16_t len)
 {
     uint8_t ack = 0;
-    LOG_D("Ctrl upload!\r\n");
+    DLOG_D("Ctrl upload!\r\n");
     operate_loop_send_byte(cmd_Ctrl_UploadMode, ack);
 }
 
+/**
+  * @brief : 设置单频点检测频率
+  * @param : data [0] 频点数 N，[1 + 4i] 第 i 个频率 (Hz，uint32 小端)
+  * @retval: 
+  */
+void loop_impd_set_freq_bins(const uint8_t *data, uint16_t len)
+{
+    uint32_t phase_inc[GOERTZEL_BIN_MAX];
+    uint32_t rate = impd_adc_get_sample_rate();
+    uint32_t freq;
+    uint8_t ack = ack_Finish;
+    uint8_t i;
+    
+    if (len < 1 || data[0] > GOERTZEL_BIN_MAX || len != 1 + data[0] * 4) {
+        ack = ack_Failure_FrameLen;
+    } else {
+        for (i = 0; i < data[0]; i++) {
+            freq = get_le32(&data[1 + i * 4]);
+            if (freq == 0 || freq >= rate / 2) {
+                ack = ack_Failure_DataAbnormal;
+                break;
+            }
+            phase_inc[i] = DSP_PHASE_INC(freq, rate);
+        }
+        if (ack == ack_Finish && goertzel_config(&loop_goertzel, phase_inc, data[0]) != 0)
+            ack = ack_Failure_Unknown;
+        if (ack == ack_Finish) {
+            goertzel_config(&loop_event_goertzel, phase_inc, data[0] ? 1 : 0);
+            impd_event_reset(&loop_event);
+        }
+    }
+    DLOG_D("ack = %d\r\n", ack);
+    operate_loop_send_byte(dowLoopImpd_Set_FreqBins, ack);
+}
+
+/**
+  * @brief : 读取最近一个窗口的单频点结果
+  * @note  : 应答 [0] 频点数 N，[1 + 8i] 幅值 (Q31 满量程)，[5 + 8i] 相位 (Q31 π)。
+  *          相位相对窗口起点的激励相位，只有与激励同频的频点有意义，其余频点填 0
+  */
+void loop_impd_get_freq_bins(const uint8_t *data, uint16_t len)
+{
+    uint8_t buf[1 + GOERTZEL_BIN_MAX * 8];
+    uint32_t exc_inc = DSP_PHASE_INC(impd_exc_get_freq(), impd_adc_get_sample_rate());
+    uint8_t i;
+    
+    buf[0] = loop_goertzel.nbins;
+    for (i = 0; i < loop_goertzel.nbins; i++) {
+        put_le32(&buf[1 + i * 8], loop_goertzel.result[i].mag_q31);
+        put_le32(&buf[5 + i * 8], (loop_goertzel.bin[i].phase_inc == exc_inc) ?
+                                  (uint32_t)loop_goertzel.result[i].phase : 0);
+    }
+    operate_loop_send_string(dowLoopImpd_Get_FreqBins, buf, 1 + buf[0] * 8);
+}
+
+/**
+  * @brief : 启动扫频，立即应答，扫频结束后通过 upLoopImpd_SweepResult 上报
+  * @param : data [0..1] 建立时间 (ms，从激励实际切换频率起计)，[2] 频点数 N，[3 + 4i] 第 i 个频率 (Hz)；
+  *               N 为 0 时中止正在进行的扫频，不上报结果
+  * @note  : 扫频结束、超时或中止后恢复扫频前的激励频率和幅值。
+  *          中止时没有进行中的扫频应答 ack_Failure_OperateInvalid
+  */
+void loop_impd_ctrl_sweep(const uint8_t *data, uint16_t len)
+{
+    uint32_t freq[IMPD_SWEEP_POINT_MAX];
+    uint32_t exc_freq = impd_exc_get_freq();
+    uint16_t exc_amp = impd_exc_get_amp();
+    uint8_t ack = ack_Finish;
+    uint8_t i;
+    int ret;
+    
+    if (len < 3 || data[2] > IMPD_SWEEP_POINT_MAX || len != 3 + data[2] * 4) {
+        ack = ack_Failure_FrameLen;
+    } else if (data[2] == 0) {
+        if (impd_sweep_busy()) {
+            impd_sweep_abort();
+            loop_impd_sweep_end();
+        } else {
+            ack = ack_Failure_OperateInvalid;
+        }
+    } else {
+        for (i = 0; i < data[2]; i++)
+            freq[i] = get_le32(&data[3 + i * 4]);
+        
+        ret = impd_sweep_start(freq, data[2], get_le16(&data[0]),
+                               LOOP_IMPD_GOERTZEL_WIN, impd_adc_get_sample_rate());
+        if (ret == 0) {
+            loop_sweep_freq = exc_freq;
+            loop_sweep_amp = exc_amp;
+        } else if (ret == -EBUSY) {
+            ack = ack_Failure_Busy;
+        } else if (ret == -ENODEV) {
+            ack = ack_Failure_OperateInvalid;
+        } else {
+            ack = ack_Failure_DataAbnormal;
+        }
+    }
+    DLOG_D("ack = %d\r\n", ack);
+    operate_loop_send_byte(dowLoopImpd_Ctrl_Sweep, ack);
+}
+
+/**
+  * @brief : 选择测量通道
+  * @param : data [0] 0 回路 / 1 贴附 (enum sub_mode)
+  * @note  : 贴附通道跟随当前激励频率检测，结果由 dowLoopImpd_Get_AttachValue 读取
+  */
+void loop_impd_ctrl_mode(const uint8_t *data, uint16_t len)
+{
+    uint8_t ack = ack_Finish;
+    
+    if (len != 1)
+        ack = ack_Failure_FrameLen;
+    else if (app_set_sub_mode(data[0]) != 0)
+        ack = ack_Failure_DataAbnormal;
+    DLOG_D("ack = %d\r\n", ack);
+    operate_loop_send_byte(dowLoopImpd_Ctrl_Mode, ack);
+}
+
+/**
+  * @brief : 读取贴附通道最近一个窗口的结果
+  * @note  : 应答 [0] ack，[1] 是否有结果，[2] 激励频率 (Hz)，[6] 幅值 (Q31 满量程)，
+  *          [10] 相对激励的相位 (Q31 π)；多字节均为小端，无结果时后两项为 0。
+  *          不在贴附模式时只应答 [0] ack_Failure_OperateInvalid
+  */
+void loop_impd_get_attach_value(const uint8_t *data, uint16_t len)
+{
+    uint32_t mag = 0;
+    int32_t phase = 0;
+    uint8_t buf[14];
+    
+    if (app_get_sub_mode() != ATTACH_MODE) {
+        operate_loop_send_byte(dowLoopImpd_Get_AttachValue, ack_Failure_OperateInvalid);
+        return;
+    }
+    
+    buf[0] = ack_Finish;
+    buf[1] = (attach_impd_is_ready() && attach_impd_get_value(&mag, &phase) == 0) ? 1 : 0;
+    put_le32(&buf[2], impd_exc_get_freq());
+    put_le32(&buf[6], mag);
+    put_le32(&buf[10], (uint32_t)phase);
+    operate_loop_send_string(dowLoopImpd_Get_AttachValue, buf, sizeof(buf));
+}
+
+/**
+  * @brief : 继电器开关，切换在下一个 ADC 块边界执行，建立期间的数据自动丢弃
+  * @param : data [0] 0 断开 / 1 闭合，[1..2] 建立时间 (ms，可省略)
+  * @retval: 
+  */
+void loop_impd_ctrl_relay(const uint8_t *data, uint16_t len)
+{
+    uint8_t ack = ack_Finish;
+    
+    if (len != 1 && len != 3) {
+        ack = ack_Failure_FrameLen;
+    } else if (len == 3 && impd_relay_set_settle(get_le16(&data[1])) != 0) {
+        ack = ack_Failure_DataAbnormal;
+    } else if (impd_relay_request(data[0]) != 0) {
+        ack = ack_Failure_DataAbnormal;
+    }
+    DLOG_D("ack = %d\r\n", ack);
+    operate_loop_send_byte(dowLoopImpd_Ctrl_RelaySwitch, ack);
+}
+
+/**
+  * @brief : 切换继电器，等待建立后第一个完整测量窗口的读数
+  * @param : data [0] 0 断开 / 1 闭合，[1..2] 建立时间 (ms，可省略)
+  * @note  : 应答 [0] ack，[1] 继电器状态，[2] 读数 (Q15 满量程)，[6] 读数时刻 (ms)，
+  *          [10] 换算电阻 (mΩ，未校准为 0x7FFFFFFF)；多字节均为小端
+  *          切换时测量窗口已清零且丢弃期的块不参与计算，切换后产生的第一个读数
+  *          完全位于建立时间之后
+  */
+PT_THREAD(loop_impd_relay_measure(struct pt *pt, const uint8_t *data, uint16_t len))
+{
+    impd_hist_sample_t s;
+    int32_t mohm;
+    uint8_t buf[14];
+    
+    PT_BEGIN(pt);
+    
+    if (len != 1 && len != 3) {
+        operate_loop_send_byte(dowLoopImpd_Ctrl_RelayMeasure, ack_Failure_FrameLen);
+        PT_EXIT(pt);
+    }
+    if (impd_sweep_busy()) {
+        operate_loop_send_byte(dowLoopImpd_Ctrl_RelayMeasure, ack_Failure_Busy);
+        PT_EXIT(pt);
+    }
+    if ((len == 3 && impd_relay_set_settle(get_le16(&data[1])) != 0) ||
+        impd_relay_request(data[0]) != 0) {
+        operate_loop_send_byte(dowLoopImpd_Ctrl_RelayMeasure, ack_Failure_DataAbnormal);
+        PT_EXIT(pt);
+    }
+    
+    /* 切换在下一个 ADC 块边界执行 */
+    PT_WAIT_UNTIL(pt, !loop_impd_relay_pending() || loop_impd_co_expired());
+    loop_co.mark = impd_hist_get_stats()->count;
+    PT_WAIT_UNTIL(pt, impd_hist_get_stats()->count != loop_co.mark || loop_impd_co_expired());
+    
+    if (impd_hist_get_stats()->count == loop_co.mark || impd_hist_tail(&s, 1) == 0) {
+        operate_loop_send_byte(dowLoopImpd_Ctrl_RelayMeasure, ack_Failure_Timeout);
+        PT_EXIT(pt);
+    }
+    if (impd_cal_convert(s.value, &mohm) != 0)
+        mohm = INT32_MAX;
+    
+    buf[0] = ack_Finish;
+    buf[1] = data[0];
+    put_le32(&buf[2], (uint32_t)s.value);
+    put_le32(&buf[6], s.tick);
+    put_le32(&buf[10], (uint32_t)mohm);
+    operate_loop_send_string(dowLoopImpd_Ctrl_RelayMeasure, buf, sizeof(buf));
+    
+    PT_END(pt);
+}
+
+/**
+  * @brief : 读取继电器状态
+  * @note  : 应答 [0] 当前状态，[1] 是否有排队的切换，[2] 排队目标状态，
+  *          [3] 是否处于丢弃期，[4] 最近切换时刻 (ms)，[8] 切换次数
+  */
+void loop_impd_get_relay(const uint8_t *data, uint16_t len)
+{
+    impd_relay_status_t st;
+    uint8_t buf[12];
+    
+    impd_relay_get_status(&st);
+    buf[0] = st.state;
+    buf[1] = st.pending;
+    buf[2] = st.target;
+    buf[3] = st.blanking;
+    put_le32(&buf[4], st.switch_tick);
+    put_le32(&buf[8], st.switch_count);
+    operate_loop_send_string(dowLoopImpd_Get_RelayState, buf, sizeof(buf));
+}
+
+/**
+  * @brief : 读取阻抗历史统计
+  * @param : data [0..1] 窗口长度 k (0 为环内全部样本)，[2] 附带的最近原始样本数，
+  *               均可省略 (帧长 0 / 2 / 3)
+  * @note  : 应答 [0..1] 窗口样本数，[2] 最小值，[6] 最大值，[10] 均值 (float)，
+  *          [14] 方差 (float)，[18] 复位以来样本数，[22] 复位以来均值 (float)，
+  *          [26] 复位以来方差 (float)，[30] EMA (float)，[34] 复位以来最小值，
+  *          [38] 复位以来最大值，[42] 原始样本数 N，[43 + 8i] 时间戳 (ms)，[47 + 8i] 读数；
+  *          多字节均为小端
+  */
+void loop_impd_get_value(const uint8_t *data, uint16_t len)
+{
+    static uint8_t buf[LOOP_IMPD_HIST_HDR_LEN + LOOP_IMPD_HIST_TAIL_MAX * 8];
+    impd_hist_sample_t tail[LOOP_IMPD_HIST_TAIL_MAX];
+    impd_hist_summary_t sum;
+    const run_stats_t *rs = impd_hist_get_stats();
+    uint16_t k = 0;
+    uint8_t n = 0;
+    uint8_t i;
+    
+    if (len != 0 && len != 2 && len != 3) {
+        operate_loop_send_byte(dowLoopImpd_GET_LOOP_IMPD_VALUE, ack_Failure_FrameLen);
+        return;
+    }
+    if (len >= 2)
+        k = get_le16(&data[0]);
+    if (len == 3)
+        n = (data[2] > LOOP_IMPD_HIST_TAIL_MAX) ? LOOP_IMPD_HIST_TAIL_MAX : data[2];
+    
+    impd_hist_window(k, &sum);
+    n = impd_hist_tail(tail, n);
+    
+    buf[0] = sum.count & 0xFF;
+    buf[1] = (sum.count >> 8) & 0xFF;
+    put_le32(&buf[2], (uint32_t)sum.min);
+    put_le32(&buf[6], (uint32_t)sum.max);
+    put_float(&buf[10], sum.mean);
+    put_float(&buf[14], sum.var);
+    put_le32(&buf[18], rs->count);
+    put_float(&buf[22], rs->mean);
+    put_float(&buf[26], run_stats_var(rs));
+    put_float(&buf[30], rs->ema);
+    put_le32(&buf[34], (uint32_t)rs->min);
+    put_le32(&buf[38], (uint32_t)rs->max);
+    buf[42] = n;
+    for (i = 0; i < n; i++) {
+        put_le32(&buf[LOOP_IMPD_HIST_HDR_LEN + i * 8], tail[i].tick);
+        put_le32(&buf[LOOP_IMPD_HIST_HDR_LEN + 4 + i * 8], (uint32_t)tail[i].value);
+    }
+    operate_loop_send_string(dowLoopImpd_GET_LOOP_IMPD_VALUE, buf, LOOP_IMPD_HIST_HDR_LEN + n * 8);
+}
+
+/**
+  * @brief : 设置阻抗事件检测参数，读数为第一个频点每个 ADC 块的幅值 (Q15 满量程)
+  * @param : data [0] 使能位 (bit0 上限，bit1 下限，bit2 变化率)，[1] 上限，[5] 下限，
+  *               [9] 回差，[13..14] 驻留时间 (ms)，[15] 变化率上限 (/s)，
+  *               [19] 读数中值窗口 (可省略，默认 0 不滤波，最大 IMPD_EVENT_MEDIAN_MAX)；多字节均为小端
+  * @note  : 中值窗口为 m 时阶跃晚 m/2 个块 (每块 25 ms) 才被检测到，短于 m/2 + 1 个块的偏离不会触发
+  * @retval: 
+  */
+void loop_impd_set_event_cfg(const uint8_t *data, uint16_t len)
+{
+    impd_event_cfg_t cfg;
+    uint8_t ack = ack_Finish;
+    
+    if (len != 19 && len != 20) {
+        ack = ack_Failure_FrameLen;
+    } else {
+        cfg.enable = data[0];
+        cfg.high = (int32_t)get_le32(&data[1]);
+        cfg.low = (int32_t)get_le32(&data[5]);
+        cfg.hyst = (int32_t)get_le32(&data[9]);
+        cfg.dwell_ms = get_le16(&data[13]);
+        cfg.rate_max = (int32_t)get_le32(&data[15]);
+        cfg.median = (len == 20) ? data[19] : 0;
+        if (impd_event_config(&loop_event, &cfg) != 0)
+            ack = ack_Failure_DataAbnormal;
+    }
+    DLOG_D("ack = %d\r\n", ack);
+    operate_loop_send_byte(dowLoopImpd_Set_EventCfg, ack);
+}
+
+/**
+  * @brief : 开始自动校准
+  * @param : data [0..1] 每点平均的 ADC 块数，[2] 拟合方式 (0 分段线性，1 多项式)，
+  *               [3] 多项式阶数
+  * @retval: 
+  */
+void loop_impd_cal_start(const uint8_t *data, uint16_t len)
+{
+    uint8_t ack = ack_Finish;
+    
+    if (len != 4) {
+        ack = ack_Failure_FrameLen;
+    } else if (impd_cal_start(get_le16(&data[0]), data[2], data[3]) != 0) {
+        ack = ack_Failure_DataAbnormal;
+    }
+    DLOG_D("ack = %d\r\n", ack);
+    operate_loop_send_byte(dowLoopImpd_Cal_Start, ack);
+}
+
+/**
+  * @brief : 已接入参考电阻，开始平均该点，完成后通过 upLoopImpd_CalPoint 上报
+  * @param : data [0..3] 参考电阻 (mΩ)
+  * @retval: 
+  */
+void loop_impd_cal_point(const uint8_t *data, uint16_t len)
+{
+    uint8_t ack = ack_Finish;
+    int ret;
+    
+    if (len != 4) {
+        ack = ack_Failure_FrameLen;
+    } else {
+        ret = impd_cal_add_point(get_le32(&data[0]));
+        if (ret == -EBUSY)
+            ack = ack_Failure_Busy;
+        else if (ret == -ENOSPC)
+            ack = ack_Failure_DataAbnormal;
+        else if (ret != 0)
+            ack = ack_Failure_ModeAbnormal;
+    }
+    DLOG_D("ack = %d\r\n", ack);
+    operate_loop_send_byte(dowLoopImpd_Cal_Point, ack);
+}
+
+/**
+  * @brief : 结束校准
+  * @param : data [0] 0 放弃，1 拟合并生效，2 拟合、生效并保存到 flash
+  * @retval: 
+  */
+void loop_impd_cal_finish(const uint8_t *data, uint16_t len)
+{
+    uint8_t ack = ack_Finish;
+    int ret;
+    
+    if (len != 1 || data[0] > 2) {
+        ack = ack_Failure_FrameLen;
+    } else if (data[0] == 0) {
+        impd_cal_abort();
+    } else {
+        ret = impd_cal_finish(data[0] == 2);
+        if (ret == -EBUSY)
+            ack = ack_Failure_Busy;
+        else if (ret == -EINVAL || ret == -ERANGE)
+            ack = ack_Failure_DataAbnormal;
+        else if (ret != 0)
+            ack = ack_Failure_OperateAbnormal;
+    }
+    DLOG_D("ack = %d\r\n", ack);
+    operate_loop_send_byte(dowLoopImpd_Cal_Finish, ack);
+}
+
+/**
+  * @brief : 读取热点代码耗时统计
+  * @param : data [0] 子命令：0 读取 [1] 测量点，1 清零，2 输出到 RTT 日志
+  *          读取应答 [0] 子命令，[1] ack，[2] 测量点，[3] 测量点总数，[4..7] 次数，
+  *          [8..11] 最小，[12..15] 最大，[16..19] 平均 (周期数)，[20..23] 计数频率 (Hz)，
+  *          [24] 直方图格数，之后每格 4 字节 (第 n 格为 [2^n, 2^(n+1)) 周期)，最后为名称
+  * @retval: 
+  */
+void loop_impd_get_profile(const uint8_t *data, uint16_t len)
+{
+#if USING_PROF
+    uint8_t resp[25 + PROF_HIST_BINS * 4 + PROF_NAME_MAX];
+    prof_stat_t st;
+    const char *name;
+    uint16_t n = 2;
+    uint8_t ack = ack_Finish;
+    uint8_t i;
+    
+    if (len == 0) {
+        operate_loop_send_byte(dowLoopImpd_Get_Profile, ack_Failure_FrameLen);
+        return;
+    }
+    
+    switch (data[0]) {
+        case 0:
+            if (len != 2 || prof_get(data[1], &st) != 0) {
+                ack = ack_Failure_DataAbnormal;
+                break;
+            }
+            resp[2] = data[1];
+            resp[3] = PROF_SITE_NUM;
+            put_le32(&resp[4], st.count);
+            put_le32(&resp[8], st.min);
+            put_le32(&resp[12], st.max);
+            put_le32(&resp[16], st.count ? (uint32_t)(st.sum / st.count) : 0);
+            put_le32(&resp[20], prof_get_hz());
+            resp[24] = PROF_HIST_BINS;
+            n = 25;
+            for (i = 0; i < PROF_HIST_BINS; i++, n += 4)
+                put_le32(&resp[n], st.hist[i]);
+            name = prof_name(data[1]);
+            for (i = 0; name[i] && i < PROF_NAME_MAX; i++)
+                resp[n++] = (uint8_t)name[i];
+            break;
+        case 1:
+            prof_reset();
+            break;
+        case 2:
+            prof_dump();
+            break;
+        default:
+            ack = ack_Failure_DataAbnormal;
+            break;
+    }
+    
+    resp[0] = data[0];
+    resp[1] = ack;
+    operate_loop_send_string(dowLoopImpd_Get_Profile, resp, (ack == ack_Finish) ? n : 2);
+#else
+    operate_loop_send_byte(dowLoopImpd_Get_Profile, ack_Failure_OperateInvalid);
+#endif
+}
+
+/**
+  * @brief : 读取任务超期记录 (复位后保留)
+  * @param : data [0] 子命令：0 读取，1 清除
+  *          读取应答 [0] 子命令，[1] ack，[2..5] 看门狗复位次数，[6] 记录条数，
+  *          之后每条 16 字节：任务号、标志 (位0 复位后补记)、截止期 (2)、
+  *          发现时节拍 (4)、距上次报到 ms (4)、周期计数 (4)
+  * @retval: 
+  */
+void loop_impd_get_safety_log(const uint8_t *data, uint16_t len)
+{
+    uint8_t resp[7 + SAFETY_MISS_MAX * 16];
+    safety_miss_t miss[SAFETY_MISS_MAX];
+    uint16_t n = 2;
+    uint8_t ack = ack_Finish;
+    uint8_t cnt, i;
+    
+    if (len != 1 || data[0] > 1) {
+        operate_loop_send_byte(dowLoopImpd_Get_SafetyLog, ack_Failure_FrameLen);
+        return;
+    }
+    
+    if (data[0] == 0) {
+        cnt = safety_get_misses(miss, SAFETY_MISS_MAX);
+        put_le32(&resp[2], safety_get_resets());
+        resp[6] = cnt;
+        n = 7;
+        for (i = 0; i < cnt; i++, n += 16) {
+            resp[n] = miss[i].task;
+            resp[n + 1] = miss[i].flags;
+            resp[n + 2] = (uint8_t)miss[i].deadline;
+            resp[n + 3] = (uint8_t)(miss[i].deadline >> 8);
+            put_le32(&resp[n + 4], miss[i].tick);
+            put_le32(&resp[n + 8], miss[i].late);
+            put_le32(&resp[n + 12], miss[i].cycles);
+        }
+    } else {
+        safety_clear();
+    }
+    
+    resp[0] = data[0];
+    resp[1] = ack;
+    operate_loop_send_string(dowLoopImpd_Get_SafetyLog, resp, n);
+}
+
+/**
+  * @brief : 设置激励
+  * @param : data [0..3] 频率 (Hz，0 为关闭)，[4..5] 峰值 (DAC 码值)
+  * @note  : 频率为 IMPD_EXC_STATIC_STEP (400Hz) 的整数倍时波形固定在 DMA 缓冲区中；
+  *          其他频率每 2.5ms 在中断中重新生成一个块，约占 4% CPU
+  * @retval: 
+  */
+void loop_impd_set_excitation(const uint8_t *data, uint16_t len)
+{
+    uint8_t ack = ack_Finish;
+    
+    if (len != 6) {
+        ack = ack_Failure_FrameLen;
+    } else if (impd_sweep_busy()) {
+        ack = ack_Failure_Busy;
+    } else {
+        if (impd_exc_set_freq(get_le32(&data[0])) != 0 ||
+            impd_exc_set_amp(get_le16(&data[4])) != 0)
+            ack = ack_Failure_DataAbnormal;
+        loop_impd_lockin_track();
+    }
+    DLOG_D("ack = %d\r\n", ack);
+    operate_loop_send_byte(dowLoopImpd_Set_Excitation, ack);
+}
+
 void loop_impd_task(void)
 {
-    loop_msg_t msg;
+    const loop_msg_t *msg;
+    PROF_BEGIN(PROF_LOOP_TASK);
     
     custom_proto_parser(&loop_proto);
+    loop_impd_co_poll();
+    impd_sweep_poll();
     
-    if (operate_loop_get_msg(&msg) == 1) {
+    msg = operate_loop_peek_msg();
+    if (msg != NULL) {
         if (loop_impd_info.m_Link) {
-            switch(msg.id) {
+            switch(msg->id) {
                 case dowLoopImpd_HandShake:	//握手
                     operate_loop_send_byte(dowLoopImpd_HandShake, ack_Finish);
                     break;
                 case dowLoopImpd_Get_SoftwareVersion:
-                    loop_impd_get_sw_version(msg.buf, msg.len);
+                    loop_impd_get_sw_version(msg->buf, msg->len);
                     break;
                 case dowLoopImpd_Set_HardwareVersion:
-                    loop_impd_set_hw_version(msg.buf, msg.len);
+                    loop_impd_set_hw_version(msg->buf, msg->len);
                     break;
                 case dowLoopImpd_Get_HardwareVersion:
-                    loop_impd_get_hw_version(msg.buf, msg.len);
+                    loop_impd_get_hw_version(msg->buf, msg->len);
                     break;
                 case dowLoopImpd_Set_SerialNumber:
-                    loop_impd_set_serial_num(msg.buf, msg.len);
+                    loop_impd_set_serial_num(msg->buf, msg->len);
                     break;
                 case dowLoopImpd_Get_SerialNumber:
-                    loop_impd_get_serial_num(msg.buf, msg.len);
+                    loop_impd_get_serial_num(msg->buf, msg->len);
                     break;
                 case dowLoopImpd_Ctrl_SoftReset:
-                    loop_impd_ctrl_soft_reset(msg.buf, msg.len);
+                    loop_impd_co_start(loop_impd_ctrl_soft_reset, msg);
                     break;
                 case dowLoopImpd_Ctrl_SelfCheck:
-                    loop_impd_self_check(msg.buf, msg.len);
+                    loop_impd_self_check(msg->buf, msg->len);
                     break;
                 case dowLoopImpd_Ctrl_LowPowerMode:
-                    loop_impd_ctrl_lowpower(msg.buf, msg.len);
+                    loop_impd_co_start(loop_impd_ctrl_lowpower, msg);
                     break;
                 case dowLoopImpd_Ctrl_IAP:
-                    loop_impd_ctrl_iap(msg.buf, msg.len);
+                    loop_impd_ctrl_iap(msg->buf, msg->len);
                     break;
                 case dowLoopImpd_Ctrl_UploadMode:
-                    loop_impd_ctrl_upload(msg.buf, msg.len);
+                    loop_impd_ctrl_upload(msg->buf, msg->len);
                     break;
                 case dowLoopImpd_Ctrl_Mode:
+                    loop_impd_ctrl_mode(msg->buf, msg->len);
+                    break;
+                case dowLoopImpd_Ctrl_RelaySwitch:
+                    loop_impd_ctrl_relay(msg->buf, msg->len);
+                    break;
+                case dowLoopImpd_Ctrl_RelayMeasure:
+                    loop_impd_co_start(loop_impd_relay_measure, msg);
+                    break;
+                case dowLoopImpd_Get_RelayState:
+                    loop_impd_get_relay(msg->buf, msg->len);
+                    break;
+                case dowLoopImpd_GET_LOOP_IMPD_VALUE:
+                    loop_impd_get_value(msg->buf, msg->len);
+                    break;
+                case dowLoopImpd_Set_FreqBins:
+                    loop_impd_set_freq_bins(msg->buf, msg->len);
+                    break;
+                case dowLoopImpd_Get_FreqBins:
+                    loop_impd_get_freq_bins(msg->buf, msg->len);
+                    break;
+                case dowLoopImpd_Ctrl_Sweep:
+                    loop_impd_ctrl_sweep(msg->buf, msg->len);
+                    break;
+                case dowLoopImpd_Set_Excitation:
+                    loop_impd_set_excitation(msg->buf, msg->len);
+                    break;
+                case dowLoopImpd_Set_EventCfg:
+                    loop_impd_set_event_cfg(msg->buf, msg->len);
+                    break;
+                case dowLoopImpd_Cal_Start:
+                    loop_impd_cal_start(msg->buf, msg->len);
+                    break;
+                case dowLoopImpd_Cal_Point:
+                    loop_impd_cal_point(msg->buf, msg->len);
+                    break;
+                case dowLoopImpd_Cal_Finish:
+                    loop_impd_cal_finish(msg->buf, msg->len);
+                    break;
+                case dowLoopImpd_Get_Profile:
+                    loop_impd_get_profile(msg->buf, msg->len);
+                    break;
+                case dowLoopImpd_Get_SafetyLog:
+                    loop_impd_get_safety_log(msg->buf, msg->len);
+                    break;
+                case dowLoopImpd_Get_AttachValue:
+                    loop_impd_get_attach_value(msg->buf, msg->len);
                     break;
                 default:
-                    LOG_D("Unknow command!\r\n");
+                    DLOG_D("Unknow command!\r\n");
                     break;
             }
         } else {
-            if (msg.id == dowLoopImpd_HandShake) {
-                stimer_stop(&loop_proto.timer);
+            if (msg->id == dowLoopImpd_HandShake) {
+                twheel_stop(&loop_proto.timer);
                 operate_loop_send_byte(dowLoopImpd_HandShake, ack_Finish);
                 loop_impd_info.m_Link = 1; //标记握手成功
-                LOG_D("Handshake sucessful!\r\n");
+                DLOG_D("Handshake sucessful!\r\n");
             } else {
-                LOG_D("Pelease handshake first!\r\n");
+                DLOG_D("Pelease handshake first!\r\n");
             }
         }
+        operate_loop_release_msg();
     }
+    PROF_END(PROF_LOOP_TASK);
 }
 /*------------------------------ loop_impdlication ----------------------------------*/
 
@@ -24,25 +24,28 @@
 #include "serial.h"
 #include "stimer.h"
 #include "crc.h"
+#include "spsc_ring.h"
 
 #define  LOG_TAG             "operate_loop"
 #define  LOG_LVL             4
 #include "log.h"
+#include "dlog.h"
 
 #include <string.h>
 /*------------------------------ Macro definition -----------------------------*/
-static loop_msg_t loop_msg_buf[16];
-kfifo_t loop_msg_fifo;
+#define LOOP_MSG_RING_SIZE      (16)
 
 /*------------------------------ typedef definition ---------------------------*/
+SPSC_RING_DEFINE(loop_msg_ring, loop_msg_t, LOOP_MSG_RING_SIZE)
 
 /*------------------------------ variables prototypes -------------------------*/
 Protocol_type loop_proto = {0};
 serial_t *port;
 static uint8_t proto_rx_buf[OPERATE_LOOP_FRAME_MAX_LEN] = {0};
-static uint8_t proto_tx_buf[OPERATE_LOOP_FRAME_MIN_LEN] = {0};
+static uint8_t proto_tx_buf[OPERATE_LOOP_TX_FRAME_MAX_LEN] = {0};
 proto_parser_t custom_parser;
 static uint8_t handshake_flag = 0;
+static loop_msg_ring_t loop_msg_fifo;
 
 /*------------------------------ function prototypes --------------------------*/
 static void proto_data_handler(Protocol_type *type, uint8_t cmd, const uint8_t *data, uint16_t len);
@@ -81,6 +84,7 @@ int operate_loop_init(void)
     loop_proto.m_Addr_Expand = 0x05;
     loop_proto.m_LenMax = OPERATE_LOOP_FRAME_MAX_LEN;
     loop_proto.m_LenMin = OPERATE_LOOP_FRAME_MIN_LEN;
+    loop_proto.m_TxLenMax = OPERATE_LOOP_TX_FRAME_MAX_LEN;
     loop_proto.rx_buff = proto_rx_buf;
     loop_proto.rx_buffsz = OPERATE_LOOP_FRAME_MAX_LEN;
     loop_proto.m_TxBuffer = proto_tx_buf;
@@ -99,7 +103,7 @@ int operate_loop_init(void)
     }
     
     // 循环缓冲区初始化
-    kfifo_init(&loop_msg_fifo, loop_msg_buf, sizeof(loop_msg_buf), sizeof(loop_msg_t));
+    loop_msg_ring_init(&loop_msg_fifo);
     
     return 0;
 }
@@ -135,17 +139,17 @@ void operate_loop_send_cmd(uint8_t id)
 static void operate_loop_data_handle(const uint8_t *payload, size_t len, void *user_data)
 {
     Protocol_type *type = (Protocol_type*)user_data;
-    loop_msg_t msg = {0};
+    loop_msg_t *msg;
+    uint16_t msg_len;
     
     if (!type)
         return;
     
     uint8_t dev_id = payload[2];
-    msg.id = payload[3];
     
     // 检查帧是否是发给我们的
     if (dev_id != type->m_Addr) {
-        LOG_D("Frame not for us. For: 0x%02X, Us: 0x%02X\r\n", dev_id, type->m_Addr);
+        DLOG_D("Frame not for us. For: 0x%02X, Us: 0x%02X\r\n", dev_id, type->m_Addr);
         operate_loop_send_byte(upLoopImpd_UniversalACK, ack_Failure_DeviceNumber);
         return;
     }
@@ -160,25 +164,61 @@ static void operate_loop_data_handle(const uint8_t *payload, size_t len, void *u
 			operate_loop_send_byte(upLoopImpd_UniversalACK, ack_Failure_DeviceNumber);
 			return;
 		}
-        msg.len = len - 5;
+        msg_len = len - 5;
 	} else {
-        msg.len = len - 4;
+        msg_len = len - 4;
     }
     
-    if (msg.len > 0)
-        memcpy(msg.buf, &payload[5], msg.len);
-    
-    kfifo_in(&loop_msg_fifo, &msg, 1);
+    // 直接写入队列中的空位，队列满时丢弃
+    if (loop_msg_ring_reserve(&loop_msg_fifo, &msg) == 0) {
+        LOG_W("loop message queue full, cmd 0x%02X dropped\r\n", payload[3]);
+        return;
+    }
+    msg->id = payload[3];
+    msg->len = msg_len;
+    if (msg_len > 0)
+        memcpy(msg->buf, &payload[5], msg_len);
+    loop_msg_ring_commit(&loop_msg_fifo, 1);
 }
 
 size_t operate_loop_get_msg_len(void)
 {
-    return kfifo_len(&loop_msg_fifo);
+    return loop_msg_ring_len(&loop_msg_fifo);
 }
 
 size_t operate_loop_get_msg(loop_msg_t *msg)
 {
-    return kfifo_out(&loop_msg_fifo, msg, 1);
+    return loop_msg_ring_pop(&loop_msg_fifo, msg);
+}
+
+/**
+ * @brief  取最早的一条消息，不复制，处理完后调用 operate_loop_release_msg
+ * @retval 队列空时返回 NULL
+ */
+const loop_msg_t *operate_loop_peek_msg(void)
+{
+    loop_msg_t *msg;
+    
+    if (loop_msg_ring_peek(&loop_msg_fifo, &msg) == 0)
+        return NULL;
+    
+    return msg;
+}
+
+void operate_loop_release_msg(void)
+{
+    loop_msg_ring_release(&loop_msg_fifo, 1);
+}
+
+/**
+ * @brief  串口接收 FIFO 中尚未解析的字节数
+ */
+size_t operate_loop_get_rx_len(void)
+{
+    if (loop_proto.port == NULL)
+        return 0;
+    
+    return kfifo_len(&loop_proto.port->rx_fifo);
 }
 
 /******************************* End Of File ************************************/
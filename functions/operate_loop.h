@@ -23,8 +23,9 @@
 #include "custom_proto.h"
 
 /*------------------------------ Macro definition ----------------------------*/
-#define OPERATE_LOOP_FRAME_MAX_LEN          (64)
+#define OPERATE_LOOP_FRAME_MAX_LEN          (160)  /* 容纳 128 字节的升级数据块 */
 #define OPERATE_LOOP_FRAME_MIN_LEN          (9)
+#define OPERATE_LOOP_TX_FRAME_MAX_LEN       (CUSTOM_FRAME_MAX_LEN)  /* 批量上传帧 */
 
 /************通用命令码************/
 //系统相关功能：预留0x00~0x2f
@@ -48,8 +49,26 @@
 #define dowLoopImpd_Ctrl_RelaySwitch         0x31	/* 继电器开关 */
 #define dowLoopImpd_Get_RelayState           0x32	/* 读取继电器开关状态 */
 #define dowLoopImpd_GET_LOOP_IMPD_VALUE      0x33   /* 获取阻抗数据 */
+#define dowLoopImpd_Set_FreqBins             0x34   /* 设置单频点检测频率 */
+#define dowLoopImpd_Get_FreqBins             0x35   /* 读取单频点幅值和相位 */
+#define dowLoopImpd_Ctrl_Sweep               0x36   /* 启动多频点扫频 */
+#define dowLoopImpd_Set_Excitation           0x37   /* 设置激励频率和幅值 */
+#define dowLoopImpd_Set_EventCfg             0x38   /* 设置阻抗事件检测参数 */
+#define dowLoopImpd_Cal_Start                0x39   /* 开始自动校准 */
+#define dowLoopImpd_Cal_Point                0x3A   /* 校准：已接入参考电阻 */
+#define dowLoopImpd_Cal_Finish               0x3B   /* 校准：拟合/保存/放弃 */
+#define dowLoopImpd_Get_Profile              0x3C   /* 读取热点代码耗时统计 */
+#define dowLoopImpd_Get_SafetyLog            0x3D   /* 读取任务超期记录 */
+#define dowLoopImpd_Ctrl_RelayMeasure        0x3E   /* 切换继电器并返回建立后的读数 */
+#define dowLoopImpd_Get_AttachValue          0x3F   /* 读取贴附通道幅值和相位 */
+
+/*上行主动上报命令*/
+#define upLoopImpd_SweepResult               0x51   /* 扫频结果上报 */
+#define upLoopImpd_Event                     0x52   /* 阻抗事件上报 */
+#define upLoopImpd_CalPoint                  0x53   /* 校准点采集完成上报 */
 
 #define LOOP_MSG_BUF_LEN    (OPERATE_LOOP_FRAME_MAX_LEN - OPERATE_LOOP_FRAME_MIN_LEN)
+#define LOOP_TX_BUF_LEN     (OPERATE_LOOP_TX_FRAME_MAX_LEN - OPERATE_LOOP_FRAME_MIN_LEN)
 /*------------------------------ typedef definition --------------------------*/
 typedef struct
 {
@@ -67,7 +86,10 @@ void operate_loop_send_string(uint8_t id,uint8_t *pData,uint16_t length);
 void operate_loop_send_byte(uint8_t id,uint8_t data);
 void operate_loop_send_cmd(uint8_t id);
 size_t operate_loop_get_msg_len(void);
+size_t operate_loop_get_rx_len(void);
 size_t operate_loop_get_msg(loop_msg_t *msg);
+const loop_msg_t *operate_loop_peek_msg(void);
+void operate_loop_release_msg(void);
 
 /******************************* End Of File **********************************/
 
@@ -1,15 +1,17 @@
 /**
   ******************************************************************************
   * @copyright: Copyright To Hangzhou Dinova EP Technology Co.,Ltd
-  * @file     : xx.c
+  * @file     : safety.c
   * @author   : ZJY
   * @version  : V1.0
-  * @date     : 20xx-xx-xx
-  * @brief    : xxx
-  *                  1.xx
-  *                  2.xx
+  * @date     : 2026-10-18
+  * @brief    : 任务截止期监视与独立看门狗
+  *                  1.任务在开始运行时报到，safety_task 检查各任务距上次报到是否超过截止期
+  *                  2.有任务超期时停止喂狗，超期恢复前看门狗到时即复位
+  *                  3.超期记录放在 NOINIT_RAM_ADDR，启动代码不清零，复位后保留；
+  *                    看门狗复位时按 SysTick 记下的最后节拍补记当时已超期的任务
   *
-  * @attention: None
+  * @attention: 上电/掉电复位后 RAM 内容不可信，记录重新初始化
   ******************************************************************************
   * @history  : 
   *      V1.0 : 1.xxx
@@ -20,28 +22,225 @@
   */
 /*------------------------------ include --------------------------------------*/
 #include "safety.h"
+#include "board.h"
+#include "prof.h"
+#include <errno.h>
+#include <string.h>
 
-/*------------------------------ Macro definition -----------------------------*/
+#define  LOG_TAG             "safety"
+#define  LOG_LVL             4
+#include "log.h"
 
+/*------------------------------ Macro definition -----------------------------*/
+#define SAFETY_MAGIC                (0x53414645UL)  /* "SAFE" */
+#define SAFETY_LSI_MAX_HZ           (60000UL)       /* F1 的 LSI 为 30 ~ 60kHz，按最快计算重载值 */
+#define SAFETY_IWDG_DIV             (64UL)
 
 /*------------------------------ typedef definition ---------------------------*/
-
+/* 保存在不初始化 RAM 中的监视状态 */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t resets;                        /**< 看门狗复位次数 */
+    uint32_t total;                         /**< 累计超期次数 */
+    uint32_t last_tick;                     /**< SysTick 更新的最后节拍 */
+    uint32_t checkin[SAFETY_TASK_MAX];      /**< 各任务最后报到节拍 */
+    uint16_t deadline[SAFETY_TASK_MAX];
+    uint8_t task_num;
+    uint8_t head;                           /**< 下一条记录位置 */
+    uint8_t count;
+    uint8_t reserved;
+    safety_miss_t miss[SAFETY_MISS_MAX];
+} safety_noinit_t;
 
 /*------------------------------ variables prototypes -------------------------*/
-
+static safety_noinit_t *const safety_log = (safety_noinit_t *)NOINIT_RAM_ADDR;
+static const char *safety_names[SAFETY_TASK_MAX];
+static uint8_t safety_missed;               /* 已记录、尚未恢复的任务位图 */
+static uint8_t safety_task_num;
+static IWDG_HandleTypeDef hiwdg;
 
 /*------------------------------ function prototypes --------------------------*/
-
+static void safety_record(uint8_t task, uint8_t flags, uint32_t tick, uint32_t late, uint32_t cycles);
 
 /*------------------------------ application ----------------------------------*/
+/**
+  * @brief : 检查复位原因和保留的记录，启动独立看门狗
+  * @param : 
+  * @retval: 
+  */
 void safety_init(void)
 {
-//    led_blink();             // LED 开始闪烁
+    uint32_t csr = RCC->CSR;
+    uint32_t late;
+    uint8_t i;
+    
+    if (sizeof(safety_noinit_t) > NOINIT_RAM_SIZE)
+        LOG_E("noinit area too small!\r\n");
+    
+    if ((csr & RCC_CSR_PORRSTF) || safety_log->magic != SAFETY_MAGIC ||
+        safety_log->head >= SAFETY_MISS_MAX || safety_log->count > SAFETY_MISS_MAX ||
+        safety_log->task_num > SAFETY_TASK_MAX) {
+        memset(safety_log, 0, sizeof(*safety_log));
+        safety_log->magic = SAFETY_MAGIC;
+    } else if (csr & RCC_CSR_IWDGRSTF) {
+        safety_log->resets++;
+        for (i = 0; i < safety_log->task_num; i++) {
+            late = safety_log->last_tick - safety_log->checkin[i];
+            if (late > safety_log->deadline[i])
+                safety_record(i, SAFETY_MISS_RESET, safety_log->last_tick, late, 0);
+        }
+        LOG_W("watchdog reset #%u\r\n", (unsigned)safety_log->resets);
+    }
+    __HAL_RCC_CLEAR_RESET_FLAGS();
+    
+    if (safety_log->count)
+        LOG_W("%u deadline misses logged, %u resets\r\n",
+              (unsigned)safety_log->total, (unsigned)safety_log->resets);
+    
+    safety_log->task_num = 0;
+    safety_task_num = 0;
+    safety_missed = 0;
+    
+    __HAL_DBGMCU_FREEZE_IWDG();
+    hiwdg.Instance = IWDG;
+    hiwdg.Init.Prescaler = IWDG_PRESCALER_64;
+    hiwdg.Init.Reload = SAFETY_IWDG_TIMEOUT_MS * (SAFETY_LSI_MAX_HZ / 1000) / SAFETY_IWDG_DIV;
+    if (HAL_IWDG_Init(&hiwdg) != HAL_OK)
+        LOG_E("Failed to start watchdog\r\n");
 }
 
+/**
+  * @brief : 检查所有任务的截止期，全部按期时喂狗
+  * @param : 
+  * @retval: 
+  */
 void safety_task(void)
 {
+    uint32_t now = HAL_GetTick();
+    uint32_t late;
+    uint8_t ok = 1;
+    uint8_t i;
+    
+    for (i = 0; i < safety_task_num; i++) {
+        late = now - safety_log->checkin[i];
+        if (late <= safety_log->deadline[i])
+            continue;
+        ok = 0;
+        if (!(safety_missed & (1U << i))) {
+            safety_missed |= (uint8_t)(1U << i);
+#if USING_PROF
+            safety_record(i, 0, now, late, prof_now());
+#else
+            safety_record(i, 0, now, late, 0);
+#endif
+            LOG_W("task %s missed deadline %u ms by %u ms\r\n", safety_names[i],
+                  (unsigned)safety_log->deadline[i], (unsigned)(late - safety_log->deadline[i]));
+        }
+    }
+    
+    if (ok)
+        HAL_IWDG_Refresh(&hiwdg);
+}
+
+/**
+  * @brief : 登记周期任务
+  * @param : deadline_ms 两次报到的最大间隔
+  * @retval: 任务号，-ENOSPC 已满
+  */
+int safety_register(const char *name, uint16_t deadline_ms)
+{
+    uint8_t id;
+    
+    if (safety_task_num >= SAFETY_TASK_MAX)
+        return -ENOSPC;
+    
+    id = safety_task_num++;
+    safety_names[id] = name;
+    safety_log->deadline[id] = deadline_ms;
+    safety_log->checkin[id] = HAL_GetTick();
+    safety_log->task_num = safety_task_num;
+    
+    return id;
+}
+
+/**
+  * @brief : 任务报到，在任务开始运行时调用
+  * @param : id safety_register 返回的任务号
+  * @retval: 
+  */
+void safety_checkin(int id)
+{
+    if (id < 0 || id >= safety_task_num)
+        return;
+    
+    safety_log->checkin[id] = HAL_GetTick();
+    safety_missed &= (uint8_t)~(1U << id);
+}
+
+/**
+  * @brief : 在 SysTick 中断中调用，保存最后节拍供看门狗复位后判断哪些任务已超期
+  * @param : 
+  * @retval: 
+  */
+void safety_tick(uint32_t tick)
+{
+    safety_log->last_tick = tick;
+}
+
+uint32_t safety_get_resets(void)
+{
+    return safety_log->resets;
+}
+
+/**
+  * @brief : 按时间先后读取超期记录
+  * @param : max miss 可容纳的条数
+  * @retval: 读出的条数
+  */
+uint8_t safety_get_misses(safety_miss_t *miss, uint8_t max)
+{
+    uint8_t start = (uint8_t)((safety_log->head + SAFETY_MISS_MAX - safety_log->count) % SAFETY_MISS_MAX);
+    uint8_t i;
+    
+    for (i = 0; i < safety_log->count && i < max; i++)
+        miss[i] = safety_log->miss[(start + i) % SAFETY_MISS_MAX];
+    
+    return i;
+}
+
+const char *safety_task_name(uint8_t id)
+{
+    return (id < safety_task_num) ? safety_names[id] : "";
+}
+
+/**
+  * @brief : 清除超期记录和复位计数
+  * @param : 
+  * @retval: 
+  */
+void safety_clear(void)
+{
+    safety_log->resets = 0;
+    safety_log->total = 0;
+    safety_log->head = 0;
+    safety_log->count = 0;
+}
+
+static void safety_record(uint8_t task, uint8_t flags, uint32_t tick, uint32_t late, uint32_t cycles)
+{
+    safety_miss_t *m = &safety_log->miss[safety_log->head];
     
+    m->task = task;
+    m->flags = flags;
+    m->deadline = safety_log->deadline[task];
+    m->tick = tick;
+    m->late = late;
+    m->cycles = cycles;
+    safety_log->head = (uint8_t)((safety_log->head + 1) % SAFETY_MISS_MAX);
+    if (safety_log->count < SAFETY_MISS_MAX)
+        safety_log->count++;
+    safety_log->total++;
 }
 
 /******************************* End Of File ************************************/
@@ -1,13 +1,14 @@
 /**
   ******************************************************************************
   * @copyright: Copyright To Hangzhou Dinova EP Technology Co.,Ltd
-  * @file     : xx.h
+  * @file     : safety.h
   * @author   : ZJY
   * @version  : V1.0
-  * @date     : 20xx-xx-xx
-  * @brief    : xxx
-  *                   1.xx
-  *                   2.xx
+  * @date     : 2026-10-18
+  * @brief    : 任务截止期监视与独立看门狗
+  *                   1.各周期任务登记截止期并定期报到
+  *                   2.全部任务按期报到时才喂狗
+  *                   3.超期记录保存在不初始化的 RAM 中，复位后仍可读取
   *
   * @attention: None
   ******************************************************************************
@@ -19,13 +20,25 @@
   ******************************************************************************
   */
 /*------------------------------ include -------------------------------------*/
-
+#include <stdint.h>
 
 /*------------------------------ Macro definition ----------------------------*/
+#define SAFETY_TASK_MAX             (8)
+#define SAFETY_MISS_MAX             (8)     /* 超期记录条数，循环覆盖 */
+#define SAFETY_IWDG_TIMEOUT_MS      (500)   /* LSI 最快时的超时，须大于截止期加一次 flash 页擦写 */
 
+#define SAFETY_MISS_RESET           (0x01)  /* 该记录在看门狗复位后补记 */
 
 /*------------------------------ typedef definition --------------------------*/
-
+typedef struct
+{
+    uint8_t task;                   /**< 任务号 */
+    uint8_t flags;
+    uint16_t deadline;              /**< 截止期 (ms) */
+    uint32_t tick;                  /**< 发现超期时的 HAL 节拍 */
+    uint32_t late;                  /**< 距上次报到的时间 (ms) */
+    uint32_t cycles;                /**< 发现超期时的 DWT 周期计数 */
+} safety_miss_t;
 
 /*------------------------------ variable declarations -----------------------*/
 
@@ -33,6 +46,12 @@
 /*------------------------------ function declarations -----------------------*/
 void safety_init(void);
 void safety_task(void);
+int safety_register(const char *name, uint16_t deadline_ms);
+void safety_checkin(int id);
+void safety_tick(uint32_t tick);
+uint32_t safety_get_resets(void);
+uint8_t safety_get_misses(safety_miss_t *miss, uint8_t max);
+const char *safety_task_name(uint8_t id);
+void safety_clear(void);
 
 /******************************* End Of File **********************************/
-
@@ -0,0 +1,82 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : dlog.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 延迟格式化的二进制日志
+  * @attention   : 记录以 SKIP 模式整条写入 RTT 通道，通道剩余空间不足时整条丢弃并计数，
+  *                不会阻塞调用者，也不会留下半条记录。缓冲区大小和记录长度都是 4 的倍数
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.xxx
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "dlog.h"
+
+#if USING_DLOG
+#include "SEGGER_RTT.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static uint32_t dlog_buf[DLOG_BUF_SIZE / sizeof(uint32_t)];
+static uint32_t (*dlog_get_tick)(void);
+static uint8_t dlog_ready;
+static volatile uint32_t dlog_dropped;
+
+/* Exported variables  -------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+
+/* Exported functions --------------------------------------------------------*/
+/**
+ * @brief  配置 RTT 通道，需在 SEGGER_RTT_Init 之后调用
+ * @param  get_tick 时刻来源 (ms)，如 HAL_GetTick
+ */
+void dlog_init(uint32_t (*get_tick)(void))
+{
+    dlog_get_tick = get_tick;
+    dlog_dropped = 0;
+    SEGGER_RTT_ConfigUpBuffer(DLOG_RTT_CHANNEL, "DLOG", dlog_buf, sizeof(dlog_buf),
+                              SEGGER_RTT_MODE_NO_BLOCK_SKIP);
+    dlog_ready = 1;
+}
+
+/**
+ * @brief  填写时刻并写入一条记录，由 DLOG_D 调用
+ * @param  rec   记录，rec[1] 处写入时刻
+ * @param  words 记录长度 (字)
+ */
+void dlog_write(uint32_t *rec, uint32_t words)
+{
+    unsigned n;
+
+    if (!dlog_ready)
+        return;
+
+    rec[1] = dlog_get_tick();
+    SEGGER_RTT_LOCK();
+    n = SEGGER_RTT_WriteSkipNoLock(DLOG_RTT_CHANNEL, rec, words * sizeof(uint32_t));
+    SEGGER_RTT_UNLOCK();
+    if (n == 0)
+        dlog_dropped++;
+}
+
+/**
+ * @brief  通道满丢弃的记录数
+ */
+uint32_t dlog_get_dropped(void)
+{
+    return dlog_dropped;
+}
+
+#endif /* USING_DLOG */
+
+/******************************* End Of File ************************************/
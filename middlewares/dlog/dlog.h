@@ -0,0 +1,92 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : dlog.h
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 延迟格式化的二进制日志
+  * @attention   : DLOG_D 在调用处不做格式化，只写一条记录到 RTT 通道 DLOG_RTT_CHANNEL：
+  *                    [0] 参数个数 (高 4 位) | 格式串地址 (低 28 位)
+  *                    [1] 时刻 (ms)
+  *                    [2..] 参数，每个 32 位
+  *                格式串 (前缀 LOG_TAG) 放在 .dlog_fmt 段中，由 tools/dlog_decode.py
+  *                从 .axf 提取并还原文本。
+  *                限制：参数最多 DLOG_ARGS_MAX 个，按 32 位整数记录；%s 只能指向 flash
+  *                中的常量字符串，浮点数先换算为整数。
+  *                USING_DLOG 为 0 时 DLOG_D 等同 LOG_D
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.xxx
+  ******************************************************************************
+  */
+#ifndef __DLOG_H__
+#define __DLOG_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "sys_config.h"
+
+/* Exported define -----------------------------------------------------------*/
+#define DLOG_RTT_CHANNEL                (1)
+#define DLOG_BUF_SIZE                   (1024)
+#define DLOG_ARGS_MAX                   (8)
+#define DLOG_LVL_DBG                    (4)     /* 与 LOG_LVL 比较，同 LOG_D */
+#define DLOG_ADDR_MASK                  (0x0FFFFFFFUL)
+
+/* Exported typedef ----------------------------------------------------------*/
+
+/* Exported macro ------------------------------------------------------------*/
+#define DLOG_ARG(x)                     ((uint32_t)(uintptr_t)(x))
+
+#define DLOG_NARGS_(_0, _1, _2, _3, _4, _5, _6, _7, _8, n, ...) n
+#define DLOG_NARGS(...)                 DLOG_NARGS_(0, ##__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+
+#define DLOG_MAP_0()
+#define DLOG_MAP_1(a)                   DLOG_ARG(a)
+#define DLOG_MAP_2(a, ...)              DLOG_ARG(a), DLOG_MAP_1(__VA_ARGS__)
+#define DLOG_MAP_3(a, ...)              DLOG_ARG(a), DLOG_MAP_2(__VA_ARGS__)
+#define DLOG_MAP_4(a, ...)              DLOG_ARG(a), DLOG_MAP_3(__VA_ARGS__)
+#define DLOG_MAP_5(a, ...)              DLOG_ARG(a), DLOG_MAP_4(__VA_ARGS__)
+#define DLOG_MAP_6(a, ...)              DLOG_ARG(a), DLOG_MAP_5(__VA_ARGS__)
+#define DLOG_MAP_7(a, ...)              DLOG_ARG(a), DLOG_MAP_6(__VA_ARGS__)
+#define DLOG_MAP_8(a, ...)              DLOG_ARG(a), DLOG_MAP_7(__VA_ARGS__)
+#define DLOG_CAT_(a, b)                 a##b
+#define DLOG_CAT(a, b)                  DLOG_CAT_(a, b)
+#define DLOG_ARGS(...)                  DLOG_CAT(DLOG_MAP_, DLOG_NARGS(__VA_ARGS__))(__VA_ARGS__)
+
+#if USING_DLOG
+/**
+ * @brief 记录在栈上组装，时刻由 dlog_write 填写
+ */
+#define DLOG_D(fmt, ...)                                                                \
+    do {                                                                                \
+        if (LOG_LVL >= DLOG_LVL_DBG && LOG_GLOBAL_LVL >= DLOG_LVL_DBG) {                \
+            static const char dlog_fmt_[]                                               \
+                __attribute__((section(".dlog_fmt"), used)) = "[" LOG_TAG "] " fmt;     \
+            uint32_t dlog_rec_[] = {                                                    \
+                ((uint32_t)DLOG_NARGS(__VA_ARGS__) << 28) | (DLOG_ARG(dlog_fmt_) & DLOG_ADDR_MASK), \
+                0, DLOG_ARGS(__VA_ARGS__) };                                            \
+            dlog_write(dlog_rec_, sizeof(dlog_rec_) / sizeof(uint32_t));               \
+        }                                                                               \
+    } while (0)
+#else
+#define DLOG_D(...)                     LOG_D(__VA_ARGS__)
+#endif
+
+/* Exported variable prototypes ----------------------------------------------*/
+
+/* Exported function prototypes ----------------------------------------------*/
+void dlog_init(uint32_t (*get_tick)(void));
+void dlog_write(uint32_t *rec, uint32_t words);
+uint32_t dlog_get_dropped(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __DLOG_H__ */
@@ -0,0 +1,246 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : dsp_math.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 定点数学基础函数 (查表正弦、整数开方、CORDIC)
+  * @attention   : None
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.xxx
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "dsp_math.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+#define SIN_TAB_BITS            (8)             /* 四分之一周期表 256 段 */
+#define CORDIC_ITER             (24)
+#define CORDIC_GAIN_INV_Q31     (1304065748L)   /* 1 / 1.64676 */
+#define CORDIC_GAIN_INV_Q30     (CORDIC_GAIN_INV_Q31 >> 1)
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+/* sin(0 ~ π/2)，Q15，含端点共 257 项 */
+static const int16_t sin_tab[(1 << SIN_TAB_BITS) + 1] = {
+        0,   201,   402,   603,   804,  1005,  1206,  1407,
+     1608,  1809,  2009,  2210,  2410,  2611,  2811,  3012,
+     3212,  3412,  3612,  3811,  4011,  4210,  4410,  4609,
+     4808,  5007,  5205,  5404,  5602,  5800,  5998,  6195,
+     6393,  6590,  6786,  6983,  7179,  7375,  7571,  7767,
+     7962,  8157,  8351,  8545,  8739,  8933,  9126,  9319,
+     9512,  9704,  9896, 10087, 10278, 10469, 10659, 10849,
+    11039, 11228, 11417, 11605, 11793, 11980, 12167, 12353,
+    12539, 12725, 12910, 13094, 13279, 13462, 13645, 13828,
+    14010, 14191, 14372, 14553, 14732, 14912, 15090, 15269,
+    15446, 15623, 15800, 15976, 16151, 16325, 16499, 16673,
+    16846, 17018, 17189, 17360, 17530, 17700, 17869, 18037,
+    18204, 18371, 18537, 18703, 18868, 19032, 19195, 19357,
+    19519, 19680, 19841, 20000, 20159, 20317, 20475, 20631,
+    20787, 20942, 21096, 21250, 21403, 21554, 21705, 21856,
+    22005, 22154, 22301, 22448, 22594, 22739, 22884, 23027,
+    23170, 23311, 23452, 23592, 23731, 23870, 24007, 24143,
+    24279, 24413, 24547, 24680, 24811, 24942, 25072, 25201,
+    25329, 25456, 25582, 25708, 25832, 25955, 26077, 26198,
+    26319, 26438, 26556, 26674, 26790, 26905, 27019, 27133,
+    27245, 27356, 27466, 27575, 27683, 27790, 27896, 28001,
+    28105, 28208, 28310, 28411, 28510, 28609, 28706, 28803,
+    28898, 28992, 29085, 29177, 29268, 29358, 29447, 29534,
+    29621, 29706, 29791, 29874, 29956, 30037, 30117, 30195,
+    30273, 30349, 30424, 30498, 30571, 30643, 30714, 30783,
+    30852, 30919, 30985, 31050, 31113, 31176, 31237, 31297,
+    31356, 31414, 31470, 31526, 31580, 31633, 31685, 31736,
+    31785, 31833, 31880, 31926, 31971, 32014, 32057, 32098,
+    32137, 32176, 32213, 32250, 32285, 32318, 32351, 32382,
+    32412, 32441, 32469, 32495, 32521, 32545, 32567, 32589,
+    32609, 32628, 32646, 32663, 32678, 32692, 32705, 32717,
+    32728, 32737, 32745, 32752, 32757, 32761, 32765, 32766,
+    32767,
+};
+
+/* atan(2^-i) / π，Q31 */
+static const int32_t cordic_atan_tab[CORDIC_ITER] = {
+    536870912,
+    316933406,
+    167458907,
+    85004756,
+    42667331,
+    21354465,
+    10679838,
+    5340245,
+    2670163,
+    1335087,
+    667544,
+    333772,
+    166886,
+    83443,
+    41722,
+    20861,
+    10430,
+    5215,
+    2608,
+    1304,
+    652,
+    326,
+    163,
+    81,
+};
+
+/* Exported variables  -------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+
+/* Exported functions --------------------------------------------------------*/
+/**
+ * @brief  查表加线性插值计算正弦
+ * @param  phase 二进制角度，2^32 对应 2π
+ * @retval sin(phase)，Q15
+ */
+int16_t dsp_sin_q15(uint32_t phase)
+{
+    uint32_t quad = phase >> 30;
+    uint32_t idx  = (phase >> (30 - SIN_TAB_BITS)) & ((1 << SIN_TAB_BITS) - 1);
+    int32_t  frac = (phase >> (14 - SIN_TAB_BITS)) & 0xFFFF;
+    int32_t  a, b, v;
+    
+    if (quad & 1) {
+        /* 第二、四象限镜像查表 */
+        idx  = (1 << SIN_TAB_BITS) - idx;
+        a    = sin_tab[idx];
+        b    = sin_tab[idx - 1];
+    } else {
+        a    = sin_tab[idx];
+        b    = sin_tab[idx + 1];
+    }
+    v = a + (((b - a) * frac) >> 16);
+    
+    return (int16_t)((quad & 2) ? -v : v);
+}
+
+/**
+ * @brief  cos(phase)，Q15
+ */
+int16_t dsp_cos_q15(uint32_t phase)
+{
+    return dsp_sin_q15(phase + DSP_PHASE_90);
+}
+
+/**
+ * @brief  64 位整数开方 (向下取整)
+ */
+uint32_t dsp_sqrt_u64(uint64_t x)
+{
+    uint64_t res = 0;
+    uint64_t bit = 1ULL << 62;
+    
+    while (bit > x)
+        bit >>= 2;
+    
+    while (bit) {
+        if (x >= res + bit) {
+            x -= res + bit;
+            res = (res >> 1) + bit;
+        } else {
+            res >>= 1;
+        }
+        bit >>= 2;
+    }
+    
+    return (uint32_t)res;
+}
+
+/**
+ * @brief  CORDIC 向量模式，求 (x, y) 的模和角度
+ * @param  x     实部
+ * @param  y     虚部
+ * @param  mag   输出 sqrt(x^2 + y^2)，与输入同格式，可为 NULL
+ * @param  angle 输出 atan2(y, x)，Q31 格式的 π 倍数，可为 NULL
+ */
+void dsp_cordic_vector(int32_t x, int32_t y, uint32_t *mag, int32_t *angle)
+{
+    uint32_t z = 0;
+    int32_t  xn, i;
+    
+    /* 预留 2 位防止 CORDIC 增益溢出 */
+    x >>= 2;
+    y >>= 2;
+    
+    /* 旋转到右半平面 */
+    if (x < 0) {
+        xn = x;
+        if (y >= 0) {
+            x = y;
+            y = -xn;
+            z = DSP_PHASE_90;
+        } else {
+            x = -y;
+            y = xn;
+            z = (uint32_t)-DSP_PHASE_90;
+        }
+    }
+    
+    for (i = 0; i < CORDIC_ITER; i++) {
+        xn = x;
+        if (y > 0) {
+            x += y >> i;
+            y -= xn >> i;
+            z += (uint32_t)cordic_atan_tab[i];
+        } else {
+            x -= y >> i;
+            y += xn >> i;
+            z -= (uint32_t)cordic_atan_tab[i];
+        }
+    }
+    
+    if (mag)
+        *mag = (uint32_t)((((int64_t)x * CORDIC_GAIN_INV_Q31) >> 31) << 2);
+    if (angle)
+        *angle = (int32_t)z;
+}
+
+/**
+ * @brief  CORDIC 旋转模式，高精度计算 cos/sin (用于初始化阶段的系数计算)
+ * @param  phase   二进制角度，2^32 对应 2π
+ * @param  cos_q30 输出 cos(phase)，Q30，可为 NULL
+ * @param  sin_q30 输出 sin(phase)，Q30，可为 NULL
+ */
+void dsp_cordic_rotate(uint32_t phase, int32_t *cos_q30, int32_t *sin_q30)
+{
+    int32_t x = CORDIC_GAIN_INV_Q30;
+    int32_t y = 0;
+    int32_t z = (int32_t)phase;
+    int32_t xn, i, sign = 1;
+    
+    /* 折叠到 [-π/2, π/2]：cos 变号，sin 不变 */
+    if (z > (int32_t)DSP_PHASE_90 || z < -(int32_t)DSP_PHASE_90) {
+        z = (int32_t)(DSP_PHASE_180 - phase);
+        sign = -1;
+    }
+    
+    for (i = 0; i < CORDIC_ITER; i++) {
+        xn = x;
+        if (z >= 0) {
+            x -= y >> i;
+            y += xn >> i;
+            z -= cordic_atan_tab[i];
+        } else {
+            x += y >> i;
+            y -= xn >> i;
+            z += cordic_atan_tab[i];
+        }
+    }
+    
+    if (cos_q30)
+        *cos_q30 = sign * x;
+    if (sin_q30)
+        *sin_q30 = y;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/******************************* End Of File ************************************/
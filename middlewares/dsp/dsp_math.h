@@ -0,0 +1,51 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : dsp_math.h
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 定点数学基础函数 (查表正弦、整数开方、CORDIC)
+  * @attention   : 相位统一使用 32 位二进制角度：2^32 对应 2π，
+  *                按有符号数解释时即 Q31 格式的 π 倍数 (±2^31 对应 ±π)
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.xxx
+  ******************************************************************************
+  */
+#ifndef __DSP_MATH_H__
+#define __DSP_MATH_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sys_def.h"
+
+/* Exported define -----------------------------------------------------------*/
+#define DSP_PHASE_90            (0x40000000UL)  /**< π/2 对应的二进制角度 */
+#define DSP_PHASE_180           (0x80000000UL)  /**< π 对应的二进制角度 */
+
+/* Exported typedef ----------------------------------------------------------*/
+
+/* Exported macro ------------------------------------------------------------*/
+/**
+ * @brief 频率 freq 在采样率 fs 下对应的每样本相位增量
+ */
+#define DSP_PHASE_INC(freq, fs) ((uint32_t)(((uint64_t)(freq) << 32) / (fs)))
+
+/* Exported variable prototypes ----------------------------------------------*/
+
+/* Exported function prototypes ----------------------------------------------*/
+int16_t dsp_sin_q15(uint32_t phase);
+int16_t dsp_cos_q15(uint32_t phase);
+uint32_t dsp_sqrt_u64(uint64_t x);
+void dsp_cordic_vector(int32_t x, int32_t y, uint32_t *mag, int32_t *angle);
+void dsp_cordic_rotate(uint32_t phase, int32_t *cos_q30, int32_t *sin_q30);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __DSP_MATH_H__ */
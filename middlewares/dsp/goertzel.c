@@ -0,0 +1,188 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : goertzel.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 定点 Goertzel 单频点 DFT，支持多个频点同时检测
+  * @attention   : 递推 s[n] = x[n] + 2cos(w)·s[n-1] - s[n-2]，
+  *                每样本每频点一次 32x32->64 乘法
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.xxx
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "goertzel.h"
+#include "dsp_math.h"
+#include <string.h>
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+/* 幅值归一化：2|X| / N * 2^(31 - GOERTZEL_ADC_BITS) */
+#define GOERTZEL_NORM_SHIFT             (1 + 31 - GOERTZEL_ADC_BITS)
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Exported variables  -------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+static void goertzel_finish_window(goertzel_t *g);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+ * @brief  初始化检测器，初始无频点
+ * @param  g       检测器实例，on_result / user_data 由调用者在之后填写
+ * @param  win_len 窗口长度
+ * @retval 0 成功，-EINVAL 参数错误
+ */
+int goertzel_init(goertzel_t *g, uint16_t win_len)
+{
+    if (!g || win_len < 2 || win_len > GOERTZEL_WIN_MAX)
+        return -EINVAL;
+    
+    memset(g, 0, sizeof(*g));
+    g->win_len = win_len;
+    g->dc_offset = 1U << (GOERTZEL_ADC_BITS - 1);
+    
+    goertzel_reset(g);
+    
+    return 0;
+}
+
+/**
+ * @brief  配置检测频点并重新开始窗口
+ * @param  g         检测器实例
+ * @param  phase_inc 各频点的每样本相位增量，见 DSP_PHASE_INC()
+ * @param  nbins     频点数，不超过 GOERTZEL_BIN_MAX
+ * @retval 0 成功，-EINVAL 参数错误
+ */
+int goertzel_config(goertzel_t *g, const uint32_t *phase_inc, uint8_t nbins)
+{
+    uint8_t i;
+    
+    if (!g || (nbins && !phase_inc) || nbins > GOERTZEL_BIN_MAX)
+        return -EINVAL;
+    
+    for (i = 0; i < nbins; i++) {
+        g->bin[i].phase_inc = phase_inc[i];
+        dsp_cordic_rotate(phase_inc[i], &g->bin[i].cos_q30, &g->bin[i].sin_q30);
+    }
+    g->nbins = nbins;
+    
+    goertzel_reset(g);
+    
+    return 0;
+}
+
+/**
+ * @brief  丢弃当前窗口，下一个样本作为新窗口的起点
+ */
+void goertzel_reset(goertzel_t *g)
+{
+    uint8_t i;
+    
+    for (i = 0; i < g->nbins; i++) {
+        g->bin[i].s1 = 0;
+        g->bin[i].s2 = 0;
+    }
+    g->remain = g->win_len;
+}
+
+/**
+ * @brief  设置参考相位，对之后的样本有效，窗口中途设置不影响当前窗口
+ * @param  g     检测器实例
+ * @param  phase 下一个样本处的参考相位
+ * @param  inc   参考相位的每样本增量，phase、inc 均为 0 时不做参考
+ * @note   每个数据块前重新设置可避免增量误差的累积
+ */
+void goertzel_set_ref(goertzel_t *g, uint32_t phase, uint32_t inc)
+{
+    g->ref_phase = phase;
+    g->ref_inc = inc;
+}
+
+/**
+ * @brief  处理一个 ADC 数据块，每完成一个窗口调用一次 on_result
+ * @param  g       检测器实例
+ * @param  samples ADC 样本
+ * @param  n       样本数
+ */
+void goertzel_process(goertzel_t *g, const uint16_t *samples, size_t n)
+{
+    int32_t dc = g->dc_offset;
+    
+    if (g->nbins == 0)
+        return;
+    
+    while (n) {
+        size_t chunk = (n < g->remain) ? n : g->remain;
+        uint8_t b;
+        
+        if (g->remain == g->win_len)
+            g->win_ref = g->ref_phase;
+        g->ref_phase += g->ref_inc * chunk;
+        
+        /* 按频点外循环，状态留在寄存器中 */
+        for (b = 0; b < g->nbins; b++) {
+            goertzel_bin_t *bin = &g->bin[b];
+            const uint16_t *p = samples;
+            int32_t c  = bin->cos_q30;
+            int32_t s1 = bin->s1;
+            int32_t s2 = bin->s2;
+            size_t k;
+            
+            for (k = 0; k < chunk; k++) {
+                int32_t s0 = ((int32_t)*p++ - dc) + (int32_t)(((int64_t)c * s1) >> 29) - s2;
+                s2 = s1;
+                s1 = s0;
+            }
+            bin->s1 = s1;
+            bin->s2 = s2;
+        }
+        
+        samples += chunk;
+        n -= chunk;
+        g->remain -= chunk;
+        
+        if (g->remain == 0)
+            goertzel_finish_window(g);
+    }
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  窗口结束：求各频点幅值、相位，回调并清零状态
+ * @note   X(w) = e^{-jw(N-1)}·(s1 - e^{-jw}·s2)
+ */
+static void goertzel_finish_window(goertzel_t *g)
+{
+    uint8_t i;
+    
+    for (i = 0; i < g->nbins; i++) {
+        goertzel_bin_t *bin = &g->bin[i];
+        int32_t re = bin->s1 - (int32_t)(((int64_t)bin->cos_q30 * bin->s2) >> 30);
+        int32_t im = (int32_t)(((int64_t)bin->sin_q30 * bin->s2) >> 30);
+        uint32_t mag;
+        int32_t  angle;
+        
+        dsp_cordic_vector(re, im, &mag, &angle);
+        
+        g->result[i].mag_q31 = (uint32_t)(((uint64_t)mag << GOERTZEL_NORM_SHIFT) / g->win_len);
+        /* 以余弦为参考的 DFT 相位加 π/2，转换为以正弦为参考 */
+        g->result[i].phase = (int32_t)((uint32_t)angle - bin->phase_inc * (g->win_len - 1U) + DSP_PHASE_90 -
+                                       g->win_ref);
+    }
+    g->seq++;
+    
+    goertzel_reset(g);
+    
+    if (g->on_result)
+        g->on_result(g->result, g->nbins, g->user_data);
+}
+
+/******************************* End Of File ************************************/
@@ -0,0 +1,87 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : goertzel.h
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 定点 Goertzel 单频点 DFT，支持多个频点同时检测
+  * @attention   : 窗口长度不超过 GOERTZEL_WIN_MAX，以保证 32 位状态不溢出；
+  *                窗口取工频周期整数倍时可完全抑制工频干扰。
+  *                设置了参考相位时，结果相位减去窗口首样本处的参考相位，
+  *                频点与参考同频时即为相对参考 (激励) 的相位
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.xxx
+  ******************************************************************************
+  */
+#ifndef __GOERTZEL_H__
+#define __GOERTZEL_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sys_def.h"
+
+/* Exported define -----------------------------------------------------------*/
+#define GOERTZEL_BIN_MAX                (4)         /**< 最大同时检测频点数 */
+#define GOERTZEL_WIN_MAX                (1024)      /**< 最大窗口长度 */
+#define GOERTZEL_ADC_BITS               (12)        /**< 输入样本位宽 */
+
+/* Exported typedef ----------------------------------------------------------*/
+/**
+ * @brief 单个频点的检测结果
+ * @note  幅值为相对 ADC 满量程的 Q31 小数，相位以窗口起点的正弦为参考，
+ *        与 lockin_result_t 的约定一致；设置了参考相位时再减去窗口起点的参考相位
+ */
+typedef struct
+{
+    uint32_t mag_q31;       /**< 幅值 */
+    int32_t  phase;         /**< 相位，Q31 格式的 π 倍数 */
+} goertzel_result_t;
+
+typedef struct
+{
+    uint32_t phase_inc;     /**< 目标频率的每样本相位增量 */
+    int32_t  cos_q30;       /**< cos(w)，Q30 */
+    int32_t  sin_q30;       /**< sin(w)，Q30 */
+    int32_t  s1;            /**< 状态 s[n-1] */
+    int32_t  s2;            /**< 状态 s[n-2] */
+} goertzel_bin_t;
+
+typedef void (*goertzel_result_cb_t)(const goertzel_result_t *res, uint8_t nbins, void *user_data);
+
+typedef struct
+{
+    goertzel_bin_t bin[GOERTZEL_BIN_MAX];       /**< 频点 */
+    goertzel_result_t result[GOERTZEL_BIN_MAX]; /**< 最近一个窗口的结果 */
+    uint8_t  nbins;                             /**< 有效频点数 */
+    uint16_t win_len;                           /**< 窗口长度 (样本) */
+    uint16_t remain;                            /**< 当前窗口剩余样本数 */
+    uint16_t dc_offset;                         /**< 样本直流偏置 */
+    uint32_t seq;                               /**< 已完成窗口数 */
+    uint32_t ref_phase;                         /**< 下一个样本处的参考相位 */
+    uint32_t ref_inc;                           /**< 参考相位的每样本增量 */
+    uint32_t win_ref;                           /**< 当前窗口首样本处的参考相位 */
+    goertzel_result_cb_t on_result;             /**< 窗口结束回调 */
+    void *user_data;                            /**< 传递给回调函数的用户数据 */
+} goertzel_t;
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported variable prototypes ----------------------------------------------*/
+
+/* Exported function prototypes ----------------------------------------------*/
+int goertzel_init(goertzel_t *g, uint16_t win_len);
+int goertzel_config(goertzel_t *g, const uint32_t *phase_inc, uint8_t nbins);
+void goertzel_reset(goertzel_t *g);
+void goertzel_set_ref(goertzel_t *g, uint32_t phase, uint32_t inc);
+void goertzel_process(goertzel_t *g, const uint16_t *samples, size_t n);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __GOERTZEL_H__ */
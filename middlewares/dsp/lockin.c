@@ -0,0 +1,165 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : lockin.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 锁相 (同步 I/Q) 解调，用于交流阻抗幅值和相位测量
+  * @attention   : lockin_process 按 DMA 块调用，内循环每样本两次 64 位乘累加
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.xxx
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "lockin.h"
+#include "dsp_math.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+/* 2 / N * 2^(31 - 15 - LOCKIN_ADC_BITS) 中的移位部分 */
+#define LOCKIN_NORM_SHIFT               (1 + 31 - 15 - LOCKIN_ADC_BITS)
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Exported variables  -------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+static void lockin_finish_window(lockin_t *lk);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+ * @brief  生成参考正弦表
+ * @param  ref    输出缓冲区，长度 LOCKIN_REF_LEN(period)
+ * @param  period 每周期样本数，须为 4 的倍数
+ * @retval 0 成功，-EINVAL 参数错误
+ */
+int lockin_build_ref(int16_t *ref, uint16_t period)
+{
+    uint32_t step, phase = 0;
+    uint16_t i;
+    
+    if (!ref || period < 4 || (period & 3))
+        return -EINVAL;
+    
+    step = (uint32_t)(0x100000000ULL / period);
+    for (i = 0; i < LOCKIN_REF_LEN(period); i++) {
+        ref[i] = dsp_sin_q15(phase);
+        phase += step;
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief  初始化解调器
+ * @param  lk     解调器实例，on_result / user_data 由调用者在之后填写
+ * @param  ref    lockin_build_ref 生成的参考表，可与激励发生器共用
+ * @param  period 每周期样本数
+ * @param  cycles 每个积分窗口的周期数
+ * @retval 0 成功，-EINVAL 参数错误
+ */
+int lockin_init(lockin_t *lk, const int16_t *ref, uint16_t period, uint16_t cycles)
+{
+    if (!lk || !ref || period < 4 || (period & 3) || cycles == 0)
+        return -EINVAL;
+    
+    lk->ref = ref;
+    lk->period = period;
+    lk->cycles = cycles;
+    lk->dc_offset = LOCKIN_ADC_MID;
+    lk->on_result = NULL;
+    lk->user_data = NULL;
+    lk->seq = 0;
+    
+    lockin_reset(lk, 0);
+    
+    return 0;
+}
+
+/**
+ * @brief  丢弃当前窗口并重新对齐参考相位
+ * @param  lk      解调器实例
+ * @param  ref_idx 下一个样本对应的参考相位下标 (激励起始时为 0)
+ */
+void lockin_reset(lockin_t *lk, uint16_t ref_idx)
+{
+    lk->ref_idx = ref_idx % lk->period;
+    lk->remain = (uint32_t)lk->period * lk->cycles;
+    lk->acc_i = 0;
+    lk->acc_q = 0;
+}
+
+/**
+ * @brief  处理一个 ADC 数据块，每完成一个积分窗口调用一次 on_result
+ * @param  lk      解调器实例
+ * @param  samples ADC 样本
+ * @param  n       样本数
+ */
+void lockin_process(lockin_t *lk, const uint16_t *samples, size_t n)
+{
+    const int16_t *ref_cos = lk->ref + lk->period / 4;
+    int32_t dc = lk->dc_offset;
+    
+    while (n) {
+        /* 分段处理，段内参考下标不回绕、窗口不结束 */
+        uint32_t chunk = lk->period - lk->ref_idx;
+        uint32_t idx = lk->ref_idx;
+        int64_t acc_i = lk->acc_i;
+        int64_t acc_q = lk->acc_q;
+        
+        if (chunk > lk->remain)
+            chunk = lk->remain;
+        if (chunk > n)
+            chunk = n;
+        
+        n -= chunk;
+        lk->remain -= chunk;
+        lk->ref_idx += chunk;
+        
+        while (chunk--) {
+            int32_t x = (int32_t)*samples++ - dc;
+            acc_i += x * lk->ref[idx];
+            acc_q += x * ref_cos[idx];
+            idx++;
+        }
+        
+        lk->acc_i = acc_i;
+        lk->acc_q = acc_q;
+        
+        if (lk->ref_idx >= lk->period)
+            lk->ref_idx = 0;
+        if (lk->remain == 0)
+            lockin_finish_window(lk);
+    }
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  积分窗口结束：归一化、求模和相位、回调并清零累加器
+ */
+static void lockin_finish_window(lockin_t *lk)
+{
+    lockin_result_t res;
+    int64_t n = (int64_t)lk->period * lk->cycles;
+    
+    res.i_q31 = (int32_t)((lk->acc_i * (1 << LOCKIN_NORM_SHIFT)) / n);
+    res.q_q31 = (int32_t)((lk->acc_q * (1 << LOCKIN_NORM_SHIFT)) / n);
+    res.seq = lk->seq++;
+    
+    /* x = A·sin(θ + φ)：I = A·cosφ，Q = A·sinφ */
+    dsp_cordic_vector(res.i_q31, res.q_q31, &res.mag_q31, &res.phase);
+    
+    lk->remain = n;
+    lk->acc_i = 0;
+    lk->acc_q = 0;
+    
+    if (lk->on_result)
+        lk->on_result(&res, lk->user_data);
+}
+
+/******************************* End Of File ************************************/
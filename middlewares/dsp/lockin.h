@@ -0,0 +1,81 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : lockin.h
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 锁相 (同步 I/Q) 解调，用于交流阻抗幅值和相位测量
+  * @attention   : 采样率须为激励频率的整数倍 (每周期 period 个样本)，
+  *                积分窗口为整数个周期，直流分量在窗口内自然抵消
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.xxx
+  ******************************************************************************
+  */
+#ifndef __LOCKIN_H__
+#define __LOCKIN_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sys_def.h"
+
+/* Exported define -----------------------------------------------------------*/
+#define LOCKIN_ADC_BITS                 (12)        /**< 输入样本位宽 */
+#define LOCKIN_ADC_MID                  (1U << (LOCKIN_ADC_BITS - 1))
+
+/* Exported typedef ----------------------------------------------------------*/
+/**
+ * @brief 一个积分窗口的解调结果
+ * @note  i/q/mag 均为相对 ADC 满量程的 Q31 小数：幅值为 A 个码值的正弦
+ *        得到 mag_q31 = A / 2^LOCKIN_ADC_BITS
+ */
+typedef struct
+{
+    int32_t  i_q31;         /**< 同相分量 */
+    int32_t  q_q31;         /**< 正交分量 */
+    uint32_t mag_q31;       /**< 幅值 */
+    int32_t  phase;         /**< 相位，Q31 格式的 π 倍数 */
+    uint32_t seq;           /**< 窗口序号 */
+} lockin_result_t;
+
+typedef void (*lockin_result_cb_t)(const lockin_result_t *res, void *user_data);
+
+typedef struct
+{
+    const int16_t *ref;             /**< 参考正弦表，Q15，长度 LOCKIN_REF_LEN(period) */
+    uint16_t period;                /**< 每个激励周期的样本数，须为 4 的倍数 */
+    uint16_t cycles;                /**< 每个积分窗口的周期数 */
+    uint16_t dc_offset;             /**< 样本直流偏置，默认 ADC 中点 */
+    lockin_result_cb_t on_result;   /**< 窗口结束回调 */
+    void *user_data;                /**< 传递给回调函数的用户数据 */
+    
+    uint16_t ref_idx;               /**< 当前样本对应的参考相位下标 */
+    uint32_t remain;                /**< 当前窗口剩余样本数 */
+    int64_t  acc_i;                 /**< 同相累加器 */
+    int64_t  acc_q;                 /**< 正交累加器 */
+    uint32_t seq;                   /**< 已完成窗口数 */
+} lockin_t;
+
+/* Exported macro ------------------------------------------------------------*/
+/**
+ * @brief 参考表长度：1.25 个周期，余弦直接取 ref[idx + period / 4]，无需回绕
+ */
+#define LOCKIN_REF_LEN(period)          ((period) + (period) / 4)
+
+/* Exported variable prototypes ----------------------------------------------*/
+
+/* Exported function prototypes ----------------------------------------------*/
+int lockin_build_ref(int16_t *ref, uint16_t period);
+int lockin_init(lockin_t *lk, const int16_t *ref, uint16_t period, uint16_t cycles);
+void lockin_reset(lockin_t *lk, uint16_t ref_idx);
+void lockin_process(lockin_t *lk, const uint16_t *samples, size_t n);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __LOCKIN_H__ */
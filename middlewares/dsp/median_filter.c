@@ -0,0 +1,293 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : median_filter.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 滑动窗口中值滤波器
+  * @attention   : 用于替代每个窗口排序一次的中值平滑 (O(n log n) / 样本)
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.双堆中值滤波，插入/淘汰 O(log n)
+  *                2.12 位 ADC 直方图中值滤波，每样本常数时间
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "median_filter.h"
+#include <string.h>
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+
+/* Private macro -------------------------------------------------------------*/
+#define MIN_CT(mf)          (((mf)->count - 1) / 2)    /* 小顶堆元素数 */
+#define MAX_CT(mf)          ((mf)->count / 2)          /* 大顶堆元素数 */
+#define HEAP_VAL(mf, i)     ((mf)->data[(mf)->heap[i]])
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Exported variables  -------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+static int  heap_cmp_exch(median_filter_t *mf, int i, int j);
+static void min_sort_down(median_filter_t *mf, int i);
+static void max_sort_down(median_filter_t *mf, int i);
+static int  min_sort_up(median_filter_t *mf, int i);
+static int  max_sort_up(median_filter_t *mf, int i);
+static uint16_t hist_find_rank(const median_hist_t *mh, uint16_t rank);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+ * @brief  初始化双堆中值滤波器
+ * @param  mf   滤波器实例
+ * @param  data 窗口样本缓冲区，长度 size
+ * @param  pos  堆位置缓冲区，长度 size
+ * @param  heap 堆缓冲区，长度 size
+ * @param  size 窗口长度
+ * @retval 0 成功，-EINVAL 参数错误
+ */
+int median_filter_init(median_filter_t *mf, uint16_t *data, int16_t *pos,
+                       int16_t *heap, uint16_t size)
+{
+    if (!mf || !data || !pos || !heap || size == 0 || size > MEDIAN_FILTER_WIN_MAX)
+        return -EINVAL;
+    
+    mf->data = data;
+    mf->pos = pos;
+    mf->heap = heap + size / 2;
+    mf->size = size;
+    
+    median_filter_reset(mf);
+    
+    return 0;
+}
+
+/**
+ * @brief  清空窗口
+ * @note   样本位置交替分配到中值、大顶堆、小顶堆，保证插入过程中两堆平衡
+ */
+void median_filter_reset(median_filter_t *mf)
+{
+    int i;
+    
+    for (i = mf->size; i--; ) {
+        mf->pos[i] = ((i + 1) / 2) * ((i & 1) ? -1 : 1);
+        mf->heap[mf->pos[i]] = i;
+        mf->data[i] = 0;
+    }
+    mf->idx = 0;
+    mf->count = 0;
+}
+
+/**
+ * @brief  插入一个样本，窗口满时替换最旧的样本
+ * @param  mf 滤波器实例
+ * @param  v  新样本
+ * @retval 当前窗口中值 (偶数个样本时取中间两个的均值)
+ */
+uint16_t median_filter_insert(median_filter_t *mf, uint16_t v)
+{
+    int is_new = (mf->count < mf->size);
+    int p = mf->pos[mf->idx];
+    uint16_t old = mf->data[mf->idx];
+    
+    mf->data[mf->idx] = v;
+    if (++mf->idx >= mf->size)
+        mf->idx = 0;
+    mf->count += is_new;
+    
+    if (p > 0) {
+        /* 被替换的样本位于小顶堆 */
+        if (!is_new && old < v)
+            min_sort_down(mf, p * 2);
+        else if (min_sort_up(mf, p))
+            max_sort_down(mf, -1);
+    } else if (p < 0) {
+        /* 被替换的样本位于大顶堆 */
+        if (!is_new && v < old)
+            max_sort_down(mf, p * 2);
+        else if (max_sort_up(mf, p))
+            min_sort_down(mf, 1);
+    } else {
+        /* 被替换的样本就是中值 */
+        if (MAX_CT(mf))
+            max_sort_down(mf, -1);
+        if (MIN_CT(mf))
+            min_sort_down(mf, 1);
+    }
+    
+    return median_filter_get(mf);
+}
+
+/**
+ * @brief  读取当前窗口中值
+ */
+uint16_t median_filter_get(const median_filter_t *mf)
+{
+    uint32_t v;
+    
+    if (mf->count == 0)
+        return 0;
+    
+    v = HEAP_VAL(mf, 0);
+    if ((mf->count & 1) == 0)
+        v = (v + HEAP_VAL(mf, -1)) / 2;
+    
+    return (uint16_t)v;
+}
+
+/**
+ * @brief  初始化直方图中值滤波器
+ * @param  mh     滤波器实例
+ * @param  window 窗口样本缓冲区，长度 size
+ * @param  size   窗口长度，不超过 MEDIAN_HIST_WIN_MAX
+ * @retval 0 成功，-EINVAL 参数错误
+ */
+int median_hist_init(median_hist_t *mh, uint16_t *window, uint16_t size)
+{
+    if (!mh || !window || size == 0 || size > MEDIAN_HIST_WIN_MAX)
+        return -EINVAL;
+    
+    mh->window = window;
+    mh->size = size;
+    
+    median_hist_reset(mh);
+    
+    return 0;
+}
+
+void median_hist_reset(median_hist_t *mh)
+{
+    memset(mh->fine, 0, sizeof(mh->fine));
+    memset(mh->coarse, 0, sizeof(mh->coarse));
+    mh->idx = 0;
+    mh->count = 0;
+}
+
+/**
+ * @brief  插入一个样本，窗口满时淘汰最旧的样本
+ * @param  mh 滤波器实例
+ * @param  v  新样本，超出 MEDIAN_HIST_BITS 位的部分被截断
+ * @retval 当前窗口中值
+ */
+uint16_t median_hist_insert(median_hist_t *mh, uint16_t v)
+{
+    v &= (MEDIAN_HIST_BINS - 1);
+    
+    if (mh->count == mh->size) {
+        uint16_t old = mh->window[mh->idx];
+        mh->fine[old]--;
+        mh->coarse[old >> MEDIAN_HIST_COARSE_SHIFT]--;
+    } else {
+        mh->count++;
+    }
+    
+    mh->window[mh->idx] = v;
+    mh->fine[v]++;
+    mh->coarse[v >> MEDIAN_HIST_COARSE_SHIFT]++;
+    if (++mh->idx >= mh->size)
+        mh->idx = 0;
+    
+    return median_hist_get(mh);
+}
+
+/**
+ * @brief  读取当前窗口中值
+ */
+uint16_t median_hist_get(const median_hist_t *mh)
+{
+    uint32_t lo, hi;
+    
+    if (mh->count == 0)
+        return 0;
+    
+    lo = hist_find_rank(mh, (mh->count - 1) / 2);
+    if (mh->count & 1)
+        return (uint16_t)lo;
+    
+    hi = hist_find_rank(mh, mh->count / 2);
+    return (uint16_t)((lo + hi) / 2);
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  若 heap[i] < heap[j] 则交换两者
+ * @retval 1 发生交换，0 未交换
+ */
+static int heap_cmp_exch(median_filter_t *mf, int i, int j)
+{
+    int16_t t;
+    
+    if (!(HEAP_VAL(mf, i) < HEAP_VAL(mf, j)))
+        return 0;
+    
+    t = mf->heap[i];
+    mf->heap[i] = mf->heap[j];
+    mf->heap[j] = t;
+    mf->pos[mf->heap[i]] = i;
+    mf->pos[mf->heap[j]] = j;
+    
+    return 1;
+}
+
+/**
+ * @brief  从子节点 i 开始下沉 (i 为 1 时与中值比较)
+ */
+static void min_sort_down(median_filter_t *mf, int i)
+{
+    for (; i <= MIN_CT(mf); i *= 2) {
+        if (i > 1 && i < MIN_CT(mf) && HEAP_VAL(mf, i + 1) < HEAP_VAL(mf, i))
+            ++i;
+        if (!heap_cmp_exch(mf, i, i / 2))
+            break;
+    }
+}
+
+static void max_sort_down(median_filter_t *mf, int i)
+{
+    for (; i >= -MAX_CT(mf); i *= 2) {
+        if (i < -1 && i > -MAX_CT(mf) && HEAP_VAL(mf, i) < HEAP_VAL(mf, i - 1))
+            --i;
+        if (!heap_cmp_exch(mf, i / 2, i))
+            break;
+    }
+}
+
+/**
+ * @retval 1 样本上浮到了中值位置
+ */
+static int min_sort_up(median_filter_t *mf, int i)
+{
+    while (i > 0 && heap_cmp_exch(mf, i, i / 2))
+        i /= 2;
+    return (i == 0);
+}
+
+static int max_sort_up(median_filter_t *mf, int i)
+{
+    while (i < 0 && heap_cmp_exch(mf, i / 2, i))
+        i /= 2;
+    return (i == 0);
+}
+
+/**
+ * @brief  查找排序后第 rank 个样本 (从 0 开始) 的码值
+ */
+static uint16_t hist_find_rank(const median_hist_t *mh, uint16_t rank)
+{
+    uint32_t c = 0, f;
+    uint32_t acc = 0;
+    
+    while (acc + mh->coarse[c] <= rank)
+        acc += mh->coarse[c++];
+    
+    f = c << MEDIAN_HIST_COARSE_SHIFT;
+    while (acc + mh->fine[f] <= rank)
+        acc += mh->fine[f++];
+    
+    return (uint16_t)f;
+}
+
+/******************************* End Of File ************************************/
@@ -0,0 +1,97 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : median_filter.h
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 滑动窗口中值滤波器
+  * @attention   : None
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.双堆中值滤波，插入/淘汰 O(log n)
+  *                2.12 位 ADC 直方图中值滤波，每样本常数时间
+  ******************************************************************************
+  */
+#ifndef __MEDIAN_FILTER_H__
+#define __MEDIAN_FILTER_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sys_def.h"
+
+/* Exported define -----------------------------------------------------------*/
+#define MEDIAN_FILTER_WIN_MAX           (32767)     /**< 双堆窗口长度上限 */
+
+#define MEDIAN_HIST_BITS                (12)        /**< 直方图样本位宽 (ADC 分辨率) */
+#define MEDIAN_HIST_BINS                (1UL << MEDIAN_HIST_BITS)
+#define MEDIAN_HIST_COARSE_SHIFT        (6)         /**< 每个粗桶覆盖 64 个细桶 */
+#define MEDIAN_HIST_COARSE_BINS         (MEDIAN_HIST_BINS >> MEDIAN_HIST_COARSE_SHIFT)
+#define MEDIAN_HIST_WIN_MAX             (255)       /**< 计数为 8 位，窗口不超过 255 */
+
+/* Exported typedef ----------------------------------------------------------*/
+/**
+ * @brief 双堆中值滤波器
+ * @note  heap 指向堆数组中点：heap[0] 为中值，负下标为下半区大顶堆，
+ *        正下标为上半区小顶堆。所有存储由调用者静态提供。
+ */
+typedef struct
+{
+    uint16_t *data;         /**< 窗口样本环形缓冲区 */
+    int16_t  *pos;          /**< 每个样本在堆中的位置 */
+    int16_t  *heap;         /**< 堆数组中点，存放样本在 data 中的下标 */
+    uint16_t  size;         /**< 窗口长度 */
+    uint16_t  idx;          /**< 下一个被替换的样本下标 */
+    uint16_t  count;        /**< 当前样本数 */
+} median_filter_t;
+
+/**
+ * @brief 直方图中值滤波器 (仅用于 MEDIAN_HIST_BITS 位无符号样本)
+ * @note  两级直方图使得每次求中值最多扫描 粗桶数 + 64 个桶，与窗口长度无关。
+ */
+typedef struct
+{
+    uint16_t *window;                           /**< 窗口样本环形缓冲区 */
+    uint16_t  size;                             /**< 窗口长度 */
+    uint16_t  idx;                              /**< 下一个被替换的样本下标 */
+    uint16_t  count;                            /**< 当前样本数 */
+    uint8_t   fine[MEDIAN_HIST_BINS];           /**< 每个码值的计数 */
+    uint8_t   coarse[MEDIAN_HIST_COARSE_BINS];  /**< 每 64 个码值的计数和 */
+} median_hist_t;
+
+/* Exported macro ------------------------------------------------------------*/
+/**
+ * @brief 定义双堆中值滤波器的静态存储区，之后调用 MEDIAN_FILTER_INIT 初始化
+ */
+#define MEDIAN_FILTER_DEFINE(name, win)                                     \
+    static uint16_t name##_data[win];                                       \
+    static int16_t  name##_pos[win];                                        \
+    static int16_t  name##_heap[win];                                       \
+    static median_filter_t name
+
+#define MEDIAN_FILTER_INIT(name)                                            \
+    median_filter_init(&name, name##_data, name##_pos, name##_heap,         \
+                       sizeof(name##_data) / sizeof(name##_data[0]))
+
+/* Exported variable prototypes ----------------------------------------------*/
+
+/* Exported function prototypes ----------------------------------------------*/
+int median_filter_init(median_filter_t *mf, uint16_t *data, int16_t *pos,
+                       int16_t *heap, uint16_t size);
+void median_filter_reset(median_filter_t *mf);
+uint16_t median_filter_insert(median_filter_t *mf, uint16_t v);
+uint16_t median_filter_get(const median_filter_t *mf);
+
+int median_hist_init(median_hist_t *mh, uint16_t *window, uint16_t size);
+void median_hist_reset(median_hist_t *mh);
+uint16_t median_hist_insert(median_hist_t *mh, uint16_t v);
+uint16_t median_hist_get(const median_hist_t *mh);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __MEDIAN_FILTER_H__ */
@@ -0,0 +1,99 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : run_stats.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 增量统计：均值/方差 (Welford)、最小/最大值、指数滑动平均
+  * @attention   : Welford 递推避免了 sum(x^2) - sum(x)^2/n 在单精度下的抵消误差
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.xxx
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "run_stats.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Exported variables  -------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+
+/* Exported functions --------------------------------------------------------*/
+/**
+ * @brief  初始化统计器
+ * @param  rs    统计器实例
+ * @param  alpha EMA 系数，(0, 1]
+ * @retval 0 成功，-EINVAL 参数错误
+ */
+int run_stats_init(run_stats_t *rs, float alpha)
+{
+    if (!rs || !(alpha > 0.0f && alpha <= 1.0f))
+        return -EINVAL;
+    
+    rs->alpha = alpha;
+    run_stats_reset(rs);
+    
+    return 0;
+}
+
+/**
+ * @brief  清空统计结果，保留 EMA 系数
+ */
+void run_stats_reset(run_stats_t *rs)
+{
+    rs->count = 0;
+    rs->min = INT32_MAX;
+    rs->max = INT32_MIN;
+    rs->mean = 0.0f;
+    rs->m2 = 0.0f;
+    rs->ema = 0.0f;
+}
+
+/**
+ * @brief  加入一个样本
+ * @note   第一个样本直接作为 EMA 初值，避免从 0 开始的爬升过程
+ */
+void run_stats_update(run_stats_t *rs, int32_t x)
+{
+    float xf = (float)x;
+    float delta = xf - rs->mean;
+    
+    rs->count++;
+    rs->mean += delta / (float)rs->count;
+    rs->m2 += delta * (xf - rs->mean);
+    
+    if (x < rs->min)
+        rs->min = x;
+    if (x > rs->max)
+        rs->max = x;
+    
+    if (rs->count == 1)
+        rs->ema = xf;
+    else
+        rs->ema += rs->alpha * (xf - rs->ema);
+}
+
+/**
+ * @brief  样本方差 (n - 1 为分母)
+ * @retval 样本数不足 2 时返回 0
+ */
+float run_stats_var(const run_stats_t *rs)
+{
+    if (rs->count < 2)
+        return 0.0f;
+    
+    return rs->m2 / (float)(rs->count - 1);
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/******************************* End Of File ************************************/
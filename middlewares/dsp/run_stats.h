@@ -0,0 +1,53 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : run_stats.h
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 增量统计：均值/方差 (Welford)、最小/最大值、指数滑动平均
+  * @attention   : 每个样本更新 O(1)，不保存样本
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.xxx
+  ******************************************************************************
+  */
+#ifndef __RUN_STATS_H__
+#define __RUN_STATS_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sys_def.h"
+
+/* Exported define -----------------------------------------------------------*/
+
+/* Exported typedef ----------------------------------------------------------*/
+typedef struct
+{
+    uint32_t count;         /**< 样本数 */
+    int32_t  min;           /**< 最小值 */
+    int32_t  max;           /**< 最大值 */
+    float    mean;          /**< 均值 */
+    float    m2;            /**< 与均值之差的平方和 */
+    float    ema;           /**< 指数滑动平均 */
+    float    alpha;         /**< EMA 系数 (0, 1]，越大跟随越快 */
+} run_stats_t;
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported variable prototypes ----------------------------------------------*/
+
+/* Exported function prototypes ----------------------------------------------*/
+int run_stats_init(run_stats_t *rs, float alpha);
+void run_stats_reset(run_stats_t *rs);
+void run_stats_update(run_stats_t *rs, int32_t x);
+float run_stats_var(const run_stats_t *rs);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __RUN_STATS_H__ */
@@ -0,0 +1,228 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : mpsc_queue.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 多生产者单消费者有界事件队列
+  * @attention   : 单核 Cortex-M3 上中断与任务之间不存在乱序，DMB 用于保证
+  *                编译器和 DMA 等其他总线主设备看到的顺序
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.xxx
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "mpsc_queue.h"
+#include "sys_config.h"
+#include "prof.h"
+#include <errno.h>
+
+#if defined(__arm__) || defined(__CC_ARM) || defined(__ARMCC_VERSION)
+#include "board.h"
+#define MPSC_TARGET                     1
+#else
+#define MPSC_TARGET                     0
+#endif
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+#if MPSC_TARGET && !defined(USING_HW_ATOMIC)
+#define MPSC_USE_CAS                    0       /* 关中断临界区 */
+#else
+#define MPSC_USE_CAS                    1
+#endif
+
+/* Private macro -------------------------------------------------------------*/
+#if MPSC_TARGET
+#define MPSC_LOAD(p)                    (*(p))
+#define MPSC_LOAD_ACQUIRE(p)            mpsc_load_acquire(p)
+#define MPSC_STORE_RELEASE(p, v)        do { __DMB(); *(p) = (v); } while (0)
+#else
+#define MPSC_LOAD(p)                    __atomic_load_n((p), __ATOMIC_RELAXED)
+#define MPSC_LOAD_ACQUIRE(p)            __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define MPSC_STORE_RELEASE(p, v)        __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#endif
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Exported variables  -------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+#if MPSC_TARGET
+static inline uint32_t mpsc_load_acquire(volatile uint32_t *p)
+{
+    uint32_t v = *p;
+
+    __DMB();
+    return v;
+}
+#endif
+
+/* Exported functions --------------------------------------------------------*/
+/**
+ * @brief  初始化队列
+ * @param  slot 槽位数组，由调用者提供
+ * @param  size 槽位数，2 的幂且不小于 2
+ * @retval 0 成功，-EINVAL 参数错误
+ */
+int mpsc_init(mpsc_queue_t *q, mpsc_slot_t *slot, uint32_t size)
+{
+    uint32_t i;
+
+    if (!q || !slot || size < 2 || (size & (size - 1)) != 0)
+        return -EINVAL;
+
+    for (i = 0; i < size; i++)
+        slot[i].seq = i;
+    q->slot = slot;
+    q->mask = size - 1;
+    q->head = 0;
+    q->tail = 0;
+    q->dropped = 0;
+
+    return 0;
+}
+
+/**
+ * @brief  投递一个事件，可在任意优先级的中断中调用
+ * @retval 0 成功，-ENOSPC 队列满 (计入丢弃数)
+ */
+int mpsc_post(mpsc_queue_t *q, const mpsc_msg_t *msg)
+{
+    mpsc_slot_t *s;
+    uint32_t pos;
+    int ret = 0;
+    PROF_BEGIN(PROF_MPSC_POST);
+
+#if MPSC_USE_CAS
+    int32_t dif;
+
+    pos = MPSC_LOAD(&q->head);
+    for (;;) {
+        s = &q->slot[pos & q->mask];
+        dif = (int32_t)(MPSC_LOAD_ACQUIRE(&s->seq) - pos);
+        if (dif == 0) {
+            if (mpsc_cas(&q->head, pos, pos + 1))
+                break;
+            pos = MPSC_LOAD(&q->head);
+        } else if (dif < 0) {
+            /* 槽位仍未被消费者取走 */
+            ret = -ENOSPC;
+            break;
+        } else {
+            /* 其他生产者已占用该位置 */
+            pos = MPSC_LOAD(&q->head);
+        }
+    }
+    if (ret == 0) {
+        s->msg = *msg;
+        MPSC_STORE_RELEASE(&s->seq, pos + 1);
+    } else {
+        uint32_t n;
+
+        do {
+            n = MPSC_LOAD(&q->dropped);
+        } while (!mpsc_cas(&q->dropped, n, n + 1));
+    }
+#else
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    pos = q->head;
+    s = &q->slot[pos & q->mask];
+    if (s->seq != pos) {
+        q->dropped++;
+        ret = -ENOSPC;
+    } else {
+        s->msg = *msg;
+        s->seq = pos + 1;
+        q->head = pos + 1;
+    }
+    __set_PRIMASK(primask);
+#endif
+
+    PROF_END(PROF_MPSC_POST);
+    return ret;
+}
+
+/**
+ * @brief  取出最早的事件，只能在一个上下文中调用
+ * @retval 1 取到，0 队列空 (或最早的槽位尚未写完)
+ */
+int mpsc_take(mpsc_queue_t *q, mpsc_msg_t *msg)
+{
+    mpsc_slot_t *s = &q->slot[q->tail & q->mask];
+
+    if (MPSC_LOAD_ACQUIRE(&s->seq) != q->tail + 1)
+        return 0;
+
+    *msg = s->msg;
+    MPSC_STORE_RELEASE(&s->seq, q->tail + q->mask + 1);
+    q->tail++;
+
+    return 1;
+}
+
+/**
+ * @brief  已占用的槽位数 (含正在写入的)，仅供参考
+ */
+uint32_t mpsc_len(const mpsc_queue_t *q)
+{
+    return MPSC_LOAD(&q->head) - q->tail;
+}
+
+uint32_t mpsc_get_dropped(const mpsc_queue_t *q)
+{
+    return MPSC_LOAD(&q->dropped);
+}
+
+/**
+ * @brief  *p 等于 expect 时写入 desired
+ * @retval 1 写入成功，0 值已被修改
+ */
+int mpsc_cas(volatile uint32_t *p, uint32_t expect, uint32_t desired)
+{
+#if MPSC_TARGET && defined(USING_HW_ATOMIC)
+    do {
+        if (__LDREXW(p) != expect) {
+            __CLREX();
+            return 0;
+        }
+    } while (__STREXW(desired, p) != 0);
+    __DMB();
+
+    return 1;
+#elif MPSC_TARGET
+    uint32_t primask = __get_PRIMASK();
+    int ok;
+
+    __disable_irq();
+    ok = (*p == expect);
+    if (ok)
+        *p = desired;
+    __set_PRIMASK(primask);
+
+    return ok;
+#else
+    return __atomic_compare_exchange_n(p, &expect, desired, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+#endif
+}
+
+/**
+ * @brief  原子置位，返回置位前的值
+ */
+uint32_t mpsc_fetch_or(volatile uint32_t *p, uint32_t bits)
+{
+    uint32_t old;
+
+    do {
+        old = MPSC_LOAD(p);
+    } while (!mpsc_cas(p, old, old | bits));
+
+    return old;
+}
+
+/******************************* End Of File ************************************/
@@ -0,0 +1,76 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : mpsc_queue.h
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 多生产者单消费者有界事件队列
+  * @attention   : 多个中断 (及任务) 投递，主循环中单一消费者取出。每个槽位带序号：
+  *                生产者以比较交换 (CAS) 竞争写入位置，写完数据后发布槽位序号，
+  *                消费者按序号判断槽位是否已写完，整个过程不关中断。
+  *                CAS 实现按平台选择：
+  *                1. Cortex-M 且定义 USING_HW_ATOMIC：LDREX/STREX，
+  *                   中断打断时 STREX 失败并重试；
+  *                2. Cortex-M 未定义 USING_HW_ATOMIC：PRIMASK 关中断临界区，作为对照；
+  *                3. 主机：C11 内存模型的原子操作 (__atomic)，用于多线程压力测试。
+  *                生产者抢到位置后被更高优先级中断打断时，消费者在该槽位写完前
+  *                暂停取出，之后槽位中的事件仍按位置顺序取出
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.xxx
+  ******************************************************************************
+  */
+#ifndef __MPSC_QUEUE_H__
+#define __MPSC_QUEUE_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported define -----------------------------------------------------------*/
+
+/* Exported typedef ----------------------------------------------------------*/
+typedef struct
+{
+    uint16_t id;                        /**< 事件类型 */
+    uint16_t arg;
+    uint32_t data;
+} mpsc_msg_t;
+
+typedef struct
+{
+    volatile uint32_t seq;              /**< 等于位置时可写，等于位置 + 1 时可读 */
+    mpsc_msg_t msg;
+} mpsc_slot_t;
+
+typedef struct
+{
+    mpsc_slot_t *slot;
+    uint32_t mask;
+    volatile uint32_t head;             /**< 下一个写入位置，生产者竞争 */
+    uint32_t tail;                      /**< 下一个读出位置，仅消费者使用 */
+    volatile uint32_t dropped;          /**< 队列满丢弃的事件数 */
+} mpsc_queue_t;
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported variable prototypes ----------------------------------------------*/
+
+/* Exported function prototypes ----------------------------------------------*/
+int mpsc_init(mpsc_queue_t *q, mpsc_slot_t *slot, uint32_t size);
+int mpsc_post(mpsc_queue_t *q, const mpsc_msg_t *msg);
+int mpsc_take(mpsc_queue_t *q, mpsc_msg_t *msg);
+uint32_t mpsc_len(const mpsc_queue_t *q);
+uint32_t mpsc_get_dropped(const mpsc_queue_t *q);
+int mpsc_cas(volatile uint32_t *p, uint32_t expect, uint32_t desired);
+uint32_t mpsc_fetch_or(volatile uint32_t *p, uint32_t bits);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __MPSC_QUEUE_H__ */
@@ -0,0 +1,287 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : mtd_sim.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 主机端文件映射 MTD 模拟器
+  * @attention   : 提供 mtd_read/mtd_write/mtd_erase，调用者通过 mtd_sim_attach
+  *                把某个 mtd_info (如 stm32_flash_info) 映射到一个镜像文件。
+  *                镜像文件跨进程保留，可模拟重启；mtd_sim_cut_after 模拟掉电
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.xxx
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "mtd_sim.h"
+#include "mtd_core.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct
+{
+    struct mtd_info *mtd;
+    int fd;
+    uint8_t *mem;
+    mtd_sim_cfg_t cfg;
+    mtd_sim_stats_t stats;
+    int64_t cut_budget;                 /**< 剩余可编程字节，<0 表示不掉电 */
+    uint8_t dead;                       /**< 已掉电，后续操作全部失败 */
+    uint32_t erase_cnt[MTD_SIM_PAGE_MAX];
+} mtd_sim_dev_t;
+
+/* Private define ------------------------------------------------------------*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static mtd_sim_dev_t sim_dev[MTD_SIM_DEV_MAX];
+
+/* Exported variables  -------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+static mtd_sim_dev_t *sim_find(const struct mtd_info *mtd);
+static void sim_spend(mtd_sim_dev_t *dev, uint64_t ns);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+ * @brief  把 mtd 映射到镜像文件，文件不存在或大小不符时新建并全部置 0xFF
+ * @retval 0 成功，负值失败
+ */
+int mtd_sim_attach(struct mtd_info *mtd, const char *path, const mtd_sim_cfg_t *cfg)
+{
+    mtd_sim_dev_t *dev = sim_find(NULL);
+    struct stat st;
+    uint8_t fresh = 0;
+    
+    if (!mtd || !path || !cfg || !cfg->page_size || cfg->size % cfg->page_size ||
+        cfg->size / cfg->page_size > MTD_SIM_PAGE_MAX)
+        return -EINVAL;
+    if (sim_find(mtd))
+        return -EBUSY;
+    if (!dev)
+        return -ENOMEM;
+    
+    dev->fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (dev->fd < 0)
+        return -errno;
+    
+    if (fstat(dev->fd, &st) != 0 || (uint64_t)st.st_size != cfg->size) {
+        if (ftruncate(dev->fd, cfg->size) != 0) {
+            close(dev->fd);
+            return -errno;
+        }
+        fresh = 1;
+    }
+    
+    dev->mem = mmap(NULL, cfg->size, PROT_READ | PROT_WRITE, MAP_SHARED, dev->fd, 0);
+    if (dev->mem == MAP_FAILED) {
+        dev->mem = NULL;
+        close(dev->fd);
+        return -errno;
+    }
+    
+    if (fresh)
+        memset(dev->mem, 0xFF, cfg->size);
+    
+    dev->mtd = mtd;
+    dev->cfg = *cfg;
+    dev->cut_budget = -1;
+    dev->dead = 0;
+    memset(&dev->stats, 0, sizeof(dev->stats));
+    memset(dev->erase_cnt, 0, sizeof(dev->erase_cnt));
+    
+    return 0;
+}
+
+/**
+ * @brief  解除映射，镜像内容写回文件
+ */
+void mtd_sim_detach(struct mtd_info *mtd)
+{
+    mtd_sim_dev_t *dev = sim_find(mtd);
+    
+    if (!dev)
+        return;
+    
+    msync(dev->mem, dev->cfg.size, MS_SYNC);
+    munmap(dev->mem, dev->cfg.size);
+    close(dev->fd);
+    memset(dev, 0, sizeof(*dev));
+}
+
+/**
+ * @brief  再编程 bytes 字节后模拟掉电：之后的写和擦除都失败，
+ *         被打断的擦除只清除页的前一部分；bytes < 0 取消，并恢复供电
+ */
+void mtd_sim_cut_after(struct mtd_info *mtd, int64_t bytes)
+{
+    mtd_sim_dev_t *dev = sim_find(mtd);
+    
+    if (!dev)
+        return;
+    
+    dev->cut_budget = bytes;
+    dev->dead = 0;
+}
+
+void mtd_sim_get_stats(struct mtd_info *mtd, mtd_sim_stats_t *stats)
+{
+    mtd_sim_dev_t *dev = sim_find(mtd);
+    
+    if (dev && stats)
+        *stats = dev->stats;
+}
+
+uint32_t mtd_sim_get_erase_count(struct mtd_info *mtd, uint32_t page)
+{
+    mtd_sim_dev_t *dev = sim_find(mtd);
+    
+    if (!dev || page >= dev->cfg.size / dev->cfg.page_size)
+        return 0;
+    
+    return dev->erase_cnt[page];
+}
+
+void mtd_sim_reset_stats(struct mtd_info *mtd)
+{
+    mtd_sim_dev_t *dev = sim_find(mtd);
+    
+    if (!dev)
+        return;
+    
+    memset(&dev->stats, 0, sizeof(dev->stats));
+    memset(dev->erase_cnt, 0, sizeof(dev->erase_cnt));
+}
+
+int mtd_read(struct mtd_info *mtd, uint32_t from, size_t len, size_t *retlen, uint8_t *buf)
+{
+    mtd_sim_dev_t *dev = sim_find(mtd);
+    
+    *retlen = 0;
+    if (!dev)
+        return -ENODEV;
+    if (from > dev->cfg.size || len > dev->cfg.size - from)
+        return -EINVAL;
+    
+    memcpy(buf, &dev->mem[from], len);
+    *retlen = len;
+    dev->stats.read_bytes += len;
+    sim_spend(dev, (uint64_t)len * dev->cfg.read_ns_per_byte);
+    
+    return 0;
+}
+
+int mtd_write(struct mtd_info *mtd, uint32_t to, size_t len, size_t *retlen, const uint8_t *buf)
+{
+    mtd_sim_dev_t *dev = sim_find(mtd);
+    uint32_t unit;
+    size_t i;
+    
+    *retlen = 0;
+    if (!dev)
+        return -ENODEV;
+    if (to > dev->cfg.size || len > dev->cfg.size - to)
+        return -EINVAL;
+    unit = dev->cfg.write_size;
+    if (unit > 1 && (to % unit || len % unit))
+        return -EINVAL;
+    
+    for (i = 0; i < len; i++) {
+        uint8_t old = dev->mem[to + i];
+        
+        if (dev->dead)
+            return -EIO;
+        if (dev->cut_budget == 0) {
+            dev->dead = 1;
+            return -EIO;
+        }
+        if (dev->cut_budget > 0)
+            dev->cut_budget--;
+        
+        if ((old & buf[i]) != buf[i]) {
+            dev->stats.prog_violations++;
+            if (dev->cfg.strict)
+                return -EIO;
+        }
+        dev->mem[to + i] = old & buf[i];
+        *retlen = i + 1;
+        dev->stats.prog_bytes++;
+    }
+    
+    sim_spend(dev, (uint64_t)(unit > 1 ? len / unit : len) * dev->cfg.prog_ns_per_unit);
+    
+    return 0;
+}
+
+int mtd_erase(struct mtd_info *mtd, struct erase_info *instr)
+{
+    mtd_sim_dev_t *dev = sim_find(mtd);
+    uint32_t page_size;
+    uint32_t first, last, page;
+    
+    if (!dev)
+        return -ENODEV;
+    if (dev->dead)
+        return -EIO;
+    if (instr->addr > dev->cfg.size || instr->len > dev->cfg.size - instr->addr || !instr->len)
+        return -EINVAL;
+    
+    /* 与片上 flash 驱动一致：按覆盖到的整页擦除 */
+    page_size = dev->cfg.page_size;
+    first = instr->addr / page_size;
+    last = (instr->addr + instr->len - 1) / page_size;
+    
+    for (page = first; page <= last; page++) {
+        if (dev->cut_budget == 0) {
+            /* 掉电打断擦除：只有前半页被清成 0xFF */
+            memset(&dev->mem[page * page_size], 0xFF, page_size / 2);
+            dev->dead = 1;
+            return -EIO;
+        }
+        memset(&dev->mem[page * page_size], 0xFF, page_size);
+        dev->erase_cnt[page]++;
+        dev->stats.erase_total++;
+        if (dev->erase_cnt[page] > dev->stats.erase_max)
+            dev->stats.erase_max = dev->erase_cnt[page];
+        sim_spend(dev, (uint64_t)dev->cfg.erase_us_per_page * 1000U);
+    }
+    
+    return 0;
+}
+
+/* Private functions ---------------------------------------------------------*/
+static mtd_sim_dev_t *sim_find(const struct mtd_info *mtd)
+{
+    uint8_t i;
+    
+    for (i = 0; i < MTD_SIM_DEV_MAX; i++) {
+        if (sim_dev[i].mtd == mtd)
+            return &sim_dev[i];
+    }
+    
+    return NULL;
+}
+
+static void sim_spend(mtd_sim_dev_t *dev, uint64_t ns)
+{
+    struct timespec ts;
+    
+    dev->stats.time_ns += ns;
+    if (dev->cfg.realtime && ns) {
+        ts.tv_sec = (time_t)(ns / 1000000000ULL);
+        ts.tv_nsec = (long)(ns % 1000000000ULL);
+        nanosleep(&ts, NULL);
+    }
+}
+
+/******************************* End Of File ************************************/
@@ -0,0 +1,73 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : mtd_sim.h
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 主机端文件映射 MTD 模拟器
+  * @attention   : 仅用于 PC 端编译，替代 devices/mtd_core.c 链接，不加入 Keil 工程。
+  *                按 NOR flash 语义工作：编程只能把 1 清成 0，擦除以页为单位；
+  *                可配置各操作耗时并统计每页擦除次数
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.xxx
+  ******************************************************************************
+  */
+#ifndef __MTD_SIM_H__
+#define __MTD_SIM_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+
+/* Exported define -----------------------------------------------------------*/
+#define MTD_SIM_DEV_MAX                 (4)
+#define MTD_SIM_PAGE_MAX                (256)
+
+/* Exported typedef ----------------------------------------------------------*/
+struct mtd_info;
+
+typedef struct
+{
+    uint32_t size;                      /**< 容量，页大小的整数倍 */
+    uint32_t page_size;                 /**< 擦除单位 */
+    uint32_t write_size;                /**< 编程对齐单位，0 表示不检查 (F103 为 2) */
+    uint32_t read_ns_per_byte;          /**< 读耗时 */
+    uint32_t prog_ns_per_unit;          /**< 每个编程单位的耗时 (F103 约 52us/半字) */
+    uint32_t erase_us_per_page;         /**< 每页擦除耗时 (F103 约 20ms) */
+    uint8_t  realtime;                  /**< 1: 按模拟耗时真实休眠；0: 只累计 */
+    uint8_t  strict;                    /**< 1: 编程 0->1 时报错；0: 按与运算写入 */
+} mtd_sim_cfg_t;
+
+typedef struct
+{
+    uint64_t time_ns;                   /**< 累计模拟耗时 */
+    uint64_t read_bytes;
+    uint64_t prog_bytes;
+    uint32_t erase_total;
+    uint32_t erase_max;                 /**< 单页最大擦除次数 */
+    uint32_t prog_violations;           /**< 试图把 0 编程成 1 的次数 */
+} mtd_sim_stats_t;
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported variable prototypes ----------------------------------------------*/
+
+/* Exported function prototypes ----------------------------------------------*/
+int mtd_sim_attach(struct mtd_info *mtd, const char *path, const mtd_sim_cfg_t *cfg);
+void mtd_sim_detach(struct mtd_info *mtd);
+void mtd_sim_cut_after(struct mtd_info *mtd, int64_t bytes);
+void mtd_sim_get_stats(struct mtd_info *mtd, mtd_sim_stats_t *stats);
+uint32_t mtd_sim_get_erase_count(struct mtd_info *mtd, uint32_t page);
+void mtd_sim_reset_stats(struct mtd_info *mtd);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __MTD_SIM_H__ */
@@ -0,0 +1,186 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : prof.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 热点代码周期计数统计
+  * @attention   : 统计表为静态数组，按测量点编号直接索引；prof_dump 经日志输出 (RTT)
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.xxx
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "prof.h"
+
+#if USING_PROF
+#include <errno.h>
+#include <string.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <time.h>
+#endif
+
+#define  LOG_TAG             "prof"
+#define  LOG_LVL             4
+#include "log.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static const char *const prof_names[PROF_SITE_NUM] = {
+    "frame_parser",
+    "send_frame",
+    "loop_task",
+    "data_flush",
+    "mpsc_post",
+    "exc_fill",
+};
+
+static prof_stat_t prof_stat[PROF_SITE_NUM];
+static uint32_t prof_hz;
+
+/* Exported variables  -------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+static uint8_t prof_bin(uint32_t cycles);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+ * @brief  使能周期计数器并清空统计
+ */
+void prof_init(void)
+{
+#if defined(__arm__) || defined(__CC_ARM) || defined(__ARMCC_VERSION)
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    prof_hz = SystemCoreClock;
+#elif defined(__x86_64__) || defined(__i386__)
+    /* 用单调时钟标定 TSC 频率 */
+    struct timespec t0, t1;
+    uint64_t c0, c1;
+    
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    c0 = __rdtsc();
+    do {
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+    } while ((t1.tv_sec - t0.tv_sec) * 1000000000LL + (t1.tv_nsec - t0.tv_nsec) < 20000000LL);
+    c1 = __rdtsc();
+    prof_hz = (uint32_t)((c1 - c0) * 1000000000ULL /
+                         (uint64_t)((t1.tv_sec - t0.tv_sec) * 1000000000LL + (t1.tv_nsec - t0.tv_nsec)));
+#else
+    prof_hz = 1000000000UL;
+#endif
+    prof_reset();
+}
+
+/**
+ * @brief  记录一次测量
+ * @param  cycles 本次耗时 (周期数)
+ */
+void prof_record(uint8_t site, uint32_t cycles)
+{
+    prof_stat_t *st;
+    
+    if (site >= PROF_SITE_NUM)
+        return;
+    
+    st = &prof_stat[site];
+    if (st->count == 0 || cycles < st->min)
+        st->min = cycles;
+    if (cycles > st->max)
+        st->max = cycles;
+    st->count++;
+    st->sum += cycles;
+    st->hist[prof_bin(cycles)]++;
+}
+
+/**
+ * @brief  读取测量点统计
+ * @retval 0 成功，-EINVAL 测量点不存在
+ */
+int prof_get(uint8_t site, prof_stat_t *stat)
+{
+    if (site >= PROF_SITE_NUM || !stat)
+        return -EINVAL;
+    
+    *stat = prof_stat[site];
+    
+    return 0;
+}
+
+const char *prof_name(uint8_t site)
+{
+    return (site < PROF_SITE_NUM) ? prof_names[site] : "";
+}
+
+/**
+ * @brief  周期计数频率 (Hz)，用于换算时间
+ */
+uint32_t prof_get_hz(void)
+{
+    return prof_hz;
+}
+
+void prof_reset(void)
+{
+    memset(prof_stat, 0, sizeof(prof_stat));
+}
+
+/**
+ * @brief  通过日志输出全部统计，只列出非零的直方图格
+ */
+void prof_dump(void)
+{
+    const prof_stat_t *st;
+    uint32_t mhz = prof_hz / 1000000UL;
+    uint8_t site, i;
+    
+    if (mhz == 0)
+        mhz = 1;
+    
+    LOG_I("site            count      min      max     mean (cycles, %u MHz)\r\n", (unsigned)mhz);
+    for (site = 0; site < PROF_SITE_NUM; site++) {
+        st = &prof_stat[site];
+        if (st->count == 0) {
+            LOG_I("%-12s %8u\r\n", prof_names[site], 0U);
+            continue;
+        }
+        LOG_I("%-12s %8u %8u %8u %8u  max %u us\r\n", prof_names[site], (unsigned)st->count,
+              (unsigned)st->min, (unsigned)st->max, (unsigned)(st->sum / st->count),
+              (unsigned)(st->max / mhz));
+        for (i = 0; i < PROF_HIST_BINS; i++) {
+            if (st->hist[i])
+                LOG_I("    >= %8lu: %u\r\n", 1UL << i, (unsigned)st->hist[i]);
+        }
+    }
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  log2 直方图格号
+ */
+static uint8_t prof_bin(uint32_t cycles)
+{
+    uint8_t bin;
+    
+    if (cycles == 0)
+        return 0;
+#if defined(__CC_ARM)
+    bin = 31 - __clz(cycles);
+#else
+    bin = (uint8_t)(31 - __builtin_clz(cycles));
+#endif
+    
+    return (bin < PROF_HIST_BINS) ? bin : PROF_HIST_BINS - 1;
+}
+
+#endif /* USING_PROF */
+
+/******************************* End Of File ************************************/
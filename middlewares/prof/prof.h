@@ -0,0 +1,109 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : prof.h
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 热点代码周期计数统计
+  * @attention   : PROF_BEGIN/PROF_END 包围被测代码，按测量点累计次数、最小/最大/平均
+  *                周期数和 log2 直方图。目标板使用 DWT CYCCNT，主机使用 rdtsc 或
+  *                clock_gettime。USING_PROF 为 0 时宏展开为空，不占用代码和 RAM。
+  *                统计在主循环上下文中更新，不可在中断中使用
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.xxx
+  ******************************************************************************
+  */
+#ifndef __PROF_H__
+#define __PROF_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+#include "sys_config.h"
+
+#if USING_PROF
+#if defined(__arm__) || defined(__CC_ARM) || defined(__ARMCC_VERSION)
+#include "board.h"
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+#endif
+
+/* Exported define -----------------------------------------------------------*/
+#define PROF_HIST_BINS                  (24)    /* 第 n 格统计 [2^n, 2^(n+1)) 个周期，末格含更长 */
+#define PROF_NAME_MAX                   (16)
+
+/* Exported typedef ----------------------------------------------------------*/
+/* 测量点，新增时同步修改 prof.c 中的名称表 */
+typedef enum
+{
+    PROF_FRAME_PARSER = 0,              /**< frame_parser_process */
+    PROF_SEND_FRAME,                    /**< custom_proto_send_frame */
+    PROF_LOOP_TASK,                     /**< loop_impd_task */
+    PROF_DATA_FLUSH,                    /**< data_mgmt_flush，写 flash */
+    PROF_MPSC_POST,                     /**< mpsc_post，中断嵌套时可能少计 */
+    PROF_EXC_FILL,                      /**< exc_fill_block，激励 DMA 中断 */
+    PROF_SITE_NUM,
+} prof_site_t;
+
+typedef struct
+{
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint32_t hist[PROF_HIST_BINS];
+} prof_stat_t;
+
+/* Exported macro ------------------------------------------------------------*/
+#if USING_PROF
+#define PROF_BEGIN(site)                uint32_t prof_t0_##site = prof_now()
+#define PROF_END(site)                  prof_record(site, prof_now() - prof_t0_##site)
+#else
+#define PROF_BEGIN(site)
+#define PROF_END(site)
+#endif
+
+/* Exported variable prototypes ----------------------------------------------*/
+
+/* Exported function prototypes ----------------------------------------------*/
+void prof_init(void);
+void prof_record(uint8_t site, uint32_t cycles);
+int prof_get(uint8_t site, prof_stat_t *stat);
+const char *prof_name(uint8_t site);
+uint32_t prof_get_hz(void);
+void prof_reset(void);
+void prof_dump(void);
+
+#if USING_PROF
+/**
+ * @brief  读取当前周期计数，32 位回绕，只用于求差
+ */
+static inline uint32_t prof_now(void)
+{
+#if defined(__arm__) || defined(__CC_ARM) || defined(__ARMCC_VERSION)
+    return DWT->CYCCNT;
+#elif defined(__x86_64__) || defined(__i386__)
+    return (uint32_t)__rdtsc();
+#else
+    struct timespec ts;
+    
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec);
+#endif
+}
+#endif
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __PROF_H__ */
@@ -0,0 +1,106 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : pt.h
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 无栈协程 (protothread)
+  * @attention   : 协程状态只有一个续点 (源代码行号)，用 switch 跳回上次让出的位置，
+  *                每个协程占 2 字节 RAM，不需要独立的栈。限制：
+  *                1. 让出后局部变量不保留，跨让出点的数据放在静态变量或调用者的结构中；
+  *                2. PT_BEGIN 与 PT_END 之间不能再使用 switch 语句；
+  *                3. 只能在协程函数本身中让出，被调用的普通函数不能让出，
+  *                   需要等待的子过程写成子协程并用 PT_SPAWN 调用；
+  *                4. 续点取 __LINE__，同一行只能有一个等待/让出宏
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.xxx
+  ******************************************************************************
+  */
+#ifndef __PT_H__
+#define __PT_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported define -----------------------------------------------------------*/
+#define PT_WAITING                      (0)     /**< 等待条件 */
+#define PT_YIELDED                      (1)     /**< 主动让出 */
+#define PT_EXITED                       (2)     /**< PT_EXIT 提前结束 */
+#define PT_ENDED                        (3)     /**< 执行到 PT_END */
+
+/* Exported typedef ----------------------------------------------------------*/
+struct pt
+{
+    uint16_t lc;                        /**< 续点，0 表示从头开始 */
+};
+
+/* Exported macro ------------------------------------------------------------*/
+/**
+ * @brief 协程函数的声明和定义：PT_THREAD(name(struct pt *pt, ...))
+ */
+#define PT_THREAD(name_args)            char name_args
+
+#define PT_INIT(pt)                     do { (pt)->lc = 0; } while (0)
+
+#define PT_BEGIN(pt)                    { char pt_yield_flag = 1; (void)pt_yield_flag; \
+                                          switch ((pt)->lc) { case 0:
+
+#define PT_END(pt)                      } pt_yield_flag = 0; PT_INIT(pt); return PT_ENDED; }
+
+/** 内部使用：记录续点并设置返回位置 */
+#define PT_SET(pt)                      (pt)->lc = __LINE__; case __LINE__:
+
+/**
+ * @brief 等待条件成立，条件在每次调度时重新求值
+ */
+#define PT_WAIT_UNTIL(pt, cond)         do { PT_SET(pt) \
+                                             if (!(cond)) return PT_WAITING; } while (0)
+
+#define PT_WAIT_WHILE(pt, cond)         PT_WAIT_UNTIL((pt), !(cond))
+
+/**
+ * @brief 等待子协程结束
+ */
+#define PT_WAIT_THREAD(pt, thread)      PT_WAIT_WHILE((pt), PT_SCHEDULE(thread))
+
+/**
+ * @brief 初始化并运行子协程直到其结束
+ */
+#define PT_SPAWN(pt, child, thread)     do { PT_INIT(child); PT_WAIT_THREAD((pt), (thread)); } while (0)
+
+/**
+ * @brief 让出一次，下一次调度从此处继续
+ */
+#define PT_YIELD(pt)                    do { pt_yield_flag = 0; PT_SET(pt) \
+                                             if (pt_yield_flag == 0) return PT_YIELDED; } while (0)
+
+/**
+ * @brief 至少让出一次，之后等待条件成立
+ */
+#define PT_YIELD_UNTIL(pt, cond)        do { pt_yield_flag = 0; PT_SET(pt) \
+                                             if (pt_yield_flag == 0 || !(cond)) return PT_YIELDED; } while (0)
+
+#define PT_RESTART(pt)                  do { PT_INIT(pt); return PT_WAITING; } while (0)
+
+#define PT_EXIT(pt)                     do { PT_INIT(pt); return PT_EXITED; } while (0)
+
+/**
+ * @brief 调度一次协程，返回非零表示尚未结束
+ */
+#define PT_SCHEDULE(f)                  ((f) < PT_EXITED)
+
+/* Exported variable prototypes ----------------------------------------------*/
+
+/* Exported function prototypes ----------------------------------------------*/
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __PT_H__ */
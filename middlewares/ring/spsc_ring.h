@@ -0,0 +1,141 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : spsc_ring.h
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 单生产者单消费者无锁环形队列
+  * @attention   : 元素类型和容量在编译期确定，容量必须为 2 的幂：
+  *                    SPSC_RING_DEFINE(msg_ring, loop_msg_t, 16)
+  *                生成类型 msg_ring_t 和 msg_ring_init/push/pop/reserve/commit/peek/release
+  *                等内联函数。读写位置为单字自由计数，生产者只写 head，消费者只写 tail，
+  *                一方可以在中断中，另一方在任务中，无需关中断。
+  *                内存序：生产者先写元素再以 release 更新 head，消费者以 acquire 读 head
+  *                后再读元素；释放元素同理。Cortex-M3 上生成普通 LDR/STR 加 DMB，
+  *                主机上同样适用于两个线程
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.xxx
+  ******************************************************************************
+  */
+#ifndef __SPSC_RING_H__
+#define __SPSC_RING_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported define -----------------------------------------------------------*/
+
+/* Exported typedef ----------------------------------------------------------*/
+
+/* Exported macro ------------------------------------------------------------*/
+#define SPSC_LOAD_RELAXED(p)            __atomic_load_n((p), __ATOMIC_RELAXED)
+#define SPSC_LOAD_ACQUIRE(p)            __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define SPSC_STORE_RELEASE(p, v)        __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+/**
+ * @brief 定义环形队列类型及其操作函数
+ * @param name 类型和函数名前缀
+ * @param type 元素类型
+ * @param size 容量 (元素个数)，2 的幂
+ *
+ * 生产者：push，或 reserve 取得连续空位直接写入后 commit
+ * 消费者：pop， 或 peek    取得连续元素直接读取后 release
+ * reserve/peek 返回的连续段在环尾处截断，剩余部分再调用一次取得
+ */
+#define SPSC_RING_DEFINE(name, type, size)                                              \
+typedef char name##_size_check[((size) > 0 && ((size) & ((size) - 1)) == 0) ? 1 : -1];  \
+                                                                                        \
+typedef struct                                                                          \
+{                                                                                       \
+    uint32_t head;                      /* 写入计数，仅生产者修改 */                     \
+    uint32_t tail;                      /* 读出计数，仅消费者修改 */                     \
+    type buf[size];                                                                     \
+} name##_t;                                                                             \
+                                                                                        \
+static inline void name##_init(name##_t *r)                                             \
+{                                                                                       \
+    r->head = 0;                                                                        \
+    r->tail = 0;                                                                        \
+}                                                                                       \
+                                                                                        \
+static inline uint32_t name##_len(const name##_t *r)                                    \
+{                                                                                       \
+    uint32_t tail = SPSC_LOAD_ACQUIRE(&r->tail);                                        \
+    return SPSC_LOAD_ACQUIRE(&r->head) - tail;                                          \
+}                                                                                       \
+                                                                                        \
+/* 生产者：连续空位个数，*p 指向第一个空位 */                                           \
+static inline uint32_t name##_reserve(name##_t *r, type **p)                            \
+{                                                                                       \
+    uint32_t head = SPSC_LOAD_RELAXED(&r->head);                                        \
+    uint32_t room = (size) - (head - SPSC_LOAD_ACQUIRE(&r->tail));                      \
+    uint32_t off = head & ((size) - 1);                                                 \
+                                                                                        \
+    if (room > (size) - off)                                                            \
+        room = (size) - off;                                                            \
+    *p = &r->buf[off];                                                                  \
+    return room;                                                                        \
+}                                                                                       \
+                                                                                        \
+/* 生产者：发布 reserve 后写入的 n 个元素 */                                            \
+static inline void name##_commit(name##_t *r, uint32_t n)                               \
+{                                                                                       \
+    SPSC_STORE_RELEASE(&r->head, SPSC_LOAD_RELAXED(&r->head) + n);                      \
+}                                                                                       \
+                                                                                        \
+/* 消费者：连续元素个数，*p 指向最早的元素 */                                           \
+static inline uint32_t name##_peek(name##_t *r, type **p)                               \
+{                                                                                       \
+    uint32_t tail = SPSC_LOAD_RELAXED(&r->tail);                                        \
+    uint32_t used = SPSC_LOAD_ACQUIRE(&r->head) - tail;                                 \
+    uint32_t off = tail & ((size) - 1);                                                 \
+                                                                                        \
+    if (used > (size) - off)                                                            \
+        used = (size) - off;                                                            \
+    *p = &r->buf[off];                                                                  \
+    return used;                                                                        \
+}                                                                                       \
+                                                                                        \
+/* 消费者：归还 peek 后读完的 n 个元素 */                                               \
+static inline void name##_release(name##_t *r, uint32_t n)                              \
+{                                                                                       \
+    SPSC_STORE_RELEASE(&r->tail, SPSC_LOAD_RELAXED(&r->tail) + n);                      \
+}                                                                                       \
+                                                                                        \
+static inline uint8_t name##_push(name##_t *r, const type *v)                           \
+{                                                                                       \
+    type *p;                                                                            \
+                                                                                        \
+    if (name##_reserve(r, &p) == 0)                                                     \
+        return 0;                                                                       \
+    *p = *v;                                                                            \
+    name##_commit(r, 1);                                                                \
+    return 1;                                                                           \
+}                                                                                       \
+                                                                                        \
+static inline uint8_t name##_pop(name##_t *r, type *v)                                  \
+{                                                                                       \
+    type *p;                                                                            \
+                                                                                        \
+    if (name##_peek(r, &p) == 0)                                                        \
+        return 0;                                                                       \
+    *v = *p;                                                                            \
+    name##_release(r, 1);                                                               \
+    return 1;                                                                           \
+}
+
+/* Exported variable prototypes ----------------------------------------------*/
+
+/* Exported function prototypes ----------------------------------------------*/
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __SPSC_RING_H__ */
@@ -0,0 +1,183 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : evt_sched.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 事件驱动的协作式调度器
+  * @attention   : 休眠判断与进入休眠在同一个关中断区内完成：Cortex-M 在 PRIMASK
+  *                置位时 WFI 仍会被挂起的中断唤醒，不会丢失检查之后到来的事件
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.xxx
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "evt_sched.h"
+#include "sys_config.h"
+#include <errno.h>
+
+#if defined(USING_HW_ATOMIC) && (defined(__arm__) || defined(__ARMCC_VERSION))
+#include "mpsc_queue.h"
+#define SCHED_POST_LOCKFREE             1       /* LDREX/STREX 置位，不关中断 */
+#else
+#define SCHED_POST_LOCKFREE             0
+#endif
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static sched_task_t *sched_task[SCHED_TASK_MAX];
+static uint8_t sched_task_num;
+static volatile uint32_t sched_pending;
+static void (*sched_poll)(void);
+static uint32_t (*sched_next_wake)(void);
+static sched_stats_t sched_stats;
+
+/* Exported variables  -------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+
+/* Exported functions --------------------------------------------------------*/
+/**
+ * @brief  初始化调度器
+ * @param  poll 每次唤醒后调用的检查函数，用于没有可用中断钩子的事件源，可为 NULL
+ */
+void sched_init(void (*poll)(void))
+{
+    sched_task_num = 0;
+    sched_pending = 0;
+    sched_poll = poll;
+    sched_next_wake = NULL;
+    sched_stats.passes = 0;
+    sched_stats.idles = 0;
+    sched_stats.tickless = 0;
+    sched_stats.slept = 0;
+    sched_port_init();
+}
+
+/**
+ * @brief  设置唤醒期限函数，使能无节拍休眠
+ * @param  next_wake 关中断状态下调用，返回距下一次必须运行任务的节拍数，NULL 关闭
+ */
+void sched_set_tickless(uint32_t (*next_wake)(void))
+{
+    sched_next_wake = next_wake;
+}
+
+/**
+ * @brief  注册任务，按注册顺序运行
+ * @retval 0 成功，负值失败
+ */
+int sched_register(sched_task_t *task, const char *name, uint32_t mask, sched_fn_t fn)
+{
+    if (!task || !fn || !mask)
+        return -EINVAL;
+    if (sched_task_num >= SCHED_TASK_MAX)
+        return -ENOSPC;
+    
+    task->name = name;
+    task->mask = mask;
+    task->fn = fn;
+    task->runs = 0;
+    sched_task[sched_task_num++] = task;
+    
+    return 0;
+}
+
+/**
+ * @brief  置事件位，可在中断中调用
+ * @note   Cortex-M 上定义 USING_HW_ATOMIC 时以 LDREX/STREX 置位，不关中断；
+ *         取走事件仍在 sched_run 的关中断区内，与置位互斥
+ */
+void sched_post(uint32_t events)
+{
+#if SCHED_POST_LOCKFREE
+    mpsc_fetch_or(&sched_pending, events);
+#else
+    uint32_t state = sched_port_irq_save();
+    
+    sched_pending |= events;
+    sched_port_irq_restore(state);
+#endif
+    sched_port_notify();
+}
+
+/**
+ * @brief  调度一轮：取走全部事件并运行订阅了其中任一位的任务，没有事件时休眠
+ * @retval 1 运行了任务，0 本轮休眠
+ */
+uint8_t sched_run_once(void)
+{
+    uint32_t state;
+    uint32_t events;
+    uint8_t i;
+    
+    if (sched_poll)
+        sched_poll();
+    
+    state = sched_port_irq_save();
+    events = sched_pending;
+    sched_pending = 0;
+    if (!events) {
+        sched_stats.idles++;
+        sched_port_idle(sched_next_wake ? sched_next_wake() : 0);
+        sched_port_irq_restore(state);
+        return 0;
+    }
+    sched_port_irq_restore(state);
+    
+    sched_stats.passes++;
+    for (i = 0; i < sched_task_num; i++) {
+        if (sched_task[i]->mask & events) {
+            sched_task[i]->runs++;
+            sched_task[i]->fn(sched_task[i]->mask & events);
+        }
+    }
+    
+    return 1;
+}
+
+/**
+ * @brief  调度主循环，不返回
+ */
+void sched_run(void)
+{
+    for (;;)
+        sched_run_once();
+}
+
+void sched_get_stats(sched_stats_t *stats)
+{
+    if (stats)
+        *stats = sched_stats;
+}
+
+/**
+ * @brief  无节拍休眠结束后计算期间错过的节拍数，由移植层调用
+ * @param  v0/v1   休眠前后读到的递减节拍计数器值
+ * @param  elapsed 低速唤醒定时器测得的休眠时长 (节拍计数器时钟周期)，误差须小于半个节拍
+ * @param  period  每个节拍的计数器周期数 (重装值 + 1)
+ * @retval 计数器在 v0 与 v1 之间回绕的次数
+ * @note   亚节拍部分由计数器相位精确给出，粗测时长只用来确定整圈数，
+ *         因此唤醒定时器的量化误差不会累积成节拍漂移
+ */
+uint32_t sched_tickless_wraps(uint32_t v0, uint32_t v1, uint32_t elapsed, uint32_t period)
+{
+    uint32_t wrapped = (v1 > v0) ? 1 : 0;
+    uint32_t phase = wrapped ? v0 + period - v1 : v0 - v1;
+    
+    if (elapsed > phase)
+        wrapped += (elapsed - phase + period / 2) / period;
+    sched_stats.tickless++;
+    sched_stats.slept += wrapped;
+    
+    return wrapped;
+}
+
+/******************************* End Of File ************************************/
@@ -0,0 +1,77 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : evt_sched.h
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 事件驱动的协作式调度器
+  * @attention   : 中断通过 sched_post 置事件位，任务按订阅的事件位运行；
+  *                没有事件时调用移植层 sched_port_idle 休眠 (Cortex-M 为 WFI，
+  *                主机为条件变量)，任何中断都会唤醒内核。设置了唤醒期限函数时，
+  *                移植层可以停掉节拍中断一直睡到期限 (无节拍休眠)
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.xxx
+  ******************************************************************************
+  */
+#ifndef __EVT_SCHED_H__
+#define __EVT_SCHED_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+
+/* Exported define -----------------------------------------------------------*/
+#define SCHED_TASK_MAX                  (8)
+#define SCHED_TICKLESS_MIN_IDLE         (2)     /* 短于此节拍数不停节拍 */
+
+/* Exported typedef ----------------------------------------------------------*/
+typedef void (*sched_fn_t)(uint32_t events);
+
+typedef struct
+{
+    const char *name;
+    uint32_t mask;                      /**< 订阅的事件位 */
+    sched_fn_t fn;                      /**< 参数为本次触发的事件位 */
+    uint32_t runs;                      /**< 运行次数 */
+} sched_task_t;
+
+typedef struct
+{
+    uint32_t passes;                    /**< 有事件的调度轮数 */
+    uint32_t idles;                     /**< 进入休眠的次数 */
+    uint32_t tickless;                  /**< 其中停掉节拍的次数 */
+    uint32_t slept;                     /**< 无节拍休眠补偿的节拍数 */
+} sched_stats_t;
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported variable prototypes ----------------------------------------------*/
+
+/* Exported function prototypes ----------------------------------------------*/
+void sched_init(void (*poll)(void));
+void sched_set_tickless(uint32_t (*next_wake)(void));
+int sched_register(sched_task_t *task, const char *name, uint32_t mask, sched_fn_t fn);
+void sched_post(uint32_t events);
+uint8_t sched_run_once(void);
+void sched_run(void);
+void sched_get_stats(sched_stats_t *stats);
+
+/* 移植层接口 */
+uint32_t sched_port_irq_save(void);
+void sched_port_irq_restore(uint32_t state);
+void sched_port_init(void);
+void sched_port_idle(uint32_t ticks);
+void sched_port_notify(void);
+uint32_t sched_tickless_wraps(uint32_t v0, uint32_t v1, uint32_t elapsed, uint32_t period);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __EVT_SCHED_H__ */
@@ -0,0 +1,163 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : evt_sched_port_cm3.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 调度器 Cortex-M3 移植层
+  * @attention   : 临界区使用 PRIMASK；休眠使用 WFI，中断本身即唤醒源。
+  *                board.h 定义 SCHED_WAKE_TIM 时支持无节拍休眠：屏蔽 SysTick 中断
+  *                (计数器继续运行以保持节拍相位)，用基本定时器单次定时唤醒，
+  *                醒来后按 SysTick 相位和定时器计数补偿 HAL 节拍
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.xxx
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "evt_sched.h"
+#include "board.h"
+
+/* Private define ------------------------------------------------------------*/
+#define TICKLESS_TIM_HZ                 (10000UL)   /* 唤醒定时器计数频率 */
+
+/* Private variables ---------------------------------------------------------*/
+#if defined(SCHED_WAKE_TIM)
+static uint32_t tickless_cycles;        /* 每个唤醒定时器计数对应的 SysTick 周期数 */
+#endif
+
+/* Private function prototypes -----------------------------------------------*/
+#if defined(SCHED_WAKE_TIM)
+static void sched_port_tickless(uint32_t ticks);
+#endif
+
+/* Exported functions --------------------------------------------------------*/
+uint32_t sched_port_irq_save(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    
+    __disable_irq();
+    
+    return primask;
+}
+
+void sched_port_irq_restore(uint32_t state)
+{
+    __set_PRIMASK(state);
+}
+
+/**
+ * @brief  初始化唤醒定时器：单脉冲模式，UG 只复位预分频器不产生更新中断
+ */
+void sched_port_init(void)
+{
+#if defined(SCHED_WAKE_TIM)
+    uint32_t tim_clk = HAL_RCC_GetPCLK1Freq();
+    
+    if ((RCC->CFGR & RCC_CFGR_PPRE1) != RCC_HCLK_DIV1)
+        tim_clk *= 2;
+    
+    SCHED_WAKE_TIM_CLK_ENABLE();
+    SCHED_WAKE_TIM->CR1 = TIM_CR1_OPM | TIM_CR1_URS;
+    SCHED_WAKE_TIM->PSC = tim_clk / TICKLESS_TIM_HZ - 1;
+    SCHED_WAKE_TIM->DIER = TIM_DIER_UIE;
+    SCHED_WAKE_TIM->SR = 0;
+    tickless_cycles = SystemCoreClock / TICKLESS_TIM_HZ;
+    
+    HAL_NVIC_SetPriority(SCHED_WAKE_TIM_IRQn, 3, 0);
+    HAL_NVIC_EnableIRQ(SCHED_WAKE_TIM_IRQn);
+#endif
+}
+
+/**
+ * @brief  关中断状态下调用，挂起的中断会使 WFI 返回，开中断后再进入中断服务
+ * @param  ticks 最多可以休眠的节拍数，0 表示不限但须保留节拍中断
+ */
+void sched_port_idle(uint32_t ticks)
+{
+#if defined(SCHED_WAKE_TIM)
+    if (ticks >= SCHED_TICKLESS_MIN_IDLE) {
+        sched_port_tickless(ticks);
+        return;
+    }
+#endif
+    __DSB();
+    __WFI();
+}
+
+void sched_port_notify(void)
+{
+}
+
+#if defined(SCHED_WAKE_TIM)
+/**
+ * @brief  唤醒定时器中断：唤醒后已在 sched_port_tickless 中处理，这里只清标志
+ */
+void SCHED_WAKE_TIM_IRQHandler(void)
+{
+    SCHED_WAKE_TIM->SR = 0;
+}
+#endif
+
+/* Private functions ---------------------------------------------------------*/
+#if defined(SCHED_WAKE_TIM)
+/**
+ * @brief  无节拍休眠
+ * @note   SysTick 计数器不停，只屏蔽中断。进入前若已有节拍挂起则放弃本次休眠；
+ *         退出时若计数器在读相位之后、开中断之前回绕，补一个挂起的节拍中断，
+ *         保证每个节拍要么被补偿、要么由中断处理，不重不漏
+ */
+static void sched_port_tickless(uint32_t ticks)
+{
+    uint32_t ctrl = SysTick->CTRL & (SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_TICKINT_Msk |
+                                     SysTick_CTRL_ENABLE_Msk);
+    uint32_t period = SysTick->LOAD + 1;
+    uint32_t v0, v1, counts, wraps;
+    
+    if (ticks > SCHED_TICKLESS_MAX_IDLE)
+        ticks = SCHED_TICKLESS_MAX_IDLE;
+    
+    v0 = SysTick->VAL;
+    SysTick->CTRL = ctrl & ~SysTick_CTRL_TICKINT_Msk;
+    if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) {
+        SysTick->CTRL = ctrl;
+        return;
+    }
+    
+    /* 在第 ticks 个节拍边界附近唤醒 */
+    counts = ((uint64_t)(ticks - 1) * period + v0 + 1) / tickless_cycles;
+    if (counts == 0)
+        counts = 1;
+    else if (counts > 0xFFFF)
+        counts = 0xFFFF;
+    SCHED_WAKE_TIM->ARR = counts - 1;
+    SCHED_WAKE_TIM->CNT = 0;
+    SCHED_WAKE_TIM->EGR = TIM_EGR_UG;
+    SCHED_WAKE_TIM->SR = 0;
+    SCHED_WAKE_TIM->CR1 |= TIM_CR1_CEN;
+    
+    __DSB();
+    __WFI();
+    
+    SCHED_WAKE_TIM->CR1 &= ~TIM_CR1_CEN;
+    if (!(SCHED_WAKE_TIM->SR & TIM_SR_UIF))
+        counts = SCHED_WAKE_TIM->CNT;
+    SCHED_WAKE_TIM->SR = 0;
+    NVIC_ClearPendingIRQ(SCHED_WAKE_TIM_IRQn);
+    
+    v1 = SysTick->VAL;
+    SysTick->CTRL = ctrl;
+    if (SysTick->VAL > v1 && !(SCB->ICSR & SCB_ICSR_PENDSTSET_Msk))
+        SCB->ICSR = SCB_ICSR_PENDSTSET_Msk;
+    
+    /* 定时器计数截断了不足一个计数的部分，按半个计数补偿 */
+    wraps = sched_tickless_wraps(v0, v1, counts * tickless_cycles + tickless_cycles / 2, period);
+    if (wraps) {
+        uwTick += wraps * uwTickFreq;
+        sched_post(SCHED_EVT_TICK);
+    }
+}
+#endif
+
+/******************************* End Of File ************************************/
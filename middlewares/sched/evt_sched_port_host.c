@@ -0,0 +1,58 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : evt_sched_port_host.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 调度器主机移植层 (pthread)
+  * @attention   : 仅用于 PC 端编译，不加入 Keil 工程。临界区为互斥锁，
+  *                休眠为条件变量等待，其他线程调用 sched_post 模拟中断唤醒，
+  *                可用于测量唤醒延迟和空闲 CPU 占用
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.xxx
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "evt_sched.h"
+#include <pthread.h>
+
+/* Private variables ---------------------------------------------------------*/
+static pthread_mutex_t sched_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  sched_cond = PTHREAD_COND_INITIALIZER;
+
+/* Exported functions --------------------------------------------------------*/
+uint32_t sched_port_irq_save(void)
+{
+    pthread_mutex_lock(&sched_mutex);
+    
+    return 0;
+}
+
+void sched_port_irq_restore(uint32_t state)
+{
+    (void)state;
+    pthread_mutex_unlock(&sched_mutex);
+}
+
+void sched_port_init(void)
+{
+}
+
+/**
+ * @brief  持锁调用，等待期间释放锁，与 sched_post 的置位互斥，不会丢失唤醒
+ * @note   主机没有节拍中断，ticks 不使用
+ */
+void sched_port_idle(uint32_t ticks)
+{
+    (void)ticks;
+    pthread_cond_wait(&sched_cond, &sched_mutex);
+}
+
+void sched_port_notify(void)
+{
+    pthread_cond_signal(&sched_cond);
+}
+
+/******************************* End Of File ************************************/
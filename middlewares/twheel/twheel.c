@@ -0,0 +1,307 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : twheel.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 分层时间轮软件定时器
+  * @attention   : 第 0 层每槽一个节拍，第 n 层每槽 2^(6n) 个节拍。到期时间落在哪一层
+  *                由剩余节拍数决定；第 0 层转完一圈时把上一层当前槽的定时器重新插入
+  *                (级联)。各层用位图记录非空槽，空闲时 twheel_service 直接跳到下一个
+  *                非空槽或层边界，不逐节拍推进
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.xxx
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "twheel.h"
+#include <errno.h>
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+#define TWHEEL_SLOT_MASK                (TWHEEL_SLOTS - 1)
+#define TWHEEL_MAP_WORDS                (TWHEEL_SLOTS / 32)
+#define TWHEEL_RANGE                    (1UL << (TWHEEL_SLOT_BITS * TWHEEL_LEVELS))
+
+/* Private macro -------------------------------------------------------------*/
+#define TWHEEL_SHIFT(level)             ((level) * TWHEEL_SLOT_BITS)
+
+/* Private variables ---------------------------------------------------------*/
+static twheel_timer_t *wheel[TWHEEL_LEVELS][TWHEEL_SLOTS];
+static uint32_t wheel_map[TWHEEL_LEVELS][TWHEEL_MAP_WORDS];
+static uint32_t wheel_jiffies;          /* 下一个待处理的节拍 */
+static uint32_t wheel_count;
+static uint32_t (*wheel_get_tick)(void);
+
+/* Exported variables  -------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+static void twheel_insert(twheel_timer_t *timer);
+static void twheel_unlink(twheel_timer_t *timer);
+static void twheel_cascade(uint8_t level, uint32_t idx);
+static uint32_t twheel_find(uint8_t level, uint32_t from);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+ * @brief  初始化时间轮
+ * @param  get_tick 节拍源，单位与定时周期一致 (一般为 HAL_GetTick)
+ */
+void twheel_init(uint32_t (*get_tick)(void))
+{
+    uint8_t level;
+    uint32_t i;
+    
+    for (level = 0; level < TWHEEL_LEVELS; level++) {
+        for (i = 0; i < TWHEEL_SLOTS; i++)
+            wheel[level][i] = NULL;
+        for (i = 0; i < TWHEEL_MAP_WORDS; i++)
+            wheel_map[level][i] = 0;
+    }
+    wheel_get_tick = get_tick;
+    wheel_jiffies = get_tick();
+    wheel_count = 0;
+}
+
+/**
+ * @brief  初始化定时器，不启动
+ * @param  period 定时周期 (节拍)，0 按 1 处理
+ * @retval 0 成功，-EINVAL 参数错误
+ */
+int twheel_create(twheel_timer_t *timer, uint32_t period, twheel_mode_t mode, twheel_cb_t cb, void *arg)
+{
+    if (!timer || !cb)
+        return -EINVAL;
+    
+    timer->next = NULL;
+    timer->pprev = NULL;
+    timer->expires = 0;
+    timer->period = period ? period : 1;
+    timer->slot = 0;
+    timer->mode = (uint8_t)mode;
+    timer->cb = cb;
+    timer->arg = arg;
+    
+    return 0;
+}
+
+/**
+ * @brief  启动定时器，已启动时从当前时刻重新计时
+ * @retval 0 成功，-EINVAL 参数错误
+ */
+int twheel_start(twheel_timer_t *timer)
+{
+    if (!timer || !timer->cb)
+        return -EINVAL;
+    
+    if (timer->pprev)
+        twheel_unlink(timer);
+    timer->expires = wheel_get_tick() + timer->period;
+    twheel_insert(timer);
+    
+    return 0;
+}
+
+void twheel_stop(twheel_timer_t *timer)
+{
+    if (timer && timer->pprev)
+        twheel_unlink(timer);
+}
+
+uint8_t twheel_is_active(const twheel_timer_t *timer)
+{
+    return (timer && timer->pprev) ? 1 : 0;
+}
+
+/**
+ * @brief  处理截至当前节拍的所有到期定时器，回调中可以启动、停止任意定时器
+ */
+void twheel_service(void)
+{
+    uint32_t now = wheel_get_tick();
+    twheel_timer_t *list;
+    twheel_timer_t *timer;
+    uint32_t idx, next;
+    uint8_t level;
+    
+    while ((int32_t)(now - wheel_jiffies) >= 0) {
+        idx = wheel_jiffies & TWHEEL_SLOT_MASK;
+        
+        /* 第 0 层转完一圈，逐层级联 */
+        if (idx == 0) {
+            for (level = 1; level < TWHEEL_LEVELS; level++) {
+                next = (wheel_jiffies >> TWHEEL_SHIFT(level)) & TWHEEL_SLOT_MASK;
+                twheel_cascade(level, next);
+                if (next != 0)
+                    break;
+            }
+        }
+        
+        if (!wheel[0][idx]) {
+            /* 跳到本圈下一个非空槽，不越过层边界 */
+            next = twheel_find(0, idx);
+            if (next > TWHEEL_SLOTS - 1 || next < idx)
+                next = TWHEEL_SLOTS;
+            if (now - wheel_jiffies < next - idx)
+                next = idx + (now - wheel_jiffies) + 1;
+            wheel_jiffies += next - idx;
+            continue;
+        }
+        
+        /* 取下整个槽，回调中重新插入的定时器不会在本次遍历中执行 */
+        list = wheel[0][idx];
+        list->pprev = &list;
+        wheel[0][idx] = NULL;
+        wheel_map[0][idx >> 5] &= ~(1UL << (idx & 31));
+        wheel_jiffies++;
+        
+        while (list) {
+            timer = list;
+            twheel_unlink(timer);
+            if (timer->mode == TWHEEL_AUTO_RELOAD) {
+                timer->expires += timer->period;
+                twheel_insert(timer);
+            }
+            timer->cb(timer->arg);
+        }
+    }
+}
+
+/**
+ * @brief  距下一次需要调用 twheel_service 的节拍数
+ * @retval TWHEEL_FOREVER 没有运行中的定时器；0 已有到期未处理的定时器
+ * @note   高层定时器返回其级联时刻，不晚于实际到期时刻
+ */
+uint32_t twheel_next_expiry(void)
+{
+    uint32_t now = wheel_get_tick();
+    uint32_t best = TWHEEL_FOREVER;
+    uint32_t base, pos, slot, when, skip;
+    uint8_t level;
+    
+    if (wheel_count == 0)
+        return TWHEEL_FOREVER;
+    
+    for (level = 0; level < TWHEEL_LEVELS; level++) {
+        base = wheel_jiffies >> TWHEEL_SHIFT(level);
+        pos = base & TWHEEL_SLOT_MASK;
+        /* 高层当前槽在低位全为 0 的节拍处理时级联，此后才算已处理 */
+        skip = (level && (wheel_jiffies & ((1UL << TWHEEL_SHIFT(level)) - 1))) ? 1 : 0;
+        slot = twheel_find(level, (pos + skip) & TWHEEL_SLOT_MASK);
+        if (slot >= TWHEEL_SLOTS)
+            continue;
+        when = (base + ((slot - pos - skip) & TWHEEL_SLOT_MASK) + skip) << TWHEEL_SHIFT(level);
+        if (best == TWHEEL_FOREVER || (int32_t)(when - best) < 0)
+            best = when;
+    }
+    
+    if ((int32_t)(best - now) <= 0)
+        return 0;
+    
+    return best - now;
+}
+
+uint32_t twheel_get_count(void)
+{
+    return wheel_count;
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  按剩余节拍数选层插入，已过期的放到下一个待处理槽
+ */
+static void twheel_insert(twheel_timer_t *timer)
+{
+    uint32_t delta = timer->expires - wheel_jiffies;
+    uint32_t expires = timer->expires;
+    uint32_t idx;
+    uint8_t level;
+    
+    if ((int32_t)delta < 0) {
+        expires = wheel_jiffies;
+        delta = 0;
+    } else if (delta >= TWHEEL_RANGE) {
+        /* 超出范围先放在最高层最远的槽，级联时按真实到期时间重新插入 */
+        expires = wheel_jiffies + TWHEEL_RANGE - 1;
+        delta = TWHEEL_RANGE - 1;
+    }
+    
+    for (level = 0; level < TWHEEL_LEVELS - 1; level++) {
+        if (delta < (1UL << TWHEEL_SHIFT(level + 1)))
+            break;
+    }
+    idx = (expires >> TWHEEL_SHIFT(level)) & TWHEEL_SLOT_MASK;
+    
+    timer->next = wheel[level][idx];
+    if (timer->next)
+        timer->next->pprev = &timer->next;
+    wheel[level][idx] = timer;
+    timer->pprev = &wheel[level][idx];
+    timer->slot = (uint16_t)(level * TWHEEL_SLOTS + idx);
+    wheel_map[level][idx >> 5] |= 1UL << (idx & 31);
+    wheel_count++;
+}
+
+static void twheel_unlink(twheel_timer_t *timer)
+{
+    uint8_t level = timer->slot / TWHEEL_SLOTS;
+    uint32_t idx = timer->slot & TWHEEL_SLOT_MASK;
+    
+    *timer->pprev = timer->next;
+    if (timer->next)
+        timer->next->pprev = timer->pprev;
+    timer->next = NULL;
+    timer->pprev = NULL;
+    if (!wheel[level][idx])
+        wheel_map[level][idx >> 5] &= ~(1UL << (idx & 31));
+    wheel_count--;
+}
+
+static void twheel_cascade(uint8_t level, uint32_t idx)
+{
+    twheel_timer_t *list = wheel[level][idx];
+    twheel_timer_t *timer;
+    
+    if (!list)
+        return;
+    
+    list->pprev = &list;
+    wheel[level][idx] = NULL;
+    wheel_map[level][idx >> 5] &= ~(1UL << (idx & 31));
+    while (list) {
+        timer = list;
+        twheel_unlink(timer);
+        twheel_insert(timer);
+    }
+}
+
+/**
+ * @brief  从 from 开始循环查找本层第一个非空槽
+ * @retval 槽号，没有时返回 TWHEEL_SLOTS
+ */
+static uint32_t twheel_find(uint8_t level, uint32_t from)
+{
+    uint32_t i, w, bits;
+    
+    for (i = 0; i <= TWHEEL_MAP_WORDS; i++) {
+        w = ((from >> 5) + i) % TWHEEL_MAP_WORDS;
+        bits = wheel_map[level][w];
+        if (i == 0)
+            bits &= ~0UL << (from & 31);
+        else if (i == TWHEEL_MAP_WORDS)
+            bits &= (from & 31) ? ~(~0UL << (from & 31)) : 0;
+        if (bits) {
+#if defined(__CC_ARM)
+            return w * 32 + __clz(__rbit(bits));
+#else
+            return w * 32 + (uint32_t)__builtin_ctz(bits);
+#endif
+        }
+    }
+    
+    return TWHEEL_SLOTS;
+}
+
+/******************************* End Of File ************************************/
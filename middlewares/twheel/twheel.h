@@ -0,0 +1,73 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : twheel.h
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 分层时间轮软件定时器
+  * @attention   : 接口与 stimer 一致 (create/start/stop/service)。启动、停止为 O(1)，
+  *                twheel_service 只处理到期的定时器和经过的槽位边界，与定时器总数无关；
+  *                twheel_next_expiry 给出下一次需要唤醒的节拍数，供无节拍休眠使用
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1.xxx
+  ******************************************************************************
+  */
+#ifndef __TWHEEL_H__
+#define __TWHEEL_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+
+/* Exported define -----------------------------------------------------------*/
+#define TWHEEL_SLOT_BITS                (6)
+#define TWHEEL_SLOTS                    (1UL << TWHEEL_SLOT_BITS)
+#define TWHEEL_LEVELS                   (4)     /* 覆盖 2^24 个节拍，更长的定时分段级联 */
+#define TWHEEL_FOREVER                  (0xFFFFFFFFUL)
+
+/* Exported typedef ----------------------------------------------------------*/
+typedef enum
+{
+    TWHEEL_ONE_SHOT = 0,
+    TWHEEL_AUTO_RELOAD,
+} twheel_mode_t;
+
+typedef void (*twheel_cb_t)(void *arg);
+
+typedef struct twheel_timer
+{
+    struct twheel_timer *next;
+    struct twheel_timer **pprev;        /**< 指向前一节点的 next，NULL 表示未启动 */
+    uint32_t expires;                   /**< 到期节拍 (绝对值) */
+    uint32_t period;
+    uint16_t slot;                      /**< 所在槽位 (层号 * TWHEEL_SLOTS + 槽号) */
+    uint8_t mode;
+    twheel_cb_t cb;
+    void *arg;
+} twheel_timer_t;
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported variable prototypes ----------------------------------------------*/
+
+/* Exported function prototypes ----------------------------------------------*/
+void twheel_init(uint32_t (*get_tick)(void));
+int twheel_create(twheel_timer_t *timer, uint32_t period, twheel_mode_t mode, twheel_cb_t cb, void *arg);
+int twheel_start(twheel_timer_t *timer);
+void twheel_stop(twheel_timer_t *timer);
+uint8_t twheel_is_active(const twheel_timer_t *timer);
+void twheel_service(void);
+uint32_t twheel_next_expiry(void);
+uint32_t twheel_get_count(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __TWHEEL_H__ */
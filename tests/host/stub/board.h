@@ -0,0 +1,40 @@
+/**
+  ******************************************************************************
+  * @file        : board.h
+  * @brief       : 主机测试用的板级定义：应用区指向测试程序中的旧镜像，
+  *                GPIO 和节拍接口由测试程序实现
+  ******************************************************************************
+  */
+#ifndef __BOARD_H__
+#define __BOARD_H__
+
+#include "sys_def.h"
+
+extern uint8_t test_app_image[];
+
+#define IAP_APP_ADDR                    ((uintptr_t)test_app_image)
+#define IAP_APP_SIZE                    ((64 - 8 - 8) * 1024UL)
+
+typedef struct
+{
+    uint32_t Pin;
+    uint32_t Mode;
+    uint32_t Pull;
+    uint32_t Speed;
+} GPIO_InitTypeDef;
+
+#define GPIO_PIN_RESET                  (0)
+#define GPIO_PIN_SET                    (1)
+#define GPIO_MODE_OUTPUT_PP             (1)
+#define GPIO_NOPULL                     (0)
+#define GPIO_SPEED_FREQ_LOW             (0)
+#define __HAL_RCC_GPIOA_CLK_ENABLE()
+
+#define IMPD_RELAY_GPIO_Port            (NULL)
+#define IMPD_RELAY_Pin                  (1U << 8)
+
+void HAL_GPIO_Init(void *port, GPIO_InitTypeDef *init);
+void HAL_GPIO_WritePin(void *port, uint32_t pin, int state);
+uint32_t HAL_GetTick(void);
+
+#endif /* __BOARD_H__ */
@@ -0,0 +1,21 @@
+/**
+  ******************************************************************************
+  * @file        : crc.c
+  * @brief       : CRC-16/MODBUS 按位实现，与目标版本的查表实现结果相同
+  ******************************************************************************
+  */
+#include "crc.h"
+
+uint16_t crc16_modbus(const uint8_t *data, uint32_t len)
+{
+    uint16_t crc = 0xFFFF;
+    int i;
+    
+    while (len--) {
+        crc ^= *data++;
+        for (i = 0; i < 8; i++)
+            crc = (crc & 1) ? (crc >> 1) ^ 0xA001 : crc >> 1;
+    }
+    
+    return crc;
+}
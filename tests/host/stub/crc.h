@@ -0,0 +1,14 @@
+/**
+  ******************************************************************************
+  * @file        : crc.h
+  * @brief       : 主机测试用的 CRC 接口，实现见 crc.c
+  ******************************************************************************
+  */
+#ifndef __CRC_H__
+#define __CRC_H__
+
+#include "sys_def.h"
+
+uint16_t crc16_modbus(const uint8_t *data, uint32_t len);
+
+#endif /* __CRC_H__ */
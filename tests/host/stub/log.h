@@ -0,0 +1,24 @@
+/**
+  ******************************************************************************
+  * @file        : log.h
+  * @brief       : 主机测试用的日志接口，直接输出到 stdout，
+  *                定义 LOG_QUIET 时不输出 (用于会故意触发大量错误的测试)
+  ******************************************************************************
+  */
+#ifndef __LOG_H__
+#define __LOG_H__
+
+#include <stdio.h>
+
+#define LOG_D(...)
+#ifdef LOG_QUIET
+#define LOG_I(...)
+#define LOG_W(...)
+#define LOG_E(...)
+#else
+#define LOG_I(...)                      printf(__VA_ARGS__)
+#define LOG_W(...)                      printf(__VA_ARGS__)
+#define LOG_E(...)                      printf(__VA_ARGS__)
+#endif
+
+#endif /* __LOG_H__ */
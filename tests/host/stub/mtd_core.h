@@ -0,0 +1,27 @@
+/**
+  ******************************************************************************
+  * @file        : mtd_core.h
+  * @brief       : 主机测试用的 MTD 接口声明，实现由 middlewares/mtd_sim 提供
+  ******************************************************************************
+  */
+#ifndef __MTD_CORE_H__
+#define __MTD_CORE_H__
+
+#include "sys_def.h"
+
+struct mtd_info
+{
+    uint32_t size;
+};
+
+struct erase_info
+{
+    uint32_t addr;
+    uint32_t len;
+};
+
+int mtd_read(struct mtd_info *mtd, uint32_t from, size_t len, size_t *retlen, uint8_t *buf);
+int mtd_write(struct mtd_info *mtd, uint32_t to, size_t len, size_t *retlen, const uint8_t *buf);
+int mtd_erase(struct mtd_info *mtd, struct erase_info *instr);
+
+#endif /* __MTD_CORE_H__ */
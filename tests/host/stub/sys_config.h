@@ -0,0 +1,10 @@
+/**
+  ******************************************************************************
+  * @file        : sys_config.h
+  * @brief       : 主机测试用的系统配置，不定义 USING_HW_ATOMIC，调度器走关中断路径
+  ******************************************************************************
+  */
+#ifndef __SYS_CONFIG_H__
+#define __SYS_CONFIG_H__
+
+#endif /* __SYS_CONFIG_H__ */
@@ -0,0 +1,15 @@
+/**
+  ******************************************************************************
+  * @file        : sys_def.h
+  * @brief       : 主机测试用的基础类型定义，代替 utilities 中的目标版本
+  ******************************************************************************
+  */
+#ifndef __SYS_DEF_H__
+#define __SYS_DEF_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <errno.h>
+
+#endif /* __SYS_DEF_H__ */
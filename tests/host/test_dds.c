@@ -0,0 +1,193 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : test_dds.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 激励 DDS 的频谱模型：按 impd_exc.c 的块生成方式产生 DAC 码值，
+  *                用加窗 FFT 检查无杂散动态范围和信纳比，以及块边界处的相位连续性
+  * @attention   : gen_block() 与 impd_exc.c 中 exc_fill_block() 的计算相同，
+  *                修改激励的生成方式时需同步修改
+  ******************************************************************************
+  */
+#include "dsp_math.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define SAMPLE_RATE         (100000)
+#define BLOCK_LEN           (250)
+#define DAC_MID             (2048)
+#define AMP_MAX             (2047)
+#define FFT_BITS            (16)
+#define FFT_LEN             (1 << FFT_BITS)
+#define PEAK_BINS           (6)         /* 四项 Blackman-Harris 主瓣半宽 */
+
+typedef struct
+{
+    uint32_t phase;
+    uint32_t inc;
+    int32_t  amp;
+    uint8_t  periodic;
+} dds_t;
+
+static uint16_t dac[FFT_LEN + BLOCK_LEN];
+static double re[FFT_LEN], im[FFT_LEN];
+
+static void dds_set(dds_t *d, uint32_t freq, int32_t amp)
+{
+    d->inc = DSP_PHASE_INC(freq, SAMPLE_RATE);
+    d->amp = amp;
+    d->periodic = ((freq * BLOCK_LEN) % SAMPLE_RATE) == 0;
+}
+
+static void gen_block(dds_t *d, uint16_t *block)
+{
+    uint32_t phase = d->phase;
+    int i;
+    
+    for (i = 0; i < BLOCK_LEN; i++) {
+        block[i] = (uint16_t)(DAC_MID + ((dsp_sin_q15(phase) * d->amp) >> 15));
+        phase += d->inc;
+    }
+    if (!d->periodic)
+        d->phase = phase;
+}
+
+static void fft(double *xr, double *xi, int bits)
+{
+    int n = 1 << bits, i, j, len;
+    
+    for (i = 1, j = 0; i < n; i++) {
+        int bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+        if (i < j) {
+            double t = xr[i]; xr[i] = xr[j]; xr[j] = t;
+            t = xi[i]; xi[i] = xi[j]; xi[j] = t;
+        }
+    }
+    for (len = 2; len <= n; len <<= 1) {
+        double a = -2 * M_PI / len;
+        for (i = 0; i < n; i += len) {
+            for (j = 0; j < len / 2; j++) {
+                double wr = cos(a * j), wi = sin(a * j);
+                double ur = xr[i + j], ui = xi[i + j];
+                double vr = xr[i + j + len / 2] * wr - xi[i + j + len / 2] * wi;
+                double vi = xr[i + j + len / 2] * wi + xi[i + j + len / 2] * wr;
+                xr[i + j] = ur + vr;
+                xi[i + j] = ui + vi;
+                xr[i + j + len / 2] = ur - vr;
+                xi[i + j + len / 2] = ui - vi;
+            }
+        }
+    }
+}
+
+/* 加窗频谱：返回载波功率与最大杂散、全部噪声加失真之比 (dB) */
+static void analyse(const uint16_t *x, double *sfdr, double *sinad)
+{
+    double carrier = 0, spur = 0, rest = 0, p;
+    int i, k, peak = 1;
+    
+    for (i = 0; i < FFT_LEN; i++) {
+        double w = 2 * M_PI * i / FFT_LEN;
+        re[i] = (x[i] - DAC_MID) * (0.35875 - 0.48829 * cos(w) + 0.14128 * cos(2 * w) - 0.01168 * cos(3 * w));
+        im[i] = 0;
+    }
+    fft(re, im, FFT_BITS);
+    
+    for (k = 1; k < FFT_LEN / 2; k++) {
+        if (re[k] * re[k] + im[k] * im[k] > re[peak] * re[peak] + im[peak] * im[peak])
+            peak = k;
+    }
+    for (k = PEAK_BINS; k < FFT_LEN / 2; k++) {
+        p = re[k] * re[k] + im[k] * im[k];
+        if (abs(k - peak) <= PEAK_BINS) {
+            carrier += p;
+        } else {
+            rest += p;
+            if (p > spur)
+                spur = p;
+        }
+    }
+    *sfdr = 10 * log10(re[peak] * re[peak] + im[peak] * im[peak]) - 10 * log10(spur);
+    *sinad = 10 * log10(carrier / rest);
+}
+
+static int check_tone(uint32_t freq, int32_t amp, double sfdr_min, double sinad_min)
+{
+    dds_t d = {0};
+    double sfdr, sinad;
+    int n;
+    
+    dds_set(&d, freq, amp);
+    for (n = 0; n < FFT_LEN; n += BLOCK_LEN)
+        gen_block(&d, &dac[n]);
+    
+    analyse(dac, &sfdr, &sinad);
+    printf("%6u Hz amp %4d%s: SFDR %5.1f dBc, SINAD %5.1f dB\n",
+           freq, amp, d.periodic ? " (periodic)" : "", sfdr, sinad);
+    
+    return (sfdr < sfdr_min || sinad < sinad_min) ? -1 : 0;
+}
+
+/* 参数在块边界生效：相位连续，跨边界的码值变化不超过新旧参数下的一步 */
+static int check_switch(void)
+{
+    static const uint32_t freq[] = {1234, 1000, 37777, 400, 25};
+    uint16_t blk[2][BLOCK_LEN];
+    dds_t d = {0};
+    double step = 0, limit;
+    int i, b, last = -1;
+    
+    for (i = 0; i < 5 * 4; i++) {
+        b = i & 1;
+        limit = step;
+        if (i % 4 == 0) {
+            /* 频率和幅值同时改变，幅值变化本身允许的跳变另计 */
+            dds_set(&d, freq[i / 4], (i / 4 & 1) ? AMP_MAX / 2 : AMP_MAX);
+            limit += AMP_MAX / 2;
+        }
+        step = 2 * M_PI * d.inc / 4294967296.0 * d.amp + 2;
+        gen_block(&d, blk[b]);
+        if (last >= 0 && abs((int)blk[b][0] - last) > limit + step) {
+            printf("FAIL discontinuity at block %d: %d -> %u\n", i, last, blk[b][0]);
+            return -1;
+        }
+        last = blk[b][BLOCK_LEN - 1];
+    }
+    
+    /* 整周期频率的两个半区内容相同，稳态下无需刷新 */
+    dds_set(&d, 1200, 1000);
+    d.phase = 0x1000;
+    gen_block(&d, blk[0]);
+    gen_block(&d, blk[1]);
+    if (memcmp(blk[0], blk[1], sizeof(blk[0])) != 0) {
+        printf("FAIL periodic blocks differ\n");
+        return -1;
+    }
+    printf("block switches continuous, periodic blocks static\n");
+    
+    return 0;
+}
+
+int main(void)
+{
+    int fail = 0;
+    
+    /* 12 位量化的理想 SINAD 约 74dB，满幅时要求 68dB 以上 */
+    fail |= check_tone(1200, AMP_MAX, 75, 68);
+    fail |= check_tone(1234, AMP_MAX, 75, 68);
+    fail |= check_tone(10007, AMP_MAX, 75, 68);
+    fail |= check_tone(37777, AMP_MAX, 75, 68);
+    fail |= check_tone(1234, 1000, 70, 62);
+    fail |= check_switch();
+    
+    if (fail)
+        printf("FAIL\n");
+    return fail ? 1 : 0;
+}
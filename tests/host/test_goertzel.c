@@ -0,0 +1,166 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : test_goertzel.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 定点 Goertzel 与浮点 DFT 比对：多频点、跨块窗口、参考相位和耗时
+  ******************************************************************************
+  */
+#include "goertzel.h"
+#include "dsp_math.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+#define FS                  (10000)
+#define WIN                 (1000)
+#define BLOCK_LEN           (250)
+#define NBINS               (3)
+
+static const uint32_t bin_freq[NBINS] = {50, 1000, 1234};
+static goertzel_result_t last[GOERTZEL_BIN_MAX];
+static int nres;
+
+static void on_result(const goertzel_result_t *res, uint8_t nbins, void *user_data)
+{
+    uint8_t i;
+    
+    for (i = 0; i < nbins; i++)
+        last[i] = res[i];
+    nres++;
+}
+
+static uint16_t adc_code(double v)
+{
+    long c = lround(v);
+    return (uint16_t)(c < 0 ? 0 : (c > 4095 ? 4095 : c));
+}
+
+/* 浮点 DFT：幅值 (码值) 和以正弦为参考的相位 (度) */
+static void dft(const uint16_t *x, int n, double f, double *mag, double *ph)
+{
+    double re = 0, im = 0;
+    int k;
+    
+    for (k = 0; k < n; k++) {
+        re += (x[k] - 2048.0) * cos(2 * M_PI * f * k / FS);
+        im -= (x[k] - 2048.0) * sin(2 * M_PI * f * k / FS);
+    }
+    *mag = 2 * sqrt(re * re + im * im) / n;
+    *ph = atan2(im, re) * 180 / M_PI + 90;
+}
+
+static double wrap_deg(double d)
+{
+    while (d > 180)
+        d -= 360;
+    while (d <= -180)
+        d += 360;
+    return d;
+}
+
+/* 记录与 DFT 的最大偏差 */
+static void compare(const uint16_t *x, double *max_m, double *max_p)
+{
+    double mag, ph, gm, gp;
+    int b;
+    
+    for (b = 0; b < NBINS; b++) {
+        dft(x, WIN, bin_freq[b], &mag, &ph);
+        gm = last[b].mag_q31 / 2147483648.0 * 4096;
+        gp = last[b].phase / 2147483648.0 * 180;
+        if (fabs(gm - mag) > *max_m)
+            *max_m = fabs(gm - mag);
+        /* 幅值很小时相位没有意义 */
+        if (mag > 10 && fabs(wrap_deg(gp - ph)) > *max_p)
+            *max_p = fabs(wrap_deg(gp - ph));
+    }
+}
+
+static int report(const char *tag, double max_m, double max_p)
+{
+    printf("%-10s max |mag err| %.3f codes, max |phase err| %.3f deg\n", tag, max_m, max_p);
+    return (max_m > 0.5 || max_p > 0.1) ? -1 : 0;
+}
+
+int main(void)
+{
+    static uint16_t x[WIN];
+    uint32_t inc[NBINS];
+    goertzel_t g;
+    double load = 40.0, ns, max_m = 0, max_p = 0;
+    clock_t t0;
+    int b, k, n, fail = 0;
+    
+    srand(1);
+    for (b = 0; b < NBINS; b++)
+        inc[b] = DSP_PHASE_INC(bin_freq[b], FS);
+    goertzel_init(&g, WIN);
+    goertzel_config(&g, inc, NBINS);
+    g.on_result = on_result;
+    
+    /* 随机幅值、相位的多音信号加噪声，按 ADC 块送入 */
+    for (k = 0; k < 20; k++) {
+        double a[NBINS], p[NBINS];
+        
+        for (b = 0; b < NBINS; b++) {
+            a[b] = 100 + rand() % 600;
+            p[b] = 2 * M_PI * rand() / RAND_MAX;
+        }
+        for (n = 0; n < WIN; n++) {
+            double v = 2048 + (rand() % 41 - 20);
+            for (b = 0; b < NBINS; b++)
+                v += a[b] * sin(2 * M_PI * bin_freq[b] * n / FS + p[b]);
+            x[n] = adc_code(v);
+        }
+        for (n = 0; n < WIN; n += BLOCK_LEN)
+            goertzel_process(&g, &x[n], BLOCK_LEN);
+        compare(x, &max_m, &max_p);
+    }
+    if (report("multitone", max_m, max_p) != 0)
+        fail = 1;
+    
+    /* 满量程方波：状态不溢出 */
+    for (n = 0; n < WIN; n++)
+        x[n] = ((n * 2 * bin_freq[0] / FS) & 1) ? 4095 : 0;
+    goertzel_process(&g, x, WIN);
+    max_m = max_p = 0;
+    compare(x, &max_m, &max_p);
+    if (report("square", max_m, max_p) != 0)
+        fail = 1;
+    
+    /* 参考相位：激励相位从任意值开始，结果为响应相对激励的相位 */
+    {
+        uint32_t exc_phase = 0x12345678, exc_inc = inc[1];
+        double exc0 = exc_phase / 4294967296.0 * 2 * M_PI;
+        double gp;
+        
+        for (n = 0; n < WIN; n++)
+            x[n] = adc_code(2048 + 800 * sin(exc0 + 2 * M_PI * bin_freq[1] * n / FS + load * M_PI / 180));
+        /* 参考在窗口中途的块也逐块更新，只有窗口起点的值生效 */
+        for (n = 0; n < WIN; n += BLOCK_LEN) {
+            goertzel_set_ref(&g, exc_phase + exc_inc * n, exc_inc);
+            goertzel_process(&g, &x[n], BLOCK_LEN);
+        }
+        gp = last[1].phase / 2147483648.0 * 180;
+        printf("reference  phase %.3f deg (load %.1f)\n", gp, load);
+        if (fabs(wrap_deg(gp - load)) > 0.1)
+            fail = 1;
+        goertzel_set_ref(&g, 0, 0);
+    }
+    
+    /* 主机上的耗时只作相对比较，目标板的周期数用 prof 模块测量 */
+    g.on_result = NULL;
+    t0 = clock();
+    for (k = 0; k < 2000; k++)
+        goertzel_process(&g, x, WIN);
+    ns = (double)(clock() - t0) / CLOCKS_PER_SEC * 1e9 / (2000.0 * WIN * NBINS);
+    printf("%.2f ns/sample/bin on host\n", ns);
+    
+    if (fail)
+        printf("FAIL\n");
+    return fail;
+}
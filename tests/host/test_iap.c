@@ -0,0 +1,300 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : test_iap.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 在线升级端到端：丢块和错块重传、逐点掉电后续传、差分升级，
+  *                下载区为 mtd_sim 模拟的片上 flash
+  * @attention   : 主机按 IAP_WINDOW 连续发送，每帧之后设备跑一次 iap_task，
+  *                与主循环中串口接收和 iap_task 交替执行的顺序一致
+  ******************************************************************************
+  */
+#include "iap.h"
+#include "iap_delta.h"
+#include "board.h"
+#include "mtd_core.h"
+#include "mtd_sim.h"
+#include "crc.h"
+#include <stdio.h>
+#include <string.h>
+
+#define IMG_PATH            "test_iap.img"
+#define PAGE_SIZE           (2048)
+#define FLASH_SIZE          (IAP_SLOT_BASE_ADDR + IAP_SLOT_SIZE)
+#define IMAGE_ADDR          (IAP_SLOT_BASE_ADDR + IAP_PAGE_SIZE)
+#define NEW_SIZE            (9000)          /* 不是页和块的整数倍 */
+#define OLD_SIZE            (20000)
+#define DELTA_SIZE          (21000)
+#define ROUND_MAX           (100000)
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);          \
+            return -1;                                                      \
+        }                                                                   \
+    } while (0)
+
+struct mtd_info stm32_flash_info;
+uint8_t test_app_image[OLD_SIZE];
+
+static uint8_t new_image[DELTA_SIZE];
+static uint8_t patch[DELTA_SIZE * 2];
+static uint32_t rand_state = 1;
+
+static uint32_t rand_next(void)
+{
+    rand_state = rand_state * 1103515245U + 12345U;
+    return rand_state >> 16;
+}
+
+/**
+ * @brief  主机端发送：每轮从 iap_get_next() 起发一个窗口，按 loss 的概率丢块或损坏
+ * @param  loss  丢块/错块概率 (1/loss)，0 表示无损
+ * @param  sent  累加发送的帧数
+ * @retval 0 全部块已被接收，-1 设备进入错误状态或 flash 失效
+ */
+static int upload(const uint8_t *data, uint32_t len, uint32_t loss, uint32_t *sent)
+{
+    uint8_t frame[IAP_BLOCK_SIZE];
+    uint16_t blocks = (uint16_t)((len + IAP_BLOCK_SIZE - 1) / IAP_BLOCK_SIZE);
+    uint16_t seq, n;
+    uint32_t round;
+    int i, ret;
+
+    for (round = 0; round < ROUND_MAX && iap_get_next() < blocks; round++) {
+        seq = iap_get_next();
+        for (i = 0; i < IAP_WINDOW && seq + i < blocks; i++) {
+            n = (uint16_t)((len - (uint32_t)(seq + i) * IAP_BLOCK_SIZE < IAP_BLOCK_SIZE) ?
+                           len - (uint32_t)(seq + i) * IAP_BLOCK_SIZE : IAP_BLOCK_SIZE);
+            memcpy(frame, &data[(uint32_t)(seq + i) * IAP_BLOCK_SIZE], n);
+            (*sent)++;
+            if (loss && rand_next() % loss == 0)
+                continue;
+            if (loss && rand_next() % loss == 0)
+                frame[rand_next() % n] ^= 0x10;
+
+            ret = iap_write_block(seq + i, crc16_modbus(&data[(uint32_t)(seq + i) * IAP_BLOCK_SIZE], n),
+                                  frame, n);
+            iap_task();
+            if (ret != 0 && ret != -EILSEQ && ret != -EAGAIN && ret != -EBUSY)
+                return -1;
+        }
+        if (iap_get_state() != IAP_RECV)
+            return -1;
+    }
+
+    return iap_get_next() == blocks ? 0 : -1;
+}
+
+/* 区头为 READY 且镜像与 data 一致 */
+static int slot_is(const uint8_t *data, uint32_t len)
+{
+    static uint8_t buf[DELTA_SIZE];
+    iap_slot_hdr_t hdr;
+    size_t retlen;
+
+    CHECK(mtd_read(&stm32_flash_info, IAP_SLOT_BASE_ADDR, sizeof(hdr), &retlen, (uint8_t *)&hdr) == 0);
+    CHECK(hdr.magic == IAP_SLOT_MAGIC && hdr.state == IAP_SLOT_READY);
+    CHECK(hdr.size == len && hdr.crc == iap_crc32(0, data, len));
+    CHECK(mtd_read(&stm32_flash_info, IMAGE_ADDR, len, &retlen, buf) == 0);
+    CHECK(memcmp(buf, data, len) == 0);
+
+    return 0;
+}
+
+/* 擦除区头，下一次升级从头开始 */
+static void slot_clear(void)
+{
+    struct erase_info info = { IAP_SLOT_BASE_ADDR, IAP_PAGE_SIZE };
+
+    mtd_erase(&stm32_flash_info, &info);
+}
+
+static int test_lossy_link(void)
+{
+    uint32_t crc = iap_crc32(0, new_image, NEW_SIZE);
+    uint32_t sent = 0;
+
+    slot_clear();
+    CHECK(iap_start(IAP_APP_SIZE + 1, crc) == -EINVAL);
+    CHECK(iap_start(NEW_SIZE, crc) == 0 && iap_get_next() == 0);
+    CHECK(upload(new_image, NEW_SIZE, 8, &sent) == 0);
+    CHECK(iap_finish() == 0 && iap_get_state() == IAP_READY);
+    CHECK(slot_is(new_image, NEW_SIZE) == 0);
+    printf("lossy link: %u blocks, %u frames sent\n",
+           (NEW_SIZE + IAP_BLOCK_SIZE - 1) / IAP_BLOCK_SIZE, sent);
+
+    /* 相同镜像再次开始时直接完成，不同 CRC 重新开始 */
+    CHECK(iap_start(NEW_SIZE, crc) == 0 && iap_get_state() == IAP_READY);
+    CHECK(iap_start(NEW_SIZE, crc ^ 1) == 0 && iap_get_next() == 0);
+    iap_abort();
+
+    /* 镜像与声明的 CRC 不符 */
+    slot_clear();
+    CHECK(iap_start(NEW_SIZE, crc ^ 1) == 0);
+    CHECK(upload(new_image, NEW_SIZE, 0, &sent) == 0);
+    CHECK(iap_finish() == -EILSEQ && iap_get_state() == IAP_ERROR);
+
+    return 0;
+}
+
+static int test_power_cut(void)
+{
+    uint32_t crc = iap_crc32(0, new_image, NEW_SIZE);
+    uint32_t sent = 0, resumed = 0;
+    mtd_sim_stats_t st;
+    int64_t cut;
+    int cases = 0;
+
+    mtd_sim_reset_stats(&stm32_flash_info);
+    for (cut = 0; cut < NEW_SIZE + 64; cut += (cut < 64) ? 1 : 37) {
+        slot_clear();
+        CHECK(iap_start(NEW_SIZE, crc) == 0);
+        mtd_sim_cut_after(&stm32_flash_info, cut);
+        if (upload(new_image, NEW_SIZE, 0, &sent) == 0)
+            iap_finish();
+        mtd_sim_cut_after(&stm32_flash_info, -1);
+
+        /* 重新上电后用相同的 size/crc 续传 */
+        iap_abort();
+        CHECK(iap_start(NEW_SIZE, crc) == 0);
+        resumed += iap_get_next();
+        if (iap_get_state() == IAP_RECV) {
+            CHECK(upload(new_image, NEW_SIZE, 0, &sent) == 0);
+            CHECK(iap_finish() == 0);
+        }
+        if (slot_is(new_image, NEW_SIZE) != 0) {
+            printf("FAIL cut %lld\n", (long long)cut);
+            return -1;
+        }
+        cases++;
+    }
+
+    mtd_sim_get_stats(&stm32_flash_info, &st);
+    printf("power-cut sweep: %d cut points, %u blocks skipped on resume, %u program violations\n",
+           cases, resumed, st.prog_violations);
+    CHECK(st.prog_violations == 0);
+
+    return 0;
+}
+
+static uint32_t put_var(uint8_t *p, uint32_t v)
+{
+    uint32_t n = 0;
+
+    while (v >= 0x80) {
+        p[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+
+    return n;
+}
+
+/**
+ * @brief  最简单的补丁：一个从旧偏移 0 开始的 DIFF 覆盖公共长度，剩余部分为 EXTRA
+ */
+static uint32_t make_patch(const uint8_t *old, uint32_t old_len, const uint8_t *nw, uint32_t new_len)
+{
+    uint32_t common = (old_len < new_len) ? old_len : new_len;
+    uint32_t i = 0, j, n = 0;
+
+    patch[n++] = IAP_DELTA_OP_DIFF;
+    n += put_var(&patch[n], 0);
+    n += put_var(&patch[n], common);
+    while (i < common) {
+        for (j = i; j < common && nw[j] == old[j]; j++)
+            ;
+        n += put_var(&patch[n], j - i);
+        if ((i = j) == common)
+            break;
+        for (j = i; j < common && nw[j] != old[j]; j++)
+            ;
+        n += put_var(&patch[n], j - i);
+        for (; i < j; i++)
+            patch[n++] = (uint8_t)(nw[i] - old[i]);
+    }
+
+    if (new_len > common) {
+        patch[n++] = IAP_DELTA_OP_EXTRA;
+        n += put_var(&patch[n], new_len - common);
+        memcpy(&patch[n], &nw[common], new_len - common);
+        n += new_len - common;
+    }
+
+    return n;
+}
+
+static int test_delta(void)
+{
+    uint32_t crc, old_crc = iap_crc32(0, test_app_image, OLD_SIZE);
+    uint32_t len, sent = 0;
+    uint32_t i;
+
+    /* 旧镜像上零散修改几处，末尾追加新代码 */
+    memcpy(new_image, test_app_image, OLD_SIZE);
+    for (i = 100; i < OLD_SIZE; i += 997)
+        new_image[i] ^= (uint8_t)(i | 1);
+    memset(&new_image[5000], 0x5A, 300);
+    for (i = OLD_SIZE; i < DELTA_SIZE; i++)
+        new_image[i] = (uint8_t)rand_next();
+    crc = iap_crc32(0, new_image, DELTA_SIZE);
+    len = make_patch(test_app_image, OLD_SIZE, new_image, DELTA_SIZE);
+
+    CHECK(iap_start_delta(len, DELTA_SIZE, crc, OLD_SIZE, old_crc ^ 1) == -EILSEQ);
+
+    slot_clear();
+    CHECK(iap_start_delta(len, DELTA_SIZE, crc, OLD_SIZE, old_crc) == 0);
+    CHECK(upload(patch, len, 8, &sent) == 0);
+    CHECK(iap_finish() == 0);
+    CHECK(slot_is(new_image, DELTA_SIZE) == 0);
+    printf("delta: %u byte image from %u byte patch, %u frames sent\n", DELTA_SIZE, len, sent);
+
+    /* 补丁输出比声明的镜像短 */
+    slot_clear();
+    len = make_patch(test_app_image, OLD_SIZE, new_image, DELTA_SIZE - 10);
+    CHECK(iap_start_delta(len, DELTA_SIZE, crc, OLD_SIZE, old_crc) == 0);
+    CHECK(upload(patch, len, 0, &sent) == 0);
+    CHECK(iap_finish() == -EILSEQ);
+
+    return 0;
+}
+
+int main(void)
+{
+    mtd_sim_cfg_t cfg = {
+        .size = FLASH_SIZE,
+        .page_size = PAGE_SIZE,
+        .write_size = 2,
+        .prog_ns_per_unit = 52000,
+        .erase_us_per_page = 20000,
+        .strict = 1,
+    };
+    uint32_t i;
+    int ret;
+
+    for (i = 0; i < OLD_SIZE; i++)
+        test_app_image[i] = (uint8_t)rand_next();
+    for (i = 0; i < NEW_SIZE; i++)
+        new_image[i] = (uint8_t)rand_next();
+
+    remove(IMG_PATH);
+    if (mtd_sim_attach(&stm32_flash_info, IMG_PATH, &cfg) != 0) {
+        printf("FAIL cannot attach %s\n", IMG_PATH);
+        return 1;
+    }
+
+    ret = test_lossy_link();
+    if (ret == 0)
+        ret = test_power_cut();
+    if (ret == 0)
+        ret = test_delta();
+
+    mtd_sim_detach(&stm32_flash_info);
+    remove(IMG_PATH);
+
+    return ret ? 1 : 0;
+}
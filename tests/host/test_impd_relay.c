@@ -0,0 +1,141 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : test_impd_relay.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 继电器切换与 ADC 块的对齐：按 loop_impd 的用法 (切换回调清空窗口，
+  *                只累加 impd_relay_block_ready 返回 1 的块)，检查切换后的第一个完整
+  *                窗口只含建立时间之后的样本
+  * @attention   : 块 k 覆盖样本 [kL, (k+1)L)，在样本时刻 (k+1)L 交给消费者，
+  *                此时继电器动作，DMA 正在采集块 k+1
+  ******************************************************************************
+  */
+#include "impd_relay.h"
+#include "impd_adc.h"
+#include "board.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define SAMPLE_RATE         (10000UL)
+#define WIN_BLOCKS          (4)             /* 与回路 Goertzel 窗口 (100 ms) 一致 */
+#define RUN_BLOCKS          (400)
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);          \
+            return -1;                                                      \
+        }                                                                   \
+    } while (0)
+
+static uint32_t sample_now;                 /* 当前样本时刻 */
+static uint32_t switch_at;                  /* 最近一次继电器动作的样本时刻 */
+static int relay_pin = -1;
+
+/* 测量窗口：累加的块数和最早样本 */
+static uint32_t win_blocks;
+static uint32_t win_first;
+static uint8_t win_after_switch;
+
+void HAL_GPIO_Init(void *port, GPIO_InitTypeDef *init)
+{
+    (void)port;
+    (void)init;
+}
+
+void HAL_GPIO_WritePin(void *port, uint32_t pin, int state)
+{
+    (void)port;
+    (void)pin;
+    if (relay_pin >= 0 && state != relay_pin)
+        switch_at = sample_now;
+    relay_pin = state;
+}
+
+uint32_t HAL_GetTick(void)
+{
+    return sample_now * 1000 / SAMPLE_RATE;
+}
+
+uint32_t impd_adc_get_sample_rate(void)
+{
+    return SAMPLE_RATE;
+}
+
+static void on_switch(uint8_t state, uint32_t tick, void *user_data)
+{
+    (void)state;
+    (void)tick;
+    (void)user_data;
+    win_blocks = 0;
+    win_after_switch = 1;
+}
+
+/**
+ * @brief  按随机时刻请求切换，检查每次切换后的第一个完整窗口
+ * @param  settle_ms 建立时间
+ * @param  hold_pct  每块暂缓切换的概率 (%)，模拟扫频进行中
+ */
+static int run(uint16_t settle_ms, int hold_pct)
+{
+    uint32_t settle = settle_ms * SAMPLE_RATE / 1000;
+    uint32_t k, windows = 0, switches = 0;
+    uint8_t hold;
+
+    CHECK(impd_relay_set_settle(settle_ms) == 0);
+    win_blocks = 0;
+    win_after_switch = 0;
+    for (k = 0; k < RUN_BLOCKS; k++) {
+        if (rand() % 7 == 0)
+            impd_relay_request((uint8_t)(rand() % 2));
+
+        sample_now = (k + 1) * IMPD_ADC_BLOCK_LEN;
+        hold = (rand() % 100) < hold_pct;
+        if (!impd_relay_block_ready(hold))
+            continue;
+
+        if (win_blocks == 0)
+            win_first = k * IMPD_ADC_BLOCK_LEN;
+        if (++win_blocks < WIN_BLOCKS)
+            continue;
+
+        win_blocks = 0;
+        if (win_after_switch) {
+            if ((int32_t)(win_first - (switch_at + settle)) < 0) {
+                printf("FAIL settle %u ms: window from sample %u, relay switched at %u\n",
+                       settle_ms, win_first, switch_at);
+                return -1;
+            }
+            win_after_switch = 0;
+            switches++;
+        }
+        windows++;
+    }
+    printf("settle %3u ms, hold %2d%%: %u windows, %u first windows after a switch clean\n",
+           settle_ms, hold_pct, windows, switches);
+    CHECK(switches > 0);
+
+    return 0;
+}
+
+int main(void)
+{
+    static const uint16_t settle[] = { 0, 20, 25, 26, 60 };
+    impd_relay_status_t st;
+    unsigned i;
+    int ret = 0;
+
+    srand(3);
+    impd_relay_init(on_switch, NULL);
+    for (i = 0; i < sizeof(settle) / sizeof(settle[0]) && ret == 0; i++) {
+        ret = run(settle[i], 0);
+        if (ret == 0)
+            ret = run(settle[i], 30);
+    }
+    impd_relay_get_status(&st);
+    printf("%u relay switches\n", st.switch_count);
+
+    return ret ? 1 : 0;
+}
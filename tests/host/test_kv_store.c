@@ -0,0 +1,165 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : test_kv_store.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 日志结构键值存储：基本读写、重新上电恢复、擦除均衡，
+  *                以及在 mtd_sim 上逐字节掉电的扫描
+  * @attention   : 掉电后每个键的值只能是旧值或新值，其余键不受影响，存储仍可写入
+  ******************************************************************************
+  */
+#include "kv_store.h"
+#include "mtd_core.h"
+#include "mtd_sim.h"
+#include <stdio.h>
+#include <string.h>
+
+#define IMG_PATH            "test_kv_store.img"
+#define PAGE_SIZE           (2048)
+#define PAGE_CNT            (2)
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);          \
+            return -1;                                                      \
+        }                                                                   \
+    } while (0)
+
+static struct mtd_info flash;
+
+/* 键值与期望一致，len < 0 表示不存在 */
+static int value_is(kv_store_t *kv, uint8_t key, const char *v, int len)
+{
+    char buf[KV_VALUE_MAX];
+    int n = kv_get(kv, key, buf, sizeof(buf));
+    
+    if (len < 0)
+        return n == -ENOENT;
+    return n == len && memcmp(buf, v, len) == 0;
+}
+
+static int test_basic(void)
+{
+    kv_store_t kv, kv2;
+    char v[32], buf[KV_VALUE_MAX];
+    uint32_t off;
+    int i, n, len;
+    
+    CHECK(kv_init(&kv, &flash, 0, PAGE_SIZE, PAGE_CNT) == 0);
+    CHECK(value_is(&kv, 0, NULL, -1));
+    
+    for (i = 0; i < 1000; i++) {
+        len = sprintf(v, "SN%010d", i);
+        CHECK(kv_set(&kv, i % 3, v, len) == 0);
+        CHECK(value_is(&kv, i % 3, v, len));
+    }
+    printf("1000 sets: %u erases\n", kv.erase_count);
+    
+    /* 值不变时不写入 */
+    n = kv_get(&kv, 2, buf, sizeof(buf));
+    off = kv.write_off;
+    CHECK(kv_set(&kv, 2, buf, n) == 0 && kv.write_off == off);
+    
+    CHECK(kv_del(&kv, 0) == 0);
+    CHECK(value_is(&kv, 0, NULL, -1));
+    
+    /* 重新上电得到相同的状态 */
+    CHECK(kv_init(&kv2, &flash, 0, PAGE_SIZE, PAGE_CNT) == 0);
+    CHECK(kv2.active == kv.active && kv2.write_off == kv.write_off);
+    CHECK(memcmp(kv2.index, kv.index, sizeof(kv.index)) == 0);
+    
+    return 0;
+}
+
+/* 写入失败后旧值在本次上电期间仍可读 */
+static int test_failed_write(void)
+{
+    kv_store_t kv;
+    
+    CHECK(kv_init(&kv, &flash, 0, PAGE_SIZE, PAGE_CNT) == 0);
+    CHECK(kv_set(&kv, 4, "before", 6) == 0);
+    mtd_sim_cut_after(&flash, 5);
+    CHECK(kv_set(&kv, 4, "after-the-cut", 13) != 0);
+    CHECK(value_is(&kv, 4, "before", 6));
+    mtd_sim_cut_after(&flash, -1);
+    
+    CHECK(kv_set(&kv, 4, "after", 5) == 0);
+    CHECK(value_is(&kv, 4, "after", 5));
+    
+    return 0;
+}
+
+static int test_power_cut(void)
+{
+    char old1[KV_VALUE_MAX], old2[KV_VALUE_MAX], nv[64];
+    kv_store_t kv;
+    mtd_sim_stats_t st;
+    int64_t cut;
+    int len1, len2, nl, j, cases = 0;
+    
+    for (cut = 0; cut < 3000; cut += 7) {
+        CHECK(kv_init(&kv, &flash, 0, PAGE_SIZE, PAGE_CNT) == 0);
+        len1 = kv_get(&kv, 1, old1, sizeof(old1));
+        len2 = kv_get(&kv, 2, old2, sizeof(old2));
+        nl = sprintf(nv, "value-%lld-xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx", (long long)cut);
+        
+        /* 之后的写入使页写满，掉电点会落在压缩过程中 */
+        mtd_sim_cut_after(&flash, cut);
+        kv_set(&kv, 1, nv, nl);
+        for (j = 0; j < 5; j++)
+            kv_set(&kv, 3 + j % 2, nv, nl - j);
+        mtd_sim_cut_after(&flash, -1);
+        
+        CHECK(kv_init(&kv, &flash, 0, PAGE_SIZE, PAGE_CNT) == 0);
+        if (!value_is(&kv, 1, nv, nl) && !value_is(&kv, 1, old1, len1)) {
+            printf("FAIL cut %lld: key 1 is neither old nor new\n", (long long)cut);
+            return -1;
+        }
+        if (!value_is(&kv, 2, old2, len2)) {
+            printf("FAIL cut %lld: untouched key 2 changed\n", (long long)cut);
+            return -1;
+        }
+        CHECK(kv_set(&kv, 5, "ok", 2) == 0 && value_is(&kv, 5, "ok", 2));
+        cases++;
+    }
+    
+    mtd_sim_get_stats(&flash, &st);
+    printf("power-cut sweep: %d cut points, %u erases, max %u per page, %u program violations\n",
+           cases, st.erase_total, st.erase_max, st.prog_violations);
+    CHECK(st.prog_violations == 0);
+    
+    return 0;
+}
+
+int main(void)
+{
+    mtd_sim_cfg_t cfg = {
+        .size = PAGE_SIZE * PAGE_CNT,
+        .page_size = PAGE_SIZE,
+        .write_size = 2,
+        .prog_ns_per_unit = 52000,
+        .erase_us_per_page = 20000,
+        .strict = 1,
+    };
+    int ret;
+    
+    remove(IMG_PATH);
+    if (mtd_sim_attach(&flash, IMG_PATH, &cfg) != 0) {
+        printf("FAIL cannot attach %s\n", IMG_PATH);
+        return 1;
+    }
+    
+    ret = test_basic();
+    if (ret == 0)
+        ret = test_failed_write();
+    if (ret == 0)
+        ret = test_power_cut();
+    
+    mtd_sim_detach(&flash);
+    remove(IMG_PATH);
+    
+    return ret ? 1 : 0;
+}
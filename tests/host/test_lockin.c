@@ -0,0 +1,105 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : test_lockin.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 锁相解调：含工频和白噪声的合成信号，检查幅值、相位、输出信噪比和耗时
+  ******************************************************************************
+  */
+#include "lockin.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+#define FS                  (10000.0)
+#define PERIOD              (100)       /* 100Hz 激励 */
+#define CYCLES              (10)        /* 100ms 窗口，5 个工频周期 */
+#define BLOCK_LEN           (250)
+#define WINDOWS             (200)
+#define AMP                 (1000.0)    /* 码值 */
+#define PHASE_DEG           (30.0)
+#define MAINS_AMP           (300.0)
+#define NOISE_AMP           (100.0)     /* 均匀分布 ±NOISE_AMP */
+
+static double mag_sum, mag_sq, ph_sum;
+static int nres;
+
+static void on_result(const lockin_result_t *res, void *user_data)
+{
+    double mag = res->mag_q31 / 2147483648.0 * 4096;
+    double ph = res->phase / 2147483648.0 * 180;
+    
+    mag_sum += mag;
+    mag_sq += mag * mag;
+    ph_sum += ph;
+    nres++;
+}
+
+static uint16_t adc_code(double v)
+{
+    long c = lround(v);
+    return (uint16_t)(c < 0 ? 0 : (c > 4095 ? 4095 : c));
+}
+
+int main(void)
+{
+    static int16_t ref[LOCKIN_REF_LEN(PERIOD)];
+    static uint16_t sig[PERIOD * CYCLES * WINDOWS];
+    const size_t len = sizeof(sig) / sizeof(sig[0]);
+    lockin_t lk;
+    double mean, std, snr_in, snr_out, ns;
+    clock_t t0;
+    size_t n;
+    int rep, fail = 0;
+    
+    srand(1);
+    for (n = 0; n < len; n++) {
+        double t = n / FS;
+        double noise = NOISE_AMP * (2.0 * rand() / RAND_MAX - 1.0);
+        sig[n] = adc_code(2048 + AMP * sin(2 * M_PI * FS / PERIOD * t + PHASE_DEG * M_PI / 180) +
+                          MAINS_AMP * sin(2 * M_PI * 50 * t + 1.0) + noise);
+    }
+    
+    lockin_build_ref(ref, PERIOD);
+    lockin_init(&lk, ref, PERIOD, CYCLES);
+    lk.on_result = on_result;
+    for (n = 0; n < len; n += BLOCK_LEN)
+        lockin_process(&lk, &sig[n], BLOCK_LEN);
+    
+    mean = mag_sum / nres;
+    std = sqrt(mag_sq / nres - mean * mean);
+    snr_in = 10 * log10((AMP * AMP / 2) / (MAINS_AMP * MAINS_AMP / 2 + NOISE_AMP * NOISE_AMP / 3));
+    snr_out = 20 * log10(mean / std);
+    printf("windows %d: mag %.2f codes (%.2f), phase %.2f deg (%.1f), SNR in %.1f dB, out %.1f dB\n",
+           nres, mean, AMP, ph_sum / nres, PHASE_DEG, snr_in, snr_out);
+    if (nres != WINDOWS || fabs(mean - AMP) > AMP * 0.005 || fabs(ph_sum / nres - PHASE_DEG) > 0.5 ||
+        snr_out < 45) {
+        printf("FAIL accuracy\n");
+        fail = 1;
+    }
+    
+    /* 参考下标对齐：从周期中间开始的信号，按其相位复位后结果不变 */
+    nres = 0;
+    mag_sum = mag_sq = ph_sum = 0;
+    lockin_reset(&lk, 0);
+    lockin_process(&lk, &sig[PERIOD / 4], PERIOD * CYCLES);
+    lockin_reset(&lk, PERIOD / 4);
+    lockin_process(&lk, &sig[PERIOD / 4], PERIOD * CYCLES);
+    if (nres != 2 || fabs(ph_sum - 90 - 2 * PHASE_DEG) > 2.0) {
+        printf("FAIL ref alignment\n");
+        fail = 1;
+    }
+    
+    /* 主机上的耗时只作相对比较，目标板的周期数用 prof 模块测量 */
+    lk.on_result = NULL;
+    t0 = clock();
+    for (rep = 0; rep < 20; rep++)
+        lockin_process(&lk, sig, len);
+    ns = (double)(clock() - t0) / CLOCKS_PER_SEC * 1e9 / (20.0 * len);
+    printf("%.2f ns/sample on host\n", ns);
+    
+    return fail;
+}
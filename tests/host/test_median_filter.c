@@ -0,0 +1,133 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : test_median_filter.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 双堆和直方图中值滤波器：与逐窗口排序的结果比对，并比较三者耗时
+  ******************************************************************************
+  */
+#include "median_filter.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define WIN_TEST_MAX        (40)
+#define BENCH_LEN           (100000)
+
+static int cmp_u16(const void *a, const void *b)
+{
+    return (int)*(const uint16_t*)a - (int)*(const uint16_t*)b;
+}
+
+/* 排序求中值，偶数个样本时取中间两个的平均 */
+static uint16_t sort_median(const uint16_t *win, int n, uint16_t *tmp)
+{
+    memcpy(tmp, win, n * sizeof(uint16_t));
+    qsort(tmp, n, sizeof(uint16_t), cmp_u16);
+    return (n & 1) ? tmp[n / 2] : (uint16_t)((tmp[n / 2 - 1] + tmp[n / 2]) / 2);
+}
+
+static int check_window(uint16_t size)
+{
+    uint16_t data[WIN_TEST_MAX], win[WIN_TEST_MAX], tmp[WIN_TEST_MAX], hwin[WIN_TEST_MAX];
+    int16_t pos[WIN_TEST_MAX], heap[WIN_TEST_MAX];
+    static median_hist_t mh;
+    median_filter_t mf;
+    int n, idx = 0, cnt = 0;
+    
+    median_filter_init(&mf, data, pos, heap, size);
+    median_hist_init(&mh, hwin, size);
+    for (n = 0; n < 5000; n++) {
+        /* 12 位样本，夹杂大量重复值 */
+        uint16_t v = (n % 7 == 0) ? (uint16_t)(rand() % 5) : (uint16_t)(rand() % 4096);
+        uint16_t got = median_filter_insert(&mf, v), hgot = median_hist_insert(&mh, v), want;
+        
+        win[idx] = v;
+        idx = (idx + 1) % size;
+        if (cnt < size)
+            cnt++;
+        want = sort_median(win, cnt, tmp);
+        if (got != want || hgot != want) {
+            printf("FAIL win=%u n=%d two-heap=%u hist=%u want=%u\n", size, n, got, hgot, want);
+            return -1;
+        }
+    }
+    
+    /* 复位后与新建的滤波器一致 */
+    median_filter_reset(&mf);
+    median_hist_reset(&mh);
+    if (median_filter_insert(&mf, 123) != 123 || median_hist_insert(&mh, 123) != 123) {
+        printf("FAIL win=%u after reset\n", size);
+        return -1;
+    }
+    
+    return 0;
+}
+
+static void bench(uint16_t size)
+{
+    static uint16_t in[BENCH_LEN];
+    uint16_t data[1024], win[1024], tmp[1024];
+    int16_t pos[1024], heap[1024];
+    static median_hist_t mh;
+    median_filter_t mf;
+    volatile uint32_t sink = 0;
+    clock_t t0;
+    double t_sort, t_heap, t_hist;
+    int n, idx = 0, cnt = 0;
+    
+    for (n = 0; n < BENCH_LEN; n++)
+        in[n] = (uint16_t)(rand() % 4096);
+    
+    t0 = clock();
+    for (n = 0; n < BENCH_LEN; n++) {
+        win[idx] = in[n];
+        idx = (idx + 1) % size;
+        if (cnt < size)
+            cnt++;
+        sink += sort_median(win, cnt, tmp);
+    }
+    t_sort = (double)(clock() - t0) / CLOCKS_PER_SEC;
+    
+    median_filter_init(&mf, data, pos, heap, size);
+    t0 = clock();
+    for (n = 0; n < BENCH_LEN; n++)
+        sink += median_filter_insert(&mf, in[n]);
+    t_heap = (double)(clock() - t0) / CLOCKS_PER_SEC;
+    
+    printf("win %4u: sort %8.1f ns/sample, two-heap %6.1f ns/sample",
+           size, t_sort * 1e9 / BENCH_LEN, t_heap * 1e9 / BENCH_LEN);
+    
+    /* 直方图的计数为 8 位，窗口不超过 MEDIAN_HIST_WIN_MAX */
+    if (median_hist_init(&mh, win, size) != 0) {
+        printf("\n");
+        return;
+    }
+    t0 = clock();
+    for (n = 0; n < BENCH_LEN; n++)
+        sink += median_hist_insert(&mh, in[n]);
+    t_hist = (double)(clock() - t0) / CLOCKS_PER_SEC;
+    printf(", histogram %6.1f ns/sample\n", t_hist * 1e9 / BENCH_LEN);
+}
+
+int main(void)
+{
+    static const uint16_t bench_win[] = {5, 31, 101, 255, 1023};
+    uint16_t size;
+    unsigned i;
+    
+    srand(1);
+    for (size = 1; size <= WIN_TEST_MAX; size++) {
+        if (check_window(size) != 0)
+            return 1;
+    }
+    printf("two-heap and histogram medians match sorted windows 1..%d\n", WIN_TEST_MAX);
+    
+    for (i = 0; i < sizeof(bench_win) / sizeof(bench_win[0]); i++)
+        bench(bench_win[i]);
+    
+    return 0;
+}
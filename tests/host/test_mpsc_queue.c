@@ -0,0 +1,179 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : test_mpsc_queue.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 多生产者单消费者事件队列：多线程压力测试 (每个生产者的事件完整且有序)，
+  *                以及与互斥锁队列的单线程耗时对比
+  * @attention   : 主机走 __atomic CAS 路径；主机可能只有一个 CPU，队列满/空时 sched_yield 让出
+  ******************************************************************************
+  */
+#define _GNU_SOURCE
+#include "mpsc_queue.h"
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <time.h>
+
+#define SLOT_NUM            (64)
+#define PRODUCER_NUM        (4)
+#define MSG_NUM             (500000UL)
+#define BENCH_ROUNDS        (10000000L)
+#define GOLDEN              (2654435761U)
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);          \
+            return -1;                                                      \
+        }                                                                   \
+    } while (0)
+
+/* 对照：同样容量、每次操作加互斥锁的队列 */
+typedef struct
+{
+    pthread_mutex_t lock;
+    mpsc_msg_t buf[SLOT_NUM];
+    uint32_t head;
+    uint32_t tail;
+} locked_queue_t;
+
+static mpsc_slot_t slots[SLOT_NUM];
+static mpsc_queue_t queue;
+static locked_queue_t lq = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+static int locked_post(locked_queue_t *q, const mpsc_msg_t *msg)
+{
+    int ret = -ENOSPC;
+
+    pthread_mutex_lock(&q->lock);
+    if (q->head - q->tail < SLOT_NUM) {
+        q->buf[q->head++ & (SLOT_NUM - 1)] = *msg;
+        ret = 0;
+    }
+    pthread_mutex_unlock(&q->lock);
+
+    return ret;
+}
+
+static int locked_take(locked_queue_t *q, mpsc_msg_t *msg)
+{
+    int ret = 0;
+
+    pthread_mutex_lock(&q->lock);
+    if (q->head != q->tail) {
+        *msg = q->buf[q->tail++ & (SLOT_NUM - 1)];
+        ret = 1;
+    }
+    pthread_mutex_unlock(&q->lock);
+
+    return ret;
+}
+
+/* 事件内容由生产者编号和序号决定，消费者据此检查完整和顺序 */
+static void *producer(void *arg)
+{
+    uint16_t id = (uint16_t)(uintptr_t)arg;
+    mpsc_msg_t m;
+    uint32_t i = 0;
+
+    while (i < MSG_NUM) {
+        m.id = id;
+        m.arg = (uint16_t)i;
+        m.data = (i * GOLDEN) ^ id;
+        if (mpsc_post(&queue, &m) == 0)
+            i++;
+        else
+            sched_yield();
+    }
+
+    return NULL;
+}
+
+static double now_s(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static int test_stress(void)
+{
+    pthread_t t[PRODUCER_NUM];
+    uint32_t next[PRODUCER_NUM] = { 0 };
+    uint32_t got = 0, bad = 0;
+    mpsc_msg_t m;
+    double t0;
+    uintptr_t i;
+
+    CHECK(mpsc_init(&queue, slots, 48) == -EINVAL);
+    CHECK(mpsc_init(&queue, slots, SLOT_NUM) == 0);
+    CHECK(mpsc_take(&queue, &m) == 0 && mpsc_len(&queue) == 0);
+
+    t0 = now_s();
+    for (i = 0; i < PRODUCER_NUM; i++)
+        pthread_create(&t[i], NULL, producer, (void *)i);
+    while (got < PRODUCER_NUM * MSG_NUM) {
+        if (!mpsc_take(&queue, &m)) {
+            sched_yield();
+            continue;
+        }
+        got++;
+        if (m.id >= PRODUCER_NUM || m.arg != (uint16_t)next[m.id] ||
+            m.data != ((next[m.id] * GOLDEN) ^ m.id))
+            bad++;
+        else
+            next[m.id]++;
+    }
+    for (i = 0; i < PRODUCER_NUM; i++)
+        pthread_join(t[i], NULL);
+
+    printf("%d producers x %lu: %u received, %u bad or out of order, %u full, %.2f s\n",
+           PRODUCER_NUM, MSG_NUM, got, bad, mpsc_get_dropped(&queue), now_s() - t0);
+    CHECK(bad == 0 && mpsc_len(&queue) == 0);
+
+    return 0;
+}
+
+/* 无竞争时每对 post/take 的耗时 */
+static void bench(void)
+{
+    mpsc_msg_t m = { 1, 2, 3 }, o;
+    volatile uint32_t sink = 0;
+    double t0, t1, t2;
+    long i;
+
+    mpsc_init(&queue, slots, SLOT_NUM);
+    t0 = now_s();
+    for (i = 0; i < BENCH_ROUNDS; i++) {
+        m.data = (uint32_t)i;
+        mpsc_post(&queue, &m);
+        mpsc_take(&queue, &o);
+        sink += o.data;
+    }
+    t1 = now_s();
+    for (i = 0; i < BENCH_ROUNDS; i++) {
+        m.data = (uint32_t)i;
+        locked_post(&lq, &m);
+        locked_take(&lq, &o);
+        sink += o.data;
+    }
+    t2 = now_s();
+    printf("post+take: cas %.1f ns, mutex %.1f ns\n",
+           (t1 - t0) / BENCH_ROUNDS * 1e9, (t2 - t1) / BENCH_ROUNDS * 1e9);
+}
+
+int main(void)
+{
+    int ret;
+
+    ret = test_stress();
+    if (ret == 0)
+        bench();
+
+    return ret ? 1 : 0;
+}
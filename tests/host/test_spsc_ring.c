@@ -0,0 +1,297 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : test_spsc_ring.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 单生产者单消费者环形队列：双线程压力测试 (批量 reserve/peek 和
+  *                逐个 push/pop，计数跨 32 位回绕)，以及与通用 kfifo 的单线程耗时对比
+  * @attention   : 主机可能只有一个 CPU，队列满/空时 sched_yield 让出
+  ******************************************************************************
+  */
+#define _GNU_SOURCE
+#include "spsc_ring.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define ITEM_NUM            (200000UL)
+#define BATCH_MAX           (7)
+#define BENCH_ROUNDS        (5000000L)
+#define GOLDEN              (2654435761U)
+#define WRAP_START          (0xFFFFFF00UL)  /* 读写计数从回绕前开始 */
+
+typedef struct
+{
+    uint32_t seq;
+    uint32_t chk;
+} item_t;
+
+/* 与 loop_msg_t 大小相当的消息 */
+typedef struct
+{
+    uint8_t  id;
+    uint8_t  buf[151];
+    uint16_t len;
+} msg_t;
+
+SPSC_RING_DEFINE(item_ring, item_t, 64)
+SPSC_RING_DEFINE(byte_ring, uint8_t, 256)
+SPSC_RING_DEFINE(msg_ring, msg_t, 16)
+
+/**
+ * @brief 元素大小运行时给定、逐次 memcpy 的通用 FIFO，结构与 utilities 中的 kfifo 相同
+ */
+typedef struct
+{
+    uint8_t *data;
+    uint32_t in;
+    uint32_t out;
+    uint32_t mask;
+    uint32_t esize;
+} kfifo_t;
+
+static item_ring_t iring;
+static byte_ring_t bring;
+
+static void kfifo_init(kfifo_t *f, void *buf, uint32_t size, uint32_t esize)
+{
+    f->data = buf;
+    f->esize = esize;
+    f->mask = size / esize - 1;
+    f->in = 0;
+    f->out = 0;
+}
+
+static void kfifo_copy(kfifo_t *f, void *dst, const void *src, uint32_t len, uint32_t off, uint8_t in)
+{
+    uint32_t size = f->mask + 1;
+    uint32_t l;
+
+    off &= f->mask;
+    if (f->esize != 1) {
+        off *= f->esize;
+        size *= f->esize;
+        len *= f->esize;
+    }
+    l = (len < size - off) ? len : size - off;
+    if (in) {
+        memcpy(f->data + off, src, l);
+        memcpy(f->data, (const uint8_t *)src + l, len - l);
+    } else {
+        memcpy(dst, f->data + off, l);
+        memcpy((uint8_t *)dst + l, f->data, len - l);
+    }
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static uint32_t kfifo_in(kfifo_t *f, const void *buf, uint32_t len)
+{
+    uint32_t unused = (f->mask + 1) - (f->in - __atomic_load_n(&f->out, __ATOMIC_ACQUIRE));
+
+    if (len > unused)
+        len = unused;
+    kfifo_copy(f, NULL, buf, len, f->in, 1);
+    __atomic_store_n(&f->in, f->in + len, __ATOMIC_RELEASE);
+
+    return len;
+}
+
+static uint32_t kfifo_out(kfifo_t *f, void *buf, uint32_t len)
+{
+    uint32_t used = __atomic_load_n(&f->in, __ATOMIC_ACQUIRE) - f->out;
+
+    if (len > used)
+        len = used;
+    kfifo_copy(f, buf, NULL, len, f->out, 0);
+    __atomic_store_n(&f->out, f->out + len, __ATOMIC_RELEASE);
+
+    return len;
+}
+
+static void *item_producer(void *arg)
+{
+    uint32_t i = 0, k, n;
+    item_t *p;
+
+    (void)arg;
+    while (i < ITEM_NUM) {
+        n = item_ring_reserve(&iring, &p);
+        if (n > BATCH_MAX)
+            n = BATCH_MAX;
+        if (n > ITEM_NUM - i)
+            n = ITEM_NUM - i;
+        if (n == 0) {
+            sched_yield();
+            continue;
+        }
+        for (k = 0; k < n; k++) {
+            p[k].seq = i + k;
+            p[k].chk = (i + k) * GOLDEN;
+        }
+        item_ring_commit(&iring, n);
+        i += n;
+    }
+
+    return NULL;
+}
+
+static void *byte_producer(void *arg)
+{
+    uint32_t i = 0;
+    uint8_t v;
+
+    (void)arg;
+    while (i < ITEM_NUM) {
+        v = (uint8_t)(i * 7);
+        if (byte_ring_push(&bring, &v))
+            i++;
+        else
+            sched_yield();
+    }
+
+    return NULL;
+}
+
+static int test_items(void)
+{
+    pthread_t t;
+    uint32_t expect = 0, bad = 0, over = 0, k, n;
+    item_t *p;
+
+    item_ring_init(&iring);
+    iring.head = iring.tail = WRAP_START;
+    pthread_create(&t, NULL, item_producer, NULL);
+    while (expect < ITEM_NUM) {
+        if (item_ring_len(&iring) > 64)
+            over++;
+        n = item_ring_peek(&iring, &p);
+        if (n == 0) {
+            sched_yield();
+            continue;
+        }
+        for (k = 0; k < n; k++, expect++)
+            if (p[k].seq != expect || p[k].chk != expect * GOLDEN)
+                bad++;
+        item_ring_release(&iring, n);
+    }
+    pthread_join(t, NULL);
+    printf("items: %u received, %u bad, %u over capacity\n", expect, bad, over);
+
+    return (bad || over) ? -1 : 0;
+}
+
+static int test_bytes(void)
+{
+    pthread_t t;
+    uint32_t expect = 0, bad = 0;
+    uint8_t v;
+
+    byte_ring_init(&bring);
+    bring.head = bring.tail = WRAP_START;
+    pthread_create(&t, NULL, byte_producer, NULL);
+    while (expect < ITEM_NUM) {
+        if (!byte_ring_pop(&bring, &v)) {
+            sched_yield();
+            continue;
+        }
+        if (v != (uint8_t)(expect * 7))
+            bad++;
+        expect++;
+    }
+    pthread_join(t, NULL);
+    printf("bytes: %u received, %u bad\n", expect, bad);
+
+    return bad ? -1 : 0;
+}
+
+static double now_s(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+/* 单线程入队后立即出队，比较每对操作的耗时 */
+static void bench(void)
+{
+    static msg_t kbuf[16];
+    static uint8_t kbytes[256];
+    static msg_ring_t mring;
+    volatile uint32_t sink = 0;
+    msg_t m = { 0 }, o, *q, *r;
+    uint8_t bv, bo;
+    double t0, t1, t2, t3;
+    kfifo_t kf;
+    long i;
+
+    kfifo_init(&kf, kbuf, sizeof(kbuf), sizeof(msg_t));
+    msg_ring_init(&mring);
+    t0 = now_s();
+    for (i = 0; i < BENCH_ROUNDS; i++) {
+        m.id = (uint8_t)i;
+        m.len = 8;
+        kfifo_in(&kf, &m, 1);
+        kfifo_out(&kf, &o, 1);
+        sink += o.id;
+    }
+    t1 = now_s();
+    for (i = 0; i < BENCH_ROUNDS; i++) {
+        m.id = (uint8_t)i;
+        m.len = 8;
+        msg_ring_push(&mring, &m);
+        msg_ring_pop(&mring, &o);
+        sink += o.id;
+    }
+    t2 = now_s();
+    for (i = 0; i < BENCH_ROUNDS; i++) {
+        msg_ring_reserve(&mring, &q);
+        q->id = (uint8_t)i;
+        q->len = 8;
+        msg_ring_commit(&mring, 1);
+        msg_ring_peek(&mring, &r);
+        sink += r->id;
+        msg_ring_release(&mring, 1);
+    }
+    t3 = now_s();
+    printf("%u byte message in+out: kfifo %.1f ns, push/pop %.1f ns, reserve/peek %.1f ns\n",
+           (unsigned)sizeof(msg_t), (t1 - t0) / BENCH_ROUNDS * 1e9, (t2 - t1) / BENCH_ROUNDS * 1e9,
+           (t3 - t2) / BENCH_ROUNDS * 1e9);
+
+    kfifo_init(&kf, kbytes, sizeof(kbytes), 1);
+    byte_ring_init(&bring);
+    t0 = now_s();
+    for (i = 0; i < BENCH_ROUNDS; i++) {
+        bv = (uint8_t)i;
+        kfifo_in(&kf, &bv, 1);
+        kfifo_out(&kf, &bo, 1);
+        sink += bo;
+    }
+    t1 = now_s();
+    for (i = 0; i < BENCH_ROUNDS; i++) {
+        bv = (uint8_t)i;
+        byte_ring_push(&bring, &bv);
+        byte_ring_pop(&bring, &bo);
+        sink += bo;
+    }
+    t2 = now_s();
+    printf("byte in+out: kfifo %.2f ns, push/pop %.2f ns\n",
+           (t1 - t0) / BENCH_ROUNDS * 1e9, (t2 - t1) / BENCH_ROUNDS * 1e9);
+}
+
+int main(void)
+{
+    int ret;
+
+    ret = test_items();
+    if (ret == 0)
+        ret = test_bytes();
+    if (ret == 0)
+        bench();
+
+    return ret ? 1 : 0;
+}
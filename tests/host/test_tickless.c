@@ -0,0 +1,124 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : test_tickless.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 无节拍休眠的节拍补偿：按周期级模型重放 evt_sched_port_cm3.c 的
+  *                进入/唤醒/退出顺序，检查 sched_tickless_wraps 补偿后系统节拍不漂移
+  * @attention   : SysTick 从 LOAD 递减到 0，唤醒定时器计数频率为 10 kHz；
+  *                随机插入提前唤醒 (其他中断) 和进入、退出窗口中的节拍边界
+  ******************************************************************************
+  */
+#include "evt_sched.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define PERIOD              (72000ULL)      /* 72 MHz, 1 ms 节拍 */
+#define CYCLES_PER_COUNT    (7200ULL)       /* 唤醒定时器 10 kHz */
+#define SLEEP_NUM           (2000000L)
+#define TICKS_MAX           (10)
+
+static uint64_t now;                        /* 真实时间 (周期) */
+
+static uint64_t rand_below(uint64_t n)
+{
+    return (((uint64_t)rand() << 31) ^ (uint64_t)rand()) % n;
+}
+
+/* SysTick->VAL */
+static uint32_t systick_val(void)
+{
+    return (uint32_t)(PERIOD - 1 - now % PERIOD);
+}
+
+/* 到当前为止真实经过的节拍边界数 */
+static uint64_t true_ticks(void)
+{
+    return now / PERIOD;
+}
+
+int main(void)
+{
+    uint64_t tick = 0, naive = 0, delivered = 0;
+    uint64_t counts, cnt, start, w;
+    uint32_t v0, v1, ticks;
+    long i, early = 0, exit_race = 0, sleeps = 0;
+    sched_stats_t st;
+    int wake_early;
+
+    srand(7);
+    now = rand_below(PERIOD);
+    for (i = 0; i < SLEEP_NUM; i++) {
+        /* 运行期间的节拍由 SysTick 中断计入 */
+        now += rand_below(3 * PERIOD);
+        tick += true_ticks() - delivered;
+        naive += true_ticks() - delivered;
+        delivered = true_ticks();
+
+        /* 读 v0 后关 SysTick 中断，其间的节拍边界使本次放弃停节拍 */
+        v0 = systick_val();
+        w = true_ticks();
+        now += 4 + rand_below(8);
+        if (true_ticks() != w) {
+            tick += true_ticks() - delivered;
+            naive += true_ticks() - delivered;
+            delivered = true_ticks();
+            continue;
+        }
+
+        ticks = SCHED_TICKLESS_MIN_IDLE + (uint32_t)rand_below(TICKS_MAX - 1);
+        counts = ((uint64_t)(ticks - 1) * PERIOD + v0 + 1) / CYCLES_PER_COUNT;
+        if (counts == 0)
+            counts = 1;
+        now += 20 + rand_below(40);
+        start = now;
+        wake_early = (int)rand_below(2);
+        if (wake_early) {
+            now += rand_below(counts * CYCLES_PER_COUNT);
+            early++;
+        } else {
+            now += counts * CYCLES_PER_COUNT;
+        }
+
+        /* 唤醒延迟后停定时器，读计数 */
+        now += 12 + rand_below(30);
+        cnt = wake_early ? (now - start) / CYCLES_PER_COUNT : counts;
+        if (cnt > counts)
+            cnt = counts;
+        now += 10 + rand_below(20);
+        v1 = systick_val();
+        w = true_ticks();
+        now += 2 + rand_below(6);
+
+        tick += sched_tickless_wraps(v0, v1, (uint32_t)(cnt * CYCLES_PER_COUNT + CYCLES_PER_COUNT / 2),
+                                     (uint32_t)PERIOD);
+        naive += (cnt * CYCLES_PER_COUNT + PERIOD / 2) / PERIOD;
+        /* 读 v1 之后、恢复 SysTick 之前的边界由挂起的节拍中断补上 */
+        if (true_ticks() != w) {
+            tick++;
+            exit_race++;
+        }
+        delivered = true_ticks();
+        sleeps++;
+
+        if (tick != true_ticks()) {
+            printf("FAIL sleep %ld: tick %llu, true %llu\n", i,
+                   (unsigned long long)tick, (unsigned long long)true_ticks());
+            return 1;
+        }
+    }
+
+    sched_get_stats(&st);
+    printf("%ld sleeps (%ld woken early, %ld exit races), %.1f s simulated\n",
+           sleeps, early, exit_race, now / 72e6);
+    printf("compensated drift %lld ticks, timer count only %lld ticks\n",
+           (long long)(tick - true_ticks()), (long long)(naive - true_ticks()));
+    if (st.tickless != (uint32_t)sleeps) {
+        printf("FAIL stats: %u tickless, expect %ld\n", st.tickless, sleeps);
+        return 1;
+    }
+
+    return 0;
+}
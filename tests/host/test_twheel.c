@@ -0,0 +1,241 @@
+/**
+  ******************************************************************************
+  * @copyright   : Copyright To Hangzhou Dinova EP Technology Co.,Ltd
+  * @file        : test_twheel.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-18
+  * @brief       : 分层时间轮：逐节拍和无节拍跳跃下的到期时刻、跨 32 位回绕、
+  *                主循环迟到时周期定时器的累计漂移，以及与线性扫描的耗时对比
+  * @attention   : 节拍由测试程序推进，回调中随机停止和启动其他定时器
+  ******************************************************************************
+  */
+#include "twheel.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define TIMER_NUM           (600)
+#define LONG_PERIOD         (20000000UL)    /* 超过 2^24，需要分段级联 */
+#define TICK_RUN            (3000000UL)
+#define WAKE_MAX            (200000UL)
+#define BENCH_CALLS         (1000000UL)
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);          \
+            return -1;                                                      \
+        }                                                                   \
+    } while (0)
+
+static twheel_timer_t timers[TIMER_NUM];
+static uint32_t due[TIMER_NUM];
+static uint32_t tick;
+static uint32_t fires;
+static uint32_t early;
+static uint32_t late;
+static uint8_t churn;
+
+static uint32_t get_tick(void)
+{
+    return tick;
+}
+
+/* 回调时刻必须等于期望的到期节拍 */
+static void on_expire(void *arg)
+{
+    int i = (int)(intptr_t)arg;
+    int j;
+
+    fires++;
+    if ((int32_t)(tick - due[i]) < 0)
+        early++;
+    else if (tick != due[i])
+        late++;
+    if (timers[i].mode == TWHEEL_AUTO_RELOAD)
+        due[i] += timers[i].period;
+
+    if (!churn)
+        return;
+    if (rand() % 50 == 0) {
+        j = rand() % TIMER_NUM;
+        twheel_stop(&timers[j]);
+    }
+    if (rand() % 50 == 0) {
+        j = rand() % TIMER_NUM;
+        if (!twheel_is_active(&timers[j])) {
+            twheel_start(&timers[j]);
+            due[j] = tick + timers[j].period;
+        }
+    }
+}
+
+/* 已到期却仍在运行的定时器个数 */
+static uint32_t count_missed(void)
+{
+    uint32_t n = 0;
+    int i;
+
+    for (i = 0; i < TIMER_NUM; i++)
+        if (twheel_is_active(&timers[i]) && (int32_t)(tick - due[i]) >= 0)
+            n++;
+
+    return n;
+}
+
+static void start_all(void)
+{
+    uint32_t period;
+    int i;
+
+    twheel_init(get_tick);
+    for (i = 0; i < TIMER_NUM; i++) {
+        period = (i % 10 == 0) ? 1 + rand() % LONG_PERIOD : 1 + rand() % 60000;
+        twheel_create(&timers[i], period, (rand() % 2) ? TWHEEL_AUTO_RELOAD : TWHEEL_ONE_SHOT,
+                      on_expire, (void *)(intptr_t)i);
+        twheel_start(&timers[i]);
+        due[i] = tick + period;
+    }
+}
+
+static int test_per_tick(void)
+{
+    uint32_t k, missed = 0;
+
+    tick = 0xFFFF0000UL;
+    fires = early = late = 0;
+    churn = 1;
+    start_all();
+    for (k = 0; k < TICK_RUN; k++) {
+        tick++;
+        twheel_service();
+        if (k % 997 == 0)
+            missed += count_missed();
+    }
+    printf("per-tick: %u fires, %u early, %u late, %u missed, %u active\n",
+           fires, early, late, missed, twheel_get_count());
+    CHECK(fires > 0 && early == 0 && late == 0 && missed == 0);
+
+    return 0;
+}
+
+/* 每次直接跳到 twheel_next_expiry，期间不能有定时器到期 */
+static int test_tickless(void)
+{
+    uint32_t n, k, skipped = 0, wakes = 0;
+    int i;
+
+    tick = 0xFFFF0000UL;
+    fires = early = late = 0;
+    start_all();
+    for (k = 0; k < WAKE_MAX; k++) {
+        n = twheel_next_expiry();
+        if (n == TWHEEL_FOREVER)
+            break;
+        for (i = 0; i < TIMER_NUM; i++)
+            if (twheel_is_active(&timers[i]) && (int32_t)(due[i] - tick) > 0 &&
+                (int32_t)(due[i] - (tick + n)) < 0)
+                skipped++;
+        tick += n;
+        wakes++;
+        twheel_service();
+    }
+    printf("tickless: %u wakes, %u fires, %u early, %u late, %u slept past a timer\n",
+           wakes, fires, early, late, skipped);
+    CHECK(fires > 0 && early == 0 && late == 0 && skipped == 0);
+
+    return 0;
+}
+
+/* 主循环每次迟到 0~8 个节拍，周期定时器按到期时刻而不是回调时刻重装，不累计漂移 */
+static int test_drift(void)
+{
+    const uint32_t period = 7;
+    uint32_t start, span, k;
+
+    tick = 0xFFFFF000UL;
+    fires = early = 0;
+    churn = 0;
+    twheel_init(get_tick);
+    twheel_create(&timers[0], period, TWHEEL_AUTO_RELOAD, on_expire, (void *)0);
+    start = tick;
+    twheel_start(&timers[0]);
+    due[0] = tick + period;
+    for (k = 0; k < 1000000; k++) {
+        tick += 1 + rand() % 9;
+        twheel_service();
+    }
+    span = tick - start;
+    printf("drift: %u ticks, %u fires, expected %u\n", span, fires, span / period);
+    CHECK(fires == span / period && early == 0);
+    twheel_stop(&timers[0]);
+
+    return 0;
+}
+
+static double elapsed_ns(const struct timespec *a, const struct timespec *b)
+{
+    return (b->tv_sec - a->tv_sec) * 1e9 + (b->tv_nsec - a->tv_nsec);
+}
+
+/* 与 stimer 式的逐个扫描比较每次服务的耗时 */
+static void bench(void)
+{
+    static uint32_t expires[TIMER_NUM];
+    struct timespec a, b;
+    volatile uint32_t hits = 0;
+    uint32_t k;
+    int i;
+
+    churn = 0;
+    twheel_init(get_tick);
+    for (i = 0; i < TIMER_NUM; i++) {
+        twheel_create(&timers[i], 100 + rand() % 60000, TWHEEL_AUTO_RELOAD, on_expire,
+                      (void *)(intptr_t)i);
+        twheel_start(&timers[i]);
+        due[i] = tick + timers[i].period;
+        expires[i] = due[i];
+    }
+
+    fires = 0;
+    clock_gettime(CLOCK_MONOTONIC, &a);
+    for (k = 0; k < BENCH_CALLS; k++) {
+        tick++;
+        twheel_service();
+    }
+    clock_gettime(CLOCK_MONOTONIC, &b);
+    printf("wheel : %d timers, %.1f ns/service, %u fires\n",
+           TIMER_NUM, elapsed_ns(&a, &b) / BENCH_CALLS, fires);
+
+    tick -= BENCH_CALLS;
+    clock_gettime(CLOCK_MONOTONIC, &a);
+    for (k = 0; k < BENCH_CALLS; k++) {
+        tick++;
+        for (i = 0; i < TIMER_NUM; i++) {
+            if ((int32_t)(tick - expires[i]) >= 0) {
+                expires[i] += timers[i].period;
+                hits++;
+            }
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &b);
+    printf("linear: %d timers, %.1f ns/service, %u fires\n",
+           TIMER_NUM, elapsed_ns(&a, &b) / BENCH_CALLS, hits);
+}
+
+int main(void)
+{
+    int ret;
+
+    srand(1);
+    ret = test_per_tick();
+    if (ret == 0)
+        ret = test_tickless();
+    if (ret == 0)
+        ret = test_drift();
+    if (ret == 0)
+        bench();
+
+    return ret ? 1 : 0;
+}
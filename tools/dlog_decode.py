@@ -0,0 +1,225 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+二进制日志 (DLOG_D) 解码
+
+固件中 DLOG_D 只把格式串地址、时刻和参数写入 RTT 通道 1，
+格式串本身留在 flash 的 .dlog_fmt 段中。本工具从链接生成的 .axf 提取
+格式串表，再把 RTT 通道 1 的抓包还原成文本。
+
+记录格式 (小端，按字):
+    [0] 参数个数 (高 4 位) | 格式串地址 (低 28 位)
+    [1] 时刻 (ms)
+    [2..] 参数
+
+格式串按符号 dlog_fmt_* 查找 (armlink 输出的 .axf 不保留输入段名)，
+找不到符号时使用名为 .dlog_fmt 的段。%s 参数需要 .axf 才能取出字符串。
+
+用法:
+    JLinkRTTLogger -Device STM32F103ZE -If SWD -Speed 4000 -RTTChannel 1 dlog.bin
+    dlog_decode.py extract test.axf -o dlog_fmt.json
+    dlog_decode.py decode dlog.bin --elf test.axf
+    dlog_decode.py decode dlog.bin --table dlog_fmt.json
+"""
+import argparse
+import json
+import re
+import struct
+import sys
+
+ADDR_MASK = 0x0FFFFFFF
+FMT_SYMBOL = 'dlog_fmt_'
+FMT_SECTION = '.dlog_fmt'
+
+SHT_PROGBITS = 1
+SHT_SYMTAB = 2
+SHF_ALLOC = 0x2
+
+SPEC_RE = re.compile(r'%([-+ #0]*)(\d+)?(?:\.(\d+))?(hh|h|ll|l|z|t|j)?([diouxXcsp%])')
+
+
+class Elf:
+    """只读取段表、符号表和已分配段的内容"""
+
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            self.data = f.read()
+        d = self.data
+        if d[:4] != b'\x7fELF':
+            raise ValueError('%s: not an ELF file' % path)
+        self.is64 = d[4] == 2
+        self.end = '<' if d[5] == 1 else '>'
+        if self.is64:
+            shoff, = struct.unpack_from(self.end + 'Q', d, 0x28)
+            shentsize, shnum, shstrndx = struct.unpack_from(self.end + 'HHH', d, 0x3A)
+        else:
+            shoff, = struct.unpack_from(self.end + 'I', d, 0x20)
+            shentsize, shnum, shstrndx = struct.unpack_from(self.end + 'HHH', d, 0x2E)
+
+        self.sections = []
+        for i in range(shnum):
+            off = shoff + i * shentsize
+            if self.is64:
+                name, typ, flags, addr, offset, size, link = struct.unpack_from(
+                    self.end + 'IIQQQQI', d, off)
+            else:
+                name, typ, flags, addr, offset, size, link = struct.unpack_from(
+                    self.end + 'IIIIIII', d, off)
+            self.sections.append({'name': name, 'type': typ, 'flags': flags, 'addr': addr,
+                                  'offset': offset, 'size': size, 'link': link})
+        strtab = self.sections[shstrndx]
+        for s in self.sections:
+            s['name'] = self._cstr(strtab['offset'] + s['name'])
+
+    def _cstr(self, off):
+        end = self.data.index(b'\0', off)
+        return self.data[off:end].decode('utf-8', 'replace')
+
+    def symbols(self):
+        """返回 (名称, 地址) 列表"""
+        out = []
+        for s in self.sections:
+            if s['type'] != SHT_SYMTAB:
+                continue
+            names = self.sections[s['link']]
+            entsize = 24 if self.is64 else 16
+            for off in range(s['offset'], s['offset'] + s['size'], entsize):
+                if self.is64:
+                    name, _, _, _, value = struct.unpack_from(self.end + 'IBBHQ', self.data, off)
+                else:
+                    name, value = struct.unpack_from(self.end + 'II', self.data, off)
+                if name:
+                    out.append((self._cstr(names['offset'] + name), value))
+        return out
+
+    def read_cstr(self, addr):
+        """读取已分配段中 addr 处的字符串，不在任何段中时返回 None"""
+        for s in self.sections:
+            if s['type'] != SHT_PROGBITS or not s['flags'] & SHF_ALLOC:
+                continue
+            if s['addr'] <= addr < s['addr'] + s['size']:
+                off = s['offset'] + addr - s['addr']
+                end = self.data.find(b'\0', off, s['offset'] + s['size'])
+                if end < 0:
+                    end = s['offset'] + s['size']
+                return self.data[off:end].decode('utf-8', 'replace')
+        return None
+
+
+def extract(elf):
+    """格式串表：{地址低 28 位: 格式串}"""
+    table = {}
+    for name, addr in elf.symbols():
+        if name.startswith(FMT_SYMBOL):
+            text = elf.read_cstr(addr)
+            if text is not None:
+                table[addr & ADDR_MASK] = text
+    if not table:
+        for s in elf.sections:
+            if s['name'] != FMT_SECTION:
+                continue
+            blob = elf.data[s['offset']:s['offset'] + s['size']]
+            pos = 0
+            while pos < len(blob):
+                end = blob.find(b'\0', pos)
+                if end < 0:
+                    end = len(blob)
+                if end > pos:
+                    table[(s['addr'] + pos) & ADDR_MASK] = blob[pos:end].decode('utf-8', 'replace')
+                pos = end + 1
+    return table
+
+
+def to_signed(v, bits):
+    v &= (1 << bits) - 1
+    return v - (1 << bits) if v & (1 << (bits - 1)) else v
+
+
+def render(fmt, args, elf):
+    """按 C printf 规则展开，参数均为 32 位"""
+    it = iter(args)
+
+    def sub(m):
+        flags, width, prec, length, conv = m.groups()
+        if conv == '%':
+            return '%'
+        try:
+            v = next(it)
+        except StopIteration:
+            return m.group(0)
+        bits = {'hh': 8, 'h': 16}.get(length, 32)
+        spec = '%' + flags + (width or '') + ('.' + prec if prec else '')
+        if conv in 'di':
+            return (spec + 'd') % to_signed(v, bits)
+        if conv == 'u':
+            return (spec + 'd') % (v & ((1 << bits) - 1))
+        if conv in 'oxX':
+            return (spec + conv) % (v & ((1 << bits) - 1))
+        if conv == 'c':
+            return (spec + 'c') % chr(v & 0xFF)
+        if conv == 'p':
+            return '0x%08X' % v
+        text = elf.read_cstr(v) if elf else None
+        return (spec + 's') % (text if text is not None else '<0x%08X>' % v)
+
+    return SPEC_RE.sub(sub, fmt)
+
+
+def decode(blob, table, elf, out):
+    words = struct.unpack_from('<%dI' % (len(blob) // 4), blob)
+    i = 0
+    unknown = 0
+    while i + 2 <= len(words):
+        head = words[i]
+        n = head >> 28
+        fmt = table.get(head & ADDR_MASK)
+        if fmt is None or i + 2 + n > len(words):
+            # 抓包从记录中间开始或格式串表与固件不一致，逐字重新对齐
+            unknown += 1
+            i += 1
+            continue
+        text = render(fmt, words[i + 2:i + 2 + n], elf).rstrip('\r\n')
+        out.write('[%10u] %s\n' % (words[i + 1], text))
+        i += 2 + n
+    return unknown
+
+
+def main():
+    ap = argparse.ArgumentParser(description='deferred binary log decoder')
+    sub = ap.add_subparsers(dest='cmd')
+    sub.required = True
+    p = sub.add_parser('extract', help='dump the format table of a firmware image')
+    p.add_argument('elf', help='linked firmware (.axf / .elf)')
+    p.add_argument('-o', '--output', required=True)
+    p = sub.add_parser('decode', help='decode an RTT channel capture')
+    p.add_argument('capture', help='raw bytes of RTT channel 1')
+    g = p.add_mutually_exclusive_group(required=True)
+    g.add_argument('--elf', help='firmware that produced the capture')
+    g.add_argument('--table', help='format table written by extract')
+    args = ap.parse_args()
+
+    if args.cmd == 'extract':
+        table = extract(Elf(args.elf))
+        with open(args.output, 'w', encoding='utf-8') as f:
+            json.dump({'0x%07X' % k: v for k, v in sorted(table.items())}, f,
+                      ensure_ascii=False, indent=1)
+        print('%d format strings' % len(table))
+        return 0
+
+    elf = None
+    if args.elf:
+        elf = Elf(args.elf)
+        table = extract(elf)
+    else:
+        with open(args.table, encoding='utf-8') as f:
+            table = {int(k, 16): v for k, v in json.load(f).items()}
+    with open(args.capture, 'rb') as f:
+        blob = f.read()
+    unknown = decode(blob, table, elf, sys.stdout)
+    if unknown:
+        print('%d words skipped (no matching format string)' % unknown, file=sys.stderr)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,194 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+差分升级补丁生成
+
+补丁格式与 functions/iap_delta.h 一致：bsdiff 式的 DIFF/EXTRA 操作序列，
+DIFF 段内按 {零游程, 字面长度, 字面差值} 编码，整数为 LEB128。
+重新链接后大段代码只是地址字节变化，差值大多为 0，因此不需要额外压缩。
+
+用法:
+    iap_delta.py old.bin new.bin -o patch.bin
+"""
+import argparse
+import sys
+
+OP_DIFF = 0x00
+OP_EXTRA = 0x01
+
+GRAM = 8            # 索引的匹配长度
+MIN_MATCH = 16      # 接受的最短近似匹配
+MAX_CANDS = 16      # 每个索引项保留的旧位置数
+ZRUN_MIN = 3        # 短于此长度的零游程并入字面段
+
+BLOCK = 128         # 与 IAP_BLOCK_SIZE 一致，用于估算传输量
+FRAME_OVERHEAD = 9 + 5
+BAUD = 115200
+
+
+def varint(v):
+    out = bytearray()
+    while True:
+        b = v & 0x7F
+        v >>= 7
+        if v:
+            out.append(b | 0x80)
+        else:
+            out.append(b)
+            return bytes(out)
+
+
+def _extend(old, op, new, np):
+    """从 (op, np) 向后近似匹配，返回使 匹配数*2 - 长度 最大的长度"""
+    s = best = best_score = score = 0
+    n = min(len(old) - op, len(new) - np)
+    for j in range(n):
+        s += old[op + j] == new[np + j]
+        score = 2 * s - (j + 1)
+        if score > best_score:
+            best_score, best = score, j + 1
+        elif score < best_score - 32:
+            break
+    return best
+
+
+def _encode_diff(old, op, new, np, n):
+    """DIFF 段内容：{零游程, 字面长度, 字面差值...}，按解码器的状态顺序交替"""
+    d = bytes((new[np + k] - old[op + k]) & 0xFF for k in range(n))
+    out = bytearray()
+    k = 0
+    while k < n:
+        z = k
+        while z < n and d[z] == 0:
+            z += 1
+        out += varint(z - k)
+        k = z
+        if k >= n:
+            break
+        # 字面段延伸到下一个足够长的零游程
+        lit = k
+        while lit < n:
+            if d[lit] == 0:
+                z = lit
+                while z < n and d[z] == 0 and z - lit < ZRUN_MIN:
+                    z += 1
+                if z - lit >= ZRUN_MIN or z >= n:
+                    break
+                lit = z
+            else:
+                lit += 1
+        out += varint(lit - k) + d[k:lit]
+        k = lit
+    return bytes(out)
+
+
+def make_patch(old, new):
+    index = {}
+    for i in range(len(old) - GRAM + 1):
+        lst = index.setdefault(old[i:i + GRAM], [])
+        if len(lst) < MAX_CANDS:
+            lst.append(i)
+
+    out = bytearray()
+    extra = 0
+    last = None                     # 上一段匹配的 旧偏移 - 新偏移
+    i = 0
+    while i < len(new):
+        cands = list(index.get(new[i:i + GRAM], ()))
+        if last is not None and 0 <= i + last < len(old):
+            cands.insert(0, i + last)
+        best_len = best_pos = 0
+        for p in cands:
+            n = _extend(old, p, new, i)
+            if n > best_len:
+                best_len, best_pos = n, p
+        if best_len < MIN_MATCH:
+            i += 1
+            continue
+
+        if i > extra:
+            out += bytes([OP_EXTRA]) + varint(i - extra) + new[extra:i]
+        out += bytes([OP_DIFF]) + varint(best_pos) + varint(best_len)
+        out += _encode_diff(old, best_pos, new, i, best_len)
+        last = best_pos - i
+        i += best_len
+        extra = i
+
+    if len(new) > extra:
+        out += bytes([OP_EXTRA]) + varint(len(new) - extra) + new[extra:]
+    return bytes(out)
+
+
+def apply_patch(old, patch):
+    """参考实现，用于生成后自检"""
+    def rd(pos):
+        v = shift = 0
+        while True:
+            b = patch[pos]
+            pos += 1
+            v |= (b & 0x7F) << shift
+            if not b & 0x80:
+                return v, pos
+            shift += 7
+
+    new = bytearray()
+    pos = 0
+    while pos < len(patch):
+        op = patch[pos]
+        pos += 1
+        if op == OP_EXTRA:
+            n, pos = rd(pos)
+            new += patch[pos:pos + n]
+            pos += n
+            continue
+        off, pos = rd(pos)
+        n, pos = rd(pos)
+        while n:
+            z, pos = rd(pos)
+            new += old[off:off + z]
+            off += z
+            n -= z
+            if not n:
+                break
+            lit, pos = rd(pos)
+            new += bytes((old[off + k] + patch[pos + k]) & 0xFF for k in range(lit))
+            off += lit
+            pos += lit
+            n -= lit
+    return bytes(new)
+
+
+def transfer_time(size):
+    frames = (size + BLOCK - 1) // BLOCK
+    return (size + frames * FRAME_OVERHEAD) * 10 / BAUD
+
+
+def report(old, new, patch, log=print):
+    log('image %d bytes, patch %d bytes (%.1f%%), transfer %.1f s -> %.1f s at %d baud'
+        % (len(new), len(patch), 100.0 * len(patch) / len(new),
+           transfer_time(len(new)), transfer_time(len(patch)), BAUD))
+
+
+def main():
+    ap = argparse.ArgumentParser(description='generate IAP delta patch')
+    ap.add_argument('old', help='firmware currently installed on the board')
+    ap.add_argument('new', help='new firmware')
+    ap.add_argument('-o', '--output', required=True)
+    args = ap.parse_args()
+
+    with open(args.old, 'rb') as f:
+        old = f.read()
+    with open(args.new, 'rb') as f:
+        new = f.read()
+    patch = make_patch(old, new)
+    if apply_patch(old, patch) != new:
+        print('error: patch self-check failed', file=sys.stderr)
+        return 1
+    with open(args.output, 'wb') as f:
+        f.write(patch)
+    report(old, new, patch)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,236 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+环路阻抗板在线升级上位机
+
+通过 cmd_Ctrl_IAP (0x0A) 把固件分块发送到下载区，窗口内的块连续发送，
+按设备应答中的"下一个期望块号"推进 (go-back-N)。设备断电或连接中断后
+重新运行即可从最后一个已写入 flash 的页续传。
+指定 --base 时只发送相对板上当前固件的差分补丁 (见 iap_delta.py)，
+补丁不支持续传，中断后从头发送。
+firmware.bin 为 project/test.uvprojx 生成的应用程序 (链接在 0x08002000，不超过 48KB)，
+复位后由 bootloader (project/boot.uvprojx，位于 0x08000000) 安装。
+
+用法:
+    iap_upload.py --port COM5 firmware.bin
+    iap_upload.py --port COM5 --base installed.bin firmware.bin
+"""
+import argparse
+import struct
+import sys
+import time
+import zlib
+
+import iap_delta
+
+FRAME_HEAD = 0xFA
+FRAME_TAIL = 0x0D
+DEV_ADDR = 0x03
+DEV_ADDR_EXPAND = 0x05
+CMD_IAP = 0x0A
+
+SUB_START = 0
+SUB_DATA = 1
+SUB_FINISH = 2
+SUB_ABORT = 3
+SUB_START_DELTA = 4
+
+ACK_FINISH = 0x00
+ACK_CHECK = 0x06
+ACK_BUSY = 0x12
+ACK_DATA_ABNORMAL = 0x13
+
+
+def crc16_modbus(data):
+    crc = 0xFFFF
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = (crc >> 1) ^ 0xA001 if crc & 1 else crc >> 1
+    return crc
+
+
+def build_frame(cmd, payload):
+    """FA | 帧长(2) | 地址 | 命令 | 扩展地址 | 数据 | CRC16(2) | 0D"""
+    length = 9 + len(payload)
+    body = struct.pack('<HBBB', length, DEV_ADDR, cmd, DEV_ADDR_EXPAND) + payload
+    return bytes([FRAME_HEAD]) + body + struct.pack('<H', crc16_modbus(body)) + bytes([FRAME_TAIL])
+
+
+class Link:
+    """在任意提供 write(bytes) / read(n) (带超时) 的端口上收发协议帧"""
+
+    def __init__(self, port):
+        self.port = port
+        self.rx = bytearray()
+
+    def send(self, cmd, payload):
+        self.port.write(build_frame(cmd, payload))
+
+    def recv(self, timeout):
+        """返回 (cmd, data)，超时返回 None"""
+        deadline = time.monotonic() + timeout
+        while True:
+            frame = self._parse()
+            if frame is not None:
+                return frame
+            if time.monotonic() >= deadline:
+                return None
+            chunk = self.port.read(256)
+            if chunk:
+                self.rx += chunk
+
+    def _parse(self):
+        while self.rx:
+            if self.rx[0] != FRAME_HEAD:
+                del self.rx[0]
+                continue
+            if len(self.rx) < 3:
+                return None
+            length = self.rx[1] | (self.rx[2] << 8)
+            if length < 9 or length > 512:
+                del self.rx[0]
+                continue
+            if len(self.rx) < length:
+                return None
+            frame = bytes(self.rx[:length])
+            body = frame[1:length - 3]
+            crc = frame[length - 3] | (frame[length - 2] << 8)
+            if frame[-1] != FRAME_TAIL or crc != crc16_modbus(body):
+                del self.rx[0]
+                continue
+            del self.rx[:length]
+            return frame[4], frame[6:length - 3]
+        return None
+
+
+class IapError(Exception):
+    pass
+
+
+class Uploader:
+    def __init__(self, link, timeout=1.0, start_timeout=5.0, retries=20, log=print):
+        self.link = link
+        self.timeout = timeout
+        self.start_timeout = start_timeout
+        self.retries = retries
+        self.log = log
+        self.frames = 0
+        self.resends = 0
+
+    def _request(self, sub, payload, timeout):
+        for _ in range(self.retries):
+            self.link.send(CMD_IAP, bytes([sub]) + payload)
+            resp = self._wait(sub, timeout)
+            if resp is not None and resp[1] != ACK_BUSY:
+                return resp
+            time.sleep(0.05)
+        raise IapError('no response to sub-command %d' % sub)
+
+    def _wait(self, sub, timeout):
+        while True:
+            frame = self.link.recv(timeout)
+            if frame is None:
+                return None
+            cmd, data = frame
+            if cmd == CMD_IAP and len(data) >= 4 and data[0] == sub:
+                return data
+
+    def upload(self, image, old=None):
+        crc = zlib.crc32(image) & 0xFFFFFFFF
+        if old is None:
+            payload = image
+            resp = self._request(SUB_START, struct.pack('<II', len(image), crc), self.start_timeout)
+        else:
+            payload = iap_delta.make_patch(old, image)
+            iap_delta.report(old, image, payload, self.log)
+            resp = self._request(SUB_START_DELTA, struct.pack('<IIIII', len(payload), len(image), crc,
+                                                              len(old), zlib.crc32(old) & 0xFFFFFFFF),
+                                 self.start_timeout)
+            if resp[1] == ACK_CHECK:
+                raise IapError('board is not running the --base firmware')
+        if resp[1] != ACK_FINISH or len(resp) < 7:
+            raise IapError('start rejected, ack 0x%02X' % resp[1])
+        base = resp[2] | (resp[3] << 8)
+        window = resp[4]
+        block = resp[5] | (resp[6] << 8)
+        blocks = (len(payload) + block - 1) // block
+        if base:
+            self.log('resume from block %d/%d' % (base, blocks))
+
+        sent = base                 # 下一个尚未发送的块
+        stall = 0
+        t0 = time.monotonic()
+        while base < blocks:
+            while sent < blocks and sent - base < window:
+                data = payload[sent * block:(sent + 1) * block]
+                self.link.send(CMD_IAP, struct.pack('<BHH', SUB_DATA, sent, crc16_modbus(data)) + data)
+                self.frames += 1
+                sent += 1
+
+            resp = self._wait(SUB_DATA, self.timeout)
+            if resp is None:
+                # 超时：从最早未确认的块重发
+                stall += 1
+                if stall > self.retries:
+                    raise IapError('timeout at block %d' % base)
+                self.resends += sent - base
+                sent = base
+                continue
+
+            stall = 0
+            ack = resp[1]
+            nxt = resp[2] | (resp[3] << 8)
+            if nxt > base:
+                base = nxt
+            if ack in (ACK_BUSY, ACK_CHECK, ACK_DATA_ABNORMAL) and sent > base:
+                # 缓冲区满或块出错：丢弃窗口中后续的应答，从期望块重发
+                if ack == ACK_BUSY:
+                    time.sleep(0.01)
+                self._drain()
+                self.resends += sent - base
+                sent = base
+            elif ack not in (ACK_FINISH, ACK_BUSY, ACK_CHECK, ACK_DATA_ABNORMAL):
+                raise IapError('block %d rejected, ack 0x%02X' % (nxt, ack))
+
+        resp = self._request(SUB_FINISH, b'', self.start_timeout)
+        if resp[1] != ACK_FINISH:
+            raise IapError('image verify failed, ack 0x%02X' % resp[1])
+
+        dt = time.monotonic() - t0
+        self.log('%d bytes in %.2f s, %d frames, %d resent' % (len(payload), dt, self.frames, self.resends))
+
+    def _drain(self):
+        while self.link.recv(0.02) is not None:
+            pass
+
+
+def main():
+    ap = argparse.ArgumentParser(description='loop impedance board IAP uploader')
+    ap.add_argument('image', help='firmware binary')
+    ap.add_argument('--port', required=True, help='serial port')
+    ap.add_argument('--baud', type=int, default=115200)
+    ap.add_argument('--base', help='firmware currently on the board, send a delta patch against it')
+    args = ap.parse_args()
+
+    import serial
+    with open(args.image, 'rb') as f:
+        image = f.read()
+    old = None
+    if args.base:
+        with open(args.base, 'rb') as f:
+            old = f.read()
+    port = serial.Serial(args.port, args.baud, timeout=0.02)
+    try:
+        Uploader(Link(port)).upload(image, old)
+    except IapError as e:
+        print('error:', e, file=sys.stderr)
+        return 1
+    finally:
+        port.close()
+    print('done, reset the board to install')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
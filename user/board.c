@@ -20,10 +20,15 @@
 #include "stm32_usart.h"
 
 #include "stimer.h"
+#include "twheel.h"
+#include "prof.h"
+#include "safety.h"
 #include "gpio_key.h"
 #include "serial.h"
 #include "SEGGER_RTT.h"
+#include "dlog.h"
 #include "log.h"
+#include "evt_sched.h"
 
 /* Private typedef -----------------------------------------------------------*/
 
@@ -91,8 +96,15 @@ void board_init(void)
     SEGGER_RTT_ConfigUpBuffer(0, "RTTUP", NULL, 0, SEGGER_RTT_MODE_BLOCK_IF_FIFO_FULL);
     log_register_handler("rtt", rtt_output_handler);
     log_enable_handler("rtt");
+#if USING_DLOG
+    dlog_init(HAL_GetTick);
+#endif
     
+#if USING_PROF
+    prof_init();
+#endif
     stimer_init(HAL_GetTick);
+    twheel_init(HAL_GetTick);
     
     /* gpio 按键注册 */
     gpio_key_register(&key[0], KEY0, &key_cfg[0]);
@@ -168,6 +180,16 @@ void HAL_MspInit(void)
     __HAL_RCC_PWR_CLK_ENABLE();
 }
 
+/**
+  * @brief  覆盖 HAL 的弱定义：SysTick 中断中累加节拍并通知调度器
+  */
+void HAL_IncTick(void)
+{
+    uwTick += uwTickFreq;
+    safety_tick(uwTick);
+    sched_post(SCHED_EVT_TICK);
+}
+
 /**
   * @brief  This function is executed in case of error occurrence.
   * @retval None
@@ -36,12 +36,41 @@
 /* Exported define -----------------------------------------------------------*/
 /* 外设宏定义 */
 /* 内部 flash 宏定义 */
-#define STM32_FLASH_START_ADDR          (FLASH_BASE + (64 - 4) * 1024UL)
-#define STM32_FLASH_END_ADDR            (FLASH_BASE + (64UL * 1024) - 1)
+#define STM32_FLASH_START_ADDR          (FLASH_BASE + (64 - 8) * 1024UL)
+#define STM32_FLASH_END_ADDR            (FLASH_BASE + (128UL * 1024) - 1)
 #define STM32_FLASH_ERASE_SIZE          (128 * 1024)
+#define IAP_BOOT_SIZE                   (8 * 1024UL)                /* bootloader (boot/boot.c)，工程 boot.uvprojx 中 IROM1 大小与此一致 */
+#define IAP_APP_ADDR                    (FLASH_BASE + IAP_BOOT_SIZE)    /* 当前运行的应用程序，工程中 IROM1 起始与 VECT_TAB_OFFSET 与此一致 */
+#define IAP_APP_SIZE                    ((64 - 8) * 1024UL - IAP_BOOT_SIZE) /* 到数据区起始为止，工程中 IROM1 大小与此一致 */
+
+/* 不初始化的 RAM：工程中 IRAM1 大小为 64K - NOINIT_RAM_SIZE，链接器和启动代码不使用这一段 */
+#define NOINIT_RAM_SIZE                 (256)
+#define NOINIT_RAM_ADDR                 (SRAM_BASE + 0x10000UL - NOINIT_RAM_SIZE)
+
+/* 调度器事件位 */
+#define SCHED_EVT_TICK                  (1UL << 0)  /* SysTick */
+#define SCHED_EVT_ADC                   (1UL << 1)  /* 阻抗 ADC DMA 半传输/传输完成 */
+#define SCHED_EVT_LOOP_RX               (1UL << 2)  /* 回路串口收到数据 */
+#define SCHED_EVT_KICK                  (1UL << 3)  /* 时间轮周期定时器：看门狗报到和低频周期工作 */
+
+/* 无节拍休眠唤醒定时器 */
+#define SCHED_WAKE_TIM                  TIM7
+#define SCHED_WAKE_TIM_IRQn             TIM7_IRQn
+#define SCHED_WAKE_TIM_IRQHandler       TIM7_IRQHandler
+#define SCHED_WAKE_TIM_CLK_ENABLE()     __HAL_RCC_TIM7_CLK_ENABLE()
+#define SCHED_TICKLESS_MAX_IDLE         (10)        /* stimer 的到期时间不可查，以此限制其延迟 */
 
 #define LOOP_IMPD_ADC_Pin               GPIO_PIN_4
 #define LOOP_IMPD_ADC_GPIO_Port         GPIOA
+#define LOOP_IMPD_ADC_CHANNEL           ADC_CHANNEL_4
+
+#define ATTACH_IMPD_ADC_Pin             GPIO_PIN_6
+#define ATTACH_IMPD_ADC_GPIO_Port       GPIOA
+#define ATTACH_IMPD_ADC_CHANNEL         ADC_CHANNEL_6
+
+#define IMPD_EXC_DAC_Pin                GPIO_PIN_5
+#define IMPD_EXC_DAC_GPIO_Port          GPIOA
+#define IMPD_EXC_DAC_CHANNEL            DAC_CHANNEL_2
 
 #define IMPD_RELAY_Pin                  GPIO_PIN_15
 #define IMPD_RELAY_GPIO_Port            GPIOA
@@ -18,6 +18,7 @@
 #include "gpio.h"
 
 #include "stimer.h"
+#include "twheel.h"
 #include "key.h"
 
 #include "data_mgmt.h"
@@ -37,9 +38,13 @@
 #include "custom_proto.h"
 
 #include "loop_impd.h"
+#include "operate_loop.h"
+#include "evt_sched.h"
+#include "safety.h"
 /* Private typedef -----------------------------------------------------------*/
 
 /* Private define ------------------------------------------------------------*/
+#define MAIN_KICK_MS                    (50)    /* SCHED_EVT_KICK 周期 */
 
 /* Private macro -------------------------------------------------------------*/
 
@@ -48,9 +53,67 @@ size_t pin_id = 0;
 
 uint8_t r_buf[16];
 uint8_t w_buf[16] = "hello nihao!";
+
+static sched_task_t timer_task;
+static sched_task_t loop_task;
+static sched_task_t app_main_task;
+static twheel_timer_t kick_timer;
+static int timer_wd;
+static int loop_wd;
+static int app_wd;
 /* Private function prototypes -----------------------------------------------*/
 
 /* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  唤醒后检查回路串口：接收中断在 bsp 中，由此把收到的数据转换为事件
+ */
+static void main_poll(void)
+{
+    if (operate_loop_get_rx_len())
+        sched_post(SCHED_EVT_LOOP_RX);
+}
+
+/**
+ * @brief  距下一个时间轮定时器到期的节拍数，作为无节拍休眠的期限
+ */
+static uint32_t main_next_wake(void)
+{
+    return twheel_next_expiry();
+}
+
+/**
+ * @brief  周期唤醒回路和应用任务，没有串口数据和 ADC 数据时它们也能报到和做周期工作
+ */
+static void main_kick(void *arg)
+{
+    sched_post(SCHED_EVT_KICK);
+}
+
+static void main_timer_task(uint32_t events)
+{
+    safety_checkin(timer_wd);
+    stimer_service();
+    twheel_service();
+}
+
+/**
+ * @brief  每次处理一条消息，队列中还有消息时重新置位，与其他任务轮流运行
+ */
+static void main_loop_task(uint32_t events)
+{
+    safety_checkin(loop_wd);
+    loop_impd_task();
+    if (operate_loop_get_msg_len())
+        sched_post(SCHED_EVT_LOOP_RX);
+}
+
+static void main_app_task(uint32_t events)
+{
+    safety_checkin(app_wd);
+    if (events & SCHED_EVT_KICK)
+        app_periodic();
+    app_task();
+}
 
 /* Exported functions --------------------------------------------------------*/
 /**
@@ -75,10 +138,18 @@ int main(void)
     
     app_init();
     
-    while (1)
-    {
-        stimer_service();
-        loop_impd_task();
-//        app_task();
-    }
+    sched_init(main_poll);
+    sched_set_tickless(main_next_wake);
+    /* 回路任务的命令协程等待的继电器和读数状态随 ADC 数据块更新，一并订阅 ADC */
+    sched_register(&timer_task, "timer", SCHED_EVT_TICK, main_timer_task);
+    sched_register(&loop_task, "loop", SCHED_EVT_LOOP_RX | SCHED_EVT_ADC | SCHED_EVT_KICK, main_loop_task);
+    sched_register(&app_main_task, "app", SCHED_EVT_ADC | SCHED_EVT_KICK, main_app_task);
+    twheel_create(&kick_timer, MAIN_KICK_MS, TWHEEL_AUTO_RELOAD, main_kick, NULL);
+    twheel_start(&kick_timer);
+    /* timer 至少每 SCHED_TICKLESS_MAX_IDLE 运行一次，loop/app 至少每 MAIN_KICK_MS 运行一次，
+       截止期留出 flash 擦写的余量 */
+    timer_wd = safety_register("timer", 100);
+    loop_wd = safety_register("loop", MAIN_KICK_MS + 100);
+    app_wd = safety_register("app", MAIN_KICK_MS + 100);
+    sched_run();
 }
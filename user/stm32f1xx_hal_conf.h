@@ -40,7 +40,7 @@ extern "C" {
 //#define HAL_CEC_MODULE_ENABLED
 #define HAL_CORTEX_MODULE_ENABLED
 //#define HAL_CRC_MODULE_ENABLED
-//#define HAL_DAC_MODULE_ENABLED
+#define HAL_DAC_MODULE_ENABLED
 #define HAL_DMA_MODULE_ENABLED
 //#define HAL_ETH_MODULE_ENABLED
 #define HAL_EXTI_MODULE_ENABLED
@@ -40,6 +40,16 @@
 /* Kernel configure define */
 #define USING_HW_ATOMIC
 
+/* Profiling configure define */
+#ifndef USING_PROF
+#define USING_PROF                      1
+#endif
+
+/* Deferred binary log configure define */
+#ifndef USING_DLOG
+#define USING_DLOG                      1
+#endif
+
 /* Exported typedef ----------------------------------------------------------*/
 
 /* Exported macro ------------------------------------------------------------*/